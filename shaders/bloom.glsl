@@ -0,0 +1,33 @@
+// 泛光降采样：以目标像素中心为准在源纹理上取 13 个双线性样本（覆盖 6x6 源像素），
+// 分成 5 个互相重叠的 4x4 块加权（中间一块 0.5，四角各 0.125），比 2x2 盒式滤波少闪烁和锯齿。
+// karis 为 true 时每块按 1 / (1 + 亮度) 加权，单个极亮的像素不会在金字塔里扩散成闪烁的方块（只用于第一级）
+vec3 downsample13(vec2 uv, bool karis)
+{
+    vec2 texel = 1.0 / vec2(textureSize(postSource, 0));
+    vec3 a = texture(postSource, uv + texel * vec2(-2.0, 2.0)).rgb;
+    vec3 b = texture(postSource, uv + texel * vec2(0.0, 2.0)).rgb;
+    vec3 c = texture(postSource, uv + texel * vec2(2.0, 2.0)).rgb;
+    vec3 d = texture(postSource, uv + texel * vec2(-2.0, 0.0)).rgb;
+    vec3 e = texture(postSource, uv).rgb;
+    vec3 f = texture(postSource, uv + texel * vec2(2.0, 0.0)).rgb;
+    vec3 g = texture(postSource, uv + texel * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(postSource, uv + texel * vec2(0.0, -2.0)).rgb;
+    vec3 i = texture(postSource, uv + texel * vec2(2.0, -2.0)).rgb;
+    vec3 j = texture(postSource, uv + texel * vec2(-1.0, 1.0)).rgb;
+    vec3 k = texture(postSource, uv + texel * vec2(1.0, 1.0)).rgb;
+    vec3 l = texture(postSource, uv + texel * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(postSource, uv + texel * vec2(1.0, -1.0)).rgb;
+
+    vec3 blocks[5] = vec3[5]((j + k + l + m) * 0.25, (a + b + d + e) * 0.25, (b + c + e + f) * 0.25, (d + e + g + h) * 0.25,
+                             (e + f + h + i) * 0.25);
+    const float weights[5] = float[5](0.5, 0.125, 0.125, 0.125, 0.125);
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    for (int n = 0; n < 5; n++)
+    {
+        float weight = weights[n] * (karis ? 1.0 / (1.0 + luminance(blocks[n])) : 1.0);
+        sum += blocks[n] * weight;
+        weightSum += weight;
+    }
+    return sum / weightSum;
+}
@@ -0,0 +1,13 @@
+#version 330 core
+// 泛光金字塔：由上一级降采样到下一级
+out vec4 FragColor;
+
+in vec2 ScreenUV;
+
+#include "post_process.glsl"
+#include "bloom.glsl"
+
+void main()
+{
+    FragColor = vec4(downsample13(ScreenUV, false), 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+// 泛光金字塔的第 0 级：场景降采样到半分辨率，只留下曝光后超过阈值的部分（阈值附近按二次曲线软过渡）
+out vec4 FragColor;
+
+in vec2 ScreenUV;
+
+#include "post_process.glsl"
+#include "bloom.glsl"
+
+void main()
+{
+    vec3 color = downsample13(ScreenUV, true);
+    float brightness = max(max(color.r, color.g), color.b) * currentExposure();
+    float threshold = bloomParams.x, knee = bloomParams.y;
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 1e-4);
+    float contribution = max(soft, brightness - threshold) / max(brightness, 1e-4);
+    FragColor = vec4(color * contribution, 1.0);
+}
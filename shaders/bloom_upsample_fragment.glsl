@@ -0,0 +1,19 @@
+#version 330 core
+// 泛光金字塔：把下一级用 3x3 帐篷滤波放大，由加法混合叠到本级（本级已有降采样的内容）
+// 滤波半径以源纹素计，越大光晕越柔和
+out vec4 FragColor;
+
+in vec2 ScreenUV;
+
+#include "post_process.glsl"
+
+void main()
+{
+    vec2 offset = bloomParams.w / vec2(textureSize(postSource, 0));
+    vec3 sum = texture(postSource, ScreenUV).rgb * 4.0;
+    sum += (texture(postSource, ScreenUV + vec2(0.0, offset.y)).rgb + texture(postSource, ScreenUV - vec2(0.0, offset.y)).rgb +
+            texture(postSource, ScreenUV + vec2(offset.x, 0.0)).rgb + texture(postSource, ScreenUV - vec2(offset.x, 0.0)).rgb) * 2.0;
+    sum += texture(postSource, ScreenUV + offset).rgb + texture(postSource, ScreenUV - offset).rgb +
+           texture(postSource, ScreenUV + vec2(offset.x, -offset.y)).rgb + texture(postSource, ScreenUV + vec2(-offset.x, offset.y)).rgb;
+    FragColor = vec4(sum / 16.0, 1.0);
+}
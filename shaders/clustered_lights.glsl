@@ -0,0 +1,40 @@
+// 分簇点光源，与 src/uniform_blocks.h 中的 ClusterUniforms 和 src/light_buffers.h 对应；需要先包含 uniform_blocks.glsl（用到 view）
+layout (std140) uniform Clusters
+{
+    vec4 clusterGrid;
+    vec4 clusterSlices;
+    vec4 clusterScreen;
+};
+
+uniform samplerBuffer lightData;     // 每个光源两个纹素：位置和半径、颜色
+uniform usamplerBuffer clusterCells; // 每个簇一个纹素：下标列表中的起始位置和数量
+uniform usamplerBuffer lightIndices;
+
+// 片段所在簇中所有点光源的漫反射和镜面反射之和
+vec3 clusteredLighting(vec3 worldPos, vec3 norm, vec3 viewDir, float specularStrength, float shininess)
+{
+    float depth = -(view * vec4(worldPos, 1.0)).z;
+    int slice = clamp(int(log(depth) * clusterSlices.x + clusterSlices.y), 0, int(clusterGrid.z) - 1);
+    ivec2 tile = min(ivec2(gl_FragCoord.xy * clusterScreen.xy), ivec2(clusterGrid.xy) - 1);
+    int cluster = (slice * int(clusterGrid.y) + tile.y) * int(clusterGrid.x) + tile.x;
+    uvec2 cell = texelFetch(clusterCells, cluster).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < cell.y; i++)
+    {
+        int light = int(texelFetch(lightIndices, int(cell.x + i)).r);
+        vec4 positionRadius = texelFetch(lightData, light * 2);
+        vec3 color = texelFetch(lightData, light * 2 + 1).rgb;
+        vec3 toLight = positionRadius.xyz - worldPos;
+        float distance = length(toLight);
+        vec3 lightDir = toLight / max(distance, 1e-4);
+        // 平方反比，在半径处平滑衰减到 0，保证簇外的光源确实没有贡献
+        float ratio = distance / positionRadius.w;
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (1.0 + distance * distance);
+        float diff = max(dot(norm, lightDir), 0.0);
+        float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), shininess);
+        result += (diff + specularStrength * spec) * attenuation * color;
+    }
+    return result;
+}
@@ -0,0 +1,41 @@
+#version 330 core
+// 延迟光照：从 G-buffer 重建表面，与前向着色使用同一个 shadeSurface
+// 点光源按簇查找（屏幕块再按深度细分），阴影和点光源由特性开关控制
+out vec4 FragColor;
+
+in vec2 ScreenUV;
+
+#include "uniform_blocks.glsl"
+
+// 纹理单元在变体就绪时设置一次：G-buffer 6-8，阴影 2，分簇光照 3-5，SSAO 10（见 shader_variants.h）
+uniform sampler2D gAlbedoRoughness;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+#ifdef HAS_SHADOWS
+#include "shadows.glsl"
+#endif
+#ifdef HAS_CLUSTERED_LIGHTS
+#include "clustered_lights.glsl"
+#endif
+#ifdef HAS_SSAO
+#include "ssao.glsl"
+#endif
+#include "lighting.glsl"
+#include "octahedral.glsl"
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    // 没有几何的像素保留清屏颜色
+    if (depth >= 1.0)
+        discard;
+    vec4 clip = inverseViewProjection * vec4(vec3(ScreenUV, depth) * 2.0 - 1.0, 1.0);
+    vec3 worldPos = clip.xyz / clip.w;
+    vec4 albedoRoughness = texelFetch(gAlbedoRoughness, pixel, 0);
+    vec3 norm = decodeNormal(texelFetch(gNormal, pixel, 0).xy);
+    FragColor = vec4(shadeSurface(worldPos, norm, norm, albedoRoughness.rgb, albedoRoughness.a), 1.0);
+    // 写回深度，之后的线框等仍能做深度测试
+    gl_FragDepth = depth;
+}
@@ -0,0 +1,10 @@
+#version 330 core
+// 全屏三角形，不需要顶点缓冲（绑定一个空 VAO 即可）
+out vec2 ScreenUV;
+
+void main()
+{
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    ScreenUV = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
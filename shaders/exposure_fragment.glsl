@@ -0,0 +1,27 @@
+#version 330 core
+// 由亮度直方图求平均 log2 亮度，写入 1x1 目标
+// 只统计累计比例落在 [低百分位, 高百分位] 之间的部分：大片暗部和少量极亮的高光不会把曝光拉偏。
+// 结果按 exposureParams.y 向目标靠拢（与帧时间有关的指数适应），直方图为空时保持上一帧
+out vec4 FragAverage;
+
+#include "post_process.glsl"
+
+void main()
+{
+    float total = 0.0;
+    for (int i = 0; i < HISTOGRAM_BINS; i++)
+        total += texelFetch(postSource, ivec2(i, 0), 0).r;
+    float low = total * histogramParams.z, high = total * histogramParams.w;
+    float below = 0.0, sum = 0.0, weight = 0.0;
+    for (int i = 0; i < HISTOGRAM_BINS; i++)
+    {
+        float count = texelFetch(postSource, ivec2(i, 0), 0).r;
+        float inside = max(0.0, min(below + count, high) - max(below, low));
+        sum += inside * (histogramParams.x + (float(i) + 0.5) / float(HISTOGRAM_BINS) * histogramParams.y);
+        weight += inside;
+        below += count;
+    }
+    float previous = texelFetch(postExposure, ivec2(0), 0).r;
+    float target = weight > 0.0 ? sum / weight : previous;
+    FragAverage = vec4(mix(previous, target, exposureParams.y), 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+#include "uniform_blocks.glsl"
+
+// 主着色器编译完成前的临时着色：只有环境光和漫反射
+void main()
+{
+    vec3 norm = normalize(Normal);
+    float diff = max(dot(norm, normalize(lightPos.xyz - FragPos)), 0.0);
+    FragColor = vec4((0.2 + 0.8 * diff) * objectColor.rgb, 1.0);
+}
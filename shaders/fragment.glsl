@@ -5,41 +5,24 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
 
-uniform sampler2D texture_diffuse;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
-uniform vec3 objectColor;
-uniform bool useTexture;
+#include "uniform_blocks.glsl"
+
+// 纹理单元在变体就绪时设置一次：漫反射 0，法线 1，阴影 2，分簇光照 3-5，SSAO 10（见 shader_variants.h）
+#ifdef HAS_SHADOWS
+#include "shadows.glsl"
+#endif
+#ifdef HAS_CLUSTERED_LIGHTS
+#include "clustered_lights.glsl"
+#endif
+#ifdef HAS_SSAO
+#include "ssao.glsl"
+#endif
+#include "material.glsl"
+#include "lighting.glsl"
 
 void main()
 {
-    // 纹理采样
-    vec4 texColor = texture(texture_diffuse, TexCoords);
-    
-    // 环境光
-    float ambientStrength = 0.1;
-    vec3 ambient = ambientStrength * lightColor;
-    
-    // 漫反射
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
-    
-    // 镜面反射
-    float specularStrength = 0.5;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * spec * lightColor;
-    
-    vec3 result;
-    if (useTexture) {
-        result = (ambient + diffuse + specular) * texColor.rgb;
-    } else {
-        result = (ambient + diffuse + specular) * objectColor;
-    }
-    
-    FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+    vec3 geometryNormal = normalize(Normal);
+    vec3 norm = surfaceNormal(geometryNormal);
+    FragColor = vec4(shadeSurface(FragPos, geometryNormal, norm, surfaceAlbedo(), surfaceRoughness()), 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+// 延迟着色的几何通道：只写材质，不做光照（见 src/gbuffer.h 的布局）
+layout (location = 0) out vec4 gAlbedoRoughness;
+layout (location = 1) out vec2 gNormal;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+#include "uniform_blocks.glsl"
+#include "material.glsl"
+#include "octahedral.glsl"
+
+void main()
+{
+    gAlbedoRoughness = vec4(surfaceAlbedo(), surfaceRoughness());
+    gNormal = encodeNormal(surfaceNormal(normalize(Normal)));
+}
@@ -0,0 +1,43 @@
+// 表面光照，前向着色和延迟光照通道共用
+// 需要先包含 uniform_blocks.glsl，开启对应特性时还要先包含 shadows.glsl、clustered_lights.glsl、ssao.glsl
+
+// 粗糙度到 Phong 高光指数：0.5 对应 32，0 对应 1024，1 对应 1
+float specularExponent(float roughness)
+{
+    return exp2(10.0 * (1.0 - roughness));
+}
+
+// 环境光 + 主光源（可带阴影）+ 所在簇的点光源；geometryNormal 用于阴影的法线偏移
+vec3 shadeSurface(vec3 worldPos, vec3 geometryNormal, vec3 norm, vec3 albedo, float roughness)
+{
+    // 环境光
+    float ambientStrength = 0.1;
+    vec3 ambient = ambientStrength * lightColor.rgb;
+#ifdef HAS_SSAO
+    ambient *= ambientOcclusion(worldPos);
+#endif
+
+    // 漫反射
+    vec3 lightDir = normalize(lightPos.xyz - worldPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor.rgb;
+
+    // 镜面反射
+    float specularStrength = 0.5;
+    float shininess = specularExponent(roughness);
+    vec3 viewDir = normalize(viewPos.xyz - worldPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = specularStrength * spec * lightColor.rgb;
+
+#ifdef HAS_SHADOWS
+    float shadow = shadowFactor(worldPos, geometryNormal, lightDir);
+#else
+    float shadow = 1.0;
+#endif
+    vec3 lighting = ambient + shadow * (diffuse + specular);
+#ifdef HAS_CLUSTERED_LIGHTS
+    lighting += clusteredLighting(worldPos, norm, viewDir, specularStrength, shininess);
+#endif
+    return lighting * albedo;
+}
@@ -0,0 +1,8 @@
+#version 330 core
+// 每个测光点计数 1
+out vec4 FragCount;
+
+void main()
+{
+    FragCount = vec4(1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+// 亮度直方图的散射：第 gl_VertexID 个点对应场景中的一个 METER_STRIDE x METER_STRIDE 块，
+// 取块中心的双线性样本（2x2 像素的平均），按 log2 亮度放到 HISTOGRAM_BINS x 1 目标的对应像素上，加法混合计数。
+// 不需要顶点缓冲（绑定一个空 VAO 即可）
+#include "post_process.glsl"
+
+const int METER_STRIDE = 4; // 与 PostProcess::METER_STRIDE 一致
+
+void main()
+{
+    ivec2 size = textureSize(postSource, 0);
+    int columns = max(size.x / METER_STRIDE, 1);
+    ivec2 cell = ivec2(gl_VertexID % columns, gl_VertexID / columns);
+    vec2 uv = (vec2(cell * METER_STRIDE) + 0.5 * float(METER_STRIDE)) / vec2(size);
+    float logLuminance = log2(max(luminance(textureLod(postSource, uv, 0.0).rgb), 1e-6));
+    float t = clamp((logLuminance - histogramParams.x) / histogramParams.y, 0.0, 1.0);
+    float bin = min(floor(t * float(HISTOGRAM_BINS)), float(HISTOGRAM_BINS - 1));
+    gl_Position = vec4((bin + 0.5) / float(HISTOGRAM_BINS) * 2.0 - 1.0, 0.0, 0.0, 1.0);
+}
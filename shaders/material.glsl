@@ -0,0 +1,50 @@
+// 表面材质，前向着色和延迟几何通道共用
+// 需要先声明输入 FragPos/Normal/TexCoords 并包含 uniform_blocks.glsl（objectColor、objectMaterial）
+
+// 纹理单元在变体就绪时设置一次：漫反射 0，法线 1（见 shader_variants.h）
+#ifdef HAS_TEXTURE
+uniform sampler2D texture_diffuse1;
+#endif
+#ifdef HAS_NORMAL_MAP
+uniform sampler2D texture_normal1;
+
+// 顶点没有切线，用屏幕空间导数构造切线空间
+vec3 perturbNormal(vec3 normal)
+{
+    vec3 dp1 = dFdx(FragPos);
+    vec3 dp2 = dFdy(FragPos);
+    vec2 duv1 = dFdx(TexCoords);
+    vec2 duv2 = dFdy(TexCoords);
+    vec3 dp2perp = cross(dp2, normal);
+    vec3 dp1perp = cross(normal, dp1);
+    vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+    float invmax = inversesqrt(max(dot(T, T), dot(B, B)));
+    vec3 tangentNormal = texture(texture_normal1, TexCoords).xyz * 2.0 - 1.0;
+    return normalize(mat3(T * invmax, B * invmax, normal) * tangentNormal);
+}
+#endif
+
+vec3 surfaceAlbedo()
+{
+#ifdef HAS_TEXTURE
+    return texture(texture_diffuse1, TexCoords).rgb;
+#else
+    return objectColor.rgb;
+#endif
+}
+
+// geometryNormal 为插值后归一化的顶点法线
+vec3 surfaceNormal(vec3 geometryNormal)
+{
+#ifdef HAS_NORMAL_MAP
+    return perturbNormal(geometryNormal);
+#else
+    return geometryNormal;
+#endif
+}
+
+float surfaceRoughness()
+{
+    return objectMaterial.x;
+}
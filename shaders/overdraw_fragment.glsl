@@ -0,0 +1,8 @@
+#version 330 core
+// 重叠绘制热图的计数通道：每个通过深度测试的片段在 R8 目标上加 1（加法混合）
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0 / 255.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+// 把每像素的着色次数映射成颜色：0 深灰，1 蓝，2 绿，3 黄，4 橙，5 次及以上红到白
+out vec4 FragColor;
+
+uniform sampler2D overdrawCount; // 纹理单元见 shader_variants.h
+
+void main()
+{
+    float count = floor(texelFetch(overdrawCount, ivec2(gl_FragCoord.xy), 0).r * 255.0 + 0.5);
+    const vec3 ramp[6] = vec3[6](vec3(0.1), vec3(0.1, 0.2, 0.9), vec3(0.1, 0.8, 0.2), vec3(0.95, 0.9, 0.1), vec3(1.0, 0.5, 0.0),
+                                 vec3(0.9, 0.0, 0.0));
+    vec3 color = count < 5.0 ? ramp[int(count)] : mix(ramp[5], vec3(1.0), clamp((count - 5.0) / 10.0, 0.0, 1.0));
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,26 @@
+// HDR 后处理各通道共用，与 src/uniform_blocks.h 中的 PostProcessUniforms 和 src/post_process.h 对应
+layout (std140) uniform PostProcess
+{
+    vec4 bloomParams;     // x 亮度阈值，y 软过渡宽度，z 强度，w 上采样滤波半径
+    vec4 exposureParams;  // x 曝光补偿（EV），y 向目标靠拢的比例，z 手动曝光（0 为自动），w 泛光层数
+    vec4 histogramParams; // x 最小 log2 亮度，y log2 范围，z/w 低/高百分位
+};
+
+// 纹理单元见 shader_variants.h
+uniform sampler2D postSource;   // 本通道的输入
+uniform sampler2D postExposure; // 1x1，适应后的平均 log2 亮度
+
+const int HISTOGRAM_BINS = 64; // 与 PostProcess::HISTOGRAM_BINS 一致
+const float EXPOSURE_KEY = 0.18; // 平均亮度映射到的中灰
+
+float luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// 乘到场景颜色上的曝光
+float currentExposure()
+{
+    float exposure = exposureParams.z > 0.0 ? exposureParams.z : EXPOSURE_KEY / exp2(texelFetch(postExposure, ivec2(0), 0).r);
+    return exposure * exp2(exposureParams.x);
+}
@@ -0,0 +1,5 @@
+#version 330 core
+// 只写深度
+void main()
+{
+}
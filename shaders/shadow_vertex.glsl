@@ -0,0 +1,25 @@
+#version 330 core
+// 阴影/深度通道（也用于深度预通道）：静态网格只提供位置流，蒙皮变体额外读取骨骼属性
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in ivec4 aBoneIds;
+layout (location = 4) in vec4 aWeights;
+
+// 阴影通道里 Frame block 的 view/projection 是当前级联的光源矩阵
+#include "uniform_blocks.glsl"
+
+// 预通道之后颜色通道用 GL_EQUAL，位置的计算方式要与 vertex.glsl 相同
+invariant gl_Position;
+
+#ifdef HAS_SKINNING
+#include "skinning.glsl"
+#endif
+
+void main()
+{
+    vec4 position = vec4(aPos, 1.0);
+#ifdef HAS_SKINNING
+    position = skinMatrix(aBoneIds, aWeights) * position;
+#endif
+    vec4 worldPosition = model * position;
+    gl_Position = projection * view * worldPosition;
+}
@@ -0,0 +1,38 @@
+// 级联阴影采样，与 src/uniform_blocks.h 中的 ShadowUniforms 对应；需要先包含 uniform_blocks.glsl（用到 view）
+layout (std140) uniform Shadows
+{
+    mat4 lightViewProjection[4];
+    vec4 cascadeSplits;
+    vec4 cascadeTexelSize;
+    vec4 shadowParams;
+};
+
+uniform sampler2DArrayShadow shadowMap;
+
+// 返回 0（全影）到 1（受光）；normal 为几何法线，lightDir 指向光源
+float shadowFactor(vec3 worldPos, vec3 normal, vec3 lightDir)
+{
+    int count = int(shadowParams.x);
+    float depth = -(view * vec4(worldPos, 1.0)).z;
+    if (depth > cascadeSplits[count - 1])
+        return 1.0;
+    int cascade = 0;
+    while (cascade < count - 1 && depth > cascadeSplits[cascade])
+        cascade++;
+
+    // 法线偏移：沿法线推出若干纹素，掠射角越大推得越远，减少自阴影条纹
+    float slope = 1.0 - max(dot(normal, lightDir), 0.0);
+    vec3 offsetPos = worldPos + normal * cascadeTexelSize[cascade] * shadowParams.y * (0.5 + slope);
+    vec4 lightSpace = lightViewProjection[cascade] * vec4(offsetPos, 1.0);
+    vec3 coord = lightSpace.xyz * 0.5 + 0.5;
+    coord.z = min(coord.z, 1.0);
+
+    // PCF：每次采样由硬件做 2x2 比较后双线性混合，(2r+1)^2 次采样
+    int radius = int(shadowParams.w);
+    float lit = 0.0;
+    for (int y = -radius; y <= radius; y++)
+        for (int x = -radius; x <= radius; x++)
+            lit += texture(shadowMap, vec4(coord.xy + vec2(x, y) * shadowParams.z, float(cascade), coord.z));
+    float taps = float((2 * radius + 1) * (2 * radius + 1));
+    return lit / taps;
+}
@@ -0,0 +1,12 @@
+// GPU 蒙皮：骨骼矩阵在模型根空间，长度与 MAX_BONES 一致
+// 包含它的顶点着色器需要声明 location 3/4 的骨骼下标和权重
+layout (std140) uniform Bones
+{
+    mat4 bones[128];
+};
+
+mat4 skinMatrix(ivec4 ids, vec4 weights)
+{
+    return weights.x * bones[ids.x] + weights.y * bones[ids.y] +
+           weights.z * bones[ids.z] + weights.w * bones[ids.w];
+}
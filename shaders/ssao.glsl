@@ -0,0 +1,44 @@
+// 屏幕空间环境光遮蔽，与 src/uniform_blocks.h 中的 OcclusionUniforms 和 src/ssao.h 对应；需要先包含 uniform_blocks.glsl
+layout (std140) uniform Occlusion
+{
+    mat4 previousViewProjection;
+    vec4 occlusionParams;
+    vec4 occlusionTarget;
+};
+
+uniform sampler2D occlusionResult; // 低分辨率的累积结果：x 遮蔽，y 线性深度
+
+// 深度缓冲值到线性深度（沿视线方向到相机的距离），要求 projection 为透视投影
+float linearDepth(float depth)
+{
+    return projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+}
+
+// 片段的遮蔽（1 为无遮蔽）：在低分辨率结果上取 2x2 做双线性插值，
+// 再按深度差降低权重，跨越物体边缘的低分辨率像素几乎不参与；全部被排除时取深度最接近的一个
+float ambientOcclusion(vec3 worldPos)
+{
+    float depth = -(view * vec4(worldPos, 1.0)).z;
+    vec2 position = gl_FragCoord.xy * occlusionTarget.zw - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = position - vec2(base);
+    ivec2 maxTexel = ivec2(occlusionTarget.xy) - 1;
+    float sum = 0.0, weightSum = 0.0;
+    float nearest = 1.0, nearestDifference = 1e30;
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        vec2 texel = texelFetch(occlusionResult, clamp(base + offset, ivec2(0), maxTexel), 0).xy;
+        float difference = abs(texel.y - depth);
+        float bilinear = (offset.x == 1 ? f.x : 1.0 - f.x) * (offset.y == 1 ? f.y : 1.0 - f.y);
+        float weight = bilinear * max(0.0, 1.0 - difference / (0.05 * depth));
+        sum += texel.x * weight;
+        weightSum += weight;
+        if (difference < nearestDifference)
+        {
+            nearestDifference = difference;
+            nearest = texel.x;
+        }
+    }
+    return weightSum > 1e-3 ? sum / weightSum : nearest;
+}
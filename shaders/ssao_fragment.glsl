@@ -0,0 +1,91 @@
+#version 330 core
+// SSAO 通道（低分辨率）：法线半球采样估计遮蔽，再与重投影的上一帧结果做指数累积
+// 输出 x 遮蔽（1 为无遮蔽），y 线性深度（下一帧判断历史是否有效、着色时双边上采样）
+out vec2 FragOcclusion;
+
+#include "uniform_blocks.glsl"
+#include "ssao.glsl"
+
+// 纹理单元见 shader_variants.h
+uniform sampler2D occlusionDepth;   // 本帧低分辨率深度
+uniform sampler2D occlusionHistory; // 上一帧的输出
+
+// 低分辨率像素中心的视空间位置
+vec3 viewPosition(ivec2 pixel)
+{
+    float depth = linearDepth(texelFetch(occlusionDepth, pixel, 0).r);
+    vec2 ndc = (vec2(pixel) + 0.5) / occlusionTarget.xy * 2.0 - 1.0;
+    return vec3(ndc.x * depth / projection[0][0], ndc.y * depth / projection[1][1], -depth);
+}
+
+// 沿 step 方向与相邻像素的位置差，取深度变化较小的一侧，避免跨越物体边缘得到错误的法线
+vec3 positionDelta(ivec2 pixel, vec3 center, ivec2 step)
+{
+    ivec2 maxPixel = ivec2(occlusionTarget.xy) - 1;
+    ivec2 forward = pixel + step, backward = pixel - step;
+    bool hasForward = all(lessThanEqual(forward, maxPixel));
+    bool hasBackward = all(greaterThanEqual(backward, ivec2(0)));
+    vec3 forwardDelta = hasForward ? viewPosition(forward) - center : vec3(0.0);
+    vec3 backwardDelta = hasBackward ? center - viewPosition(backward) : vec3(0.0);
+    if (!hasBackward || (hasForward && abs(forwardDelta.z) < abs(backwardDelta.z)))
+        return forwardDelta;
+    return backwardDelta;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float bufferDepth = texelFetch(occlusionDepth, pixel, 0).r;
+    if (bufferDepth >= 1.0)
+    {
+        FragOcclusion = vec2(1.0, linearDepth(1.0));
+        return;
+    }
+    vec3 center = viewPosition(pixel);
+    vec3 normal = normalize(cross(positionDelta(pixel, center, ivec2(1, 0)), positionDelta(pixel, center, ivec2(0, 1))));
+
+    // 每个像素的采样方向按 interleaved gradient noise 旋转，每帧再多转一个黄金角，时间累积后覆盖更多方向
+    float radius = occlusionParams.x;
+    int samples = int(occlusionParams.y);
+    float noise = fract(52.9829189 * fract(dot(vec2(pixel), vec2(0.06711056, 0.00583715))));
+    float rotation = (noise + occlusionParams.z * 0.618034) * 6.2831853;
+    vec3 tangent = normalize(abs(normal.z) < 0.999 ? cross(normal, vec3(0.0, 0.0, 1.0)) : cross(normal, vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(normal, tangent);
+    float occluded = 0.0;
+    for (int i = 0; i < samples; i++)
+    {
+        // 余弦分布的半球方向（螺旋排列），距离向中心集中
+        float t = (float(i) + 0.5) / float(samples);
+        float phi = float(i) * 2.3999632 + rotation;
+        float sinTheta = sqrt(t);
+        vec3 direction = (tangent * cos(phi) + bitangent * sin(phi)) * sinTheta + normal * sqrt(1.0 - t);
+        float distance = fract(noise + float(i) * 0.7548777);
+        vec3 samplePos = center + direction * radius * (0.1 + 0.9 * distance * distance);
+
+        vec4 clip = projection * vec4(samplePos, 1.0);
+        vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+        if (any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0))))
+            continue;
+        float sceneDepth = linearDepth(texelFetch(occlusionDepth, ivec2(uv * occlusionTarget.xy), 0).r);
+        // 场景表面比采样点更靠近相机则被遮挡；离中心超过半径的表面（远处的前景）逐渐不计
+        float range = smoothstep(0.0, 1.0, radius / max(abs(-center.z - sceneDepth), 1e-4));
+        occluded += (sceneDepth < -samplePos.z - 0.02 * radius ? 1.0 : 0.0) * range;
+    }
+    float occlusion = 1.0 - occluded / float(max(samples, 1));
+
+    // 时间累积：按上一帧的相机矩阵重投影，历史深度与重投影深度一致时才混合（去遮挡的像素只用本帧结果）
+    if (occlusionParams.w < 1.0)
+    {
+        vec2 ndc = (vec2(pixel) + 0.5) / occlusionTarget.xy * 2.0 - 1.0;
+        vec4 world = inverseViewProjection * vec4(ndc, bufferDepth * 2.0 - 1.0, 1.0);
+        vec4 previous = previousViewProjection * vec4(world.xyz / world.w, 1.0);
+        vec2 previousUV = previous.xy / previous.w * 0.5 + 0.5;
+        if (previous.w > 0.0 && all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThan(previousUV, vec2(1.0))))
+        {
+            vec2 history = texelFetch(occlusionHistory, ivec2(previousUV * occlusionTarget.xy), 0).xy;
+            if (abs(history.y - previous.w) < 0.05 * previous.w)
+                occlusion = mix(history.x, occlusion, occlusionParams.w);
+        }
+    }
+    FragOcclusion = vec2(occlusion, -center.z);
+}
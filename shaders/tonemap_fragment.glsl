@@ -0,0 +1,36 @@
+#version 330 core
+// 合成：场景加泛光，乘以曝光，ACES 色调映射（Stephen Hill 对 RRT + ODT 的拟合，含 sRGB 与 AP1 之间的色彩空间变换），
+// 最后编码成 sRGB 写入 8 位帧缓冲
+out vec4 FragColor;
+
+in vec2 ScreenUV;
+
+#include "post_process.glsl"
+
+uniform sampler2D postBloom; // 泛光金字塔第 0 级（半分辨率），没有泛光时采样为 0
+
+// 列主序
+const mat3 ACES_INPUT = mat3(0.59719, 0.07600, 0.02840, 0.35458, 0.90834, 0.13383, 0.04823, 0.01566, 0.83777);
+const mat3 ACES_OUTPUT = mat3(1.60475, -0.10208, -0.00327, -0.53108, 1.10813, -0.07276, -0.07367, -0.00605, 1.07602);
+
+vec3 rrtAndOdtFit(vec3 v)
+{
+    vec3 a = v * (v + 0.0245786) - 0.000090537;
+    vec3 b = v * (0.983729 * v + 0.4329510) + 0.238081;
+    return a / b;
+}
+
+vec3 linearToSrgb(vec3 color)
+{
+    return mix(color * 12.92, 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), color));
+}
+
+void main()
+{
+    vec3 color = texelFetch(postSource, ivec2(gl_FragCoord.xy), 0).rgb;
+    // 金字塔各级叠加在第 0 级上，除以层数取平均
+    color += texture(postBloom, ScreenUV).rgb * (bloomParams.z / max(exposureParams.w, 1.0));
+    color *= currentExposure();
+    color = clamp(ACES_OUTPUT * rrtAndOdtFit(ACES_INPUT * color), 0.0, 1.0);
+    FragColor = vec4(linearToSrgb(color), 1.0);
+}
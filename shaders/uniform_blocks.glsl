@@ -0,0 +1,17 @@
+// 每帧和每次绘制的数据来自流式缓冲，与 src/uniform_blocks.h 中的结构一一对应
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+    vec4 lightColor;
+    mat4 inverseViewProjection; // 延迟光照由深度重建世界坐标
+};
+
+layout (std140) uniform Object
+{
+    mat4 model;
+    vec4 objectColor;
+    vec4 objectMaterial; // x 粗糙度
+};
@@ -2,20 +2,45 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in ivec4 aBoneIds;
+layout (location = 4) in vec4 aWeights;
+#ifdef HAS_INSTANCING
+// 每实例的模型矩阵，占 4 个属性位置，glVertexAttribDivisor 为 1
+layout (location = 5) in mat4 aInstanceModel;
+#endif
+
+// 与 shadow_vertex.glsl 按相同的表达式计算位置，深度预通道之后的 GL_EQUAL 测试要求两者逐位一致
+invariant gl_Position;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "uniform_blocks.glsl"
+
+#ifdef HAS_SKINNING
+#include "skinning.glsl"
+#endif
 
+// 特性开关由 shader_variants.h 以 #define 注入，见 ShaderFeature
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec4 position = vec4(aPos, 1.0);
+    vec3 normal = aNormal;
+#ifdef HAS_SKINNING
+    mat4 skin = skinMatrix(aBoneIds, aWeights);
+    position = skin * position;
+    normal = mat3(skin) * normal;
+#endif
+#ifdef HAS_INSTANCING
+    mat4 world = model * aInstanceModel;
+#else
+    mat4 world = model;
+#endif
+    vec4 worldPosition = world * position;
+    FragPos = vec3(worldPosition);
+    Normal = mat3(transpose(inverse(world))) * normal;
     TexCoords = aTexCoords;
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-} 
\ No newline at end of file
+    gl_Position = projection * view * worldPosition;
+} 
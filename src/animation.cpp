@@ -0,0 +1,411 @@
+#include "animation.h"
+#include "animation_compression.h"
+
+#include <assimp/scene.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIMATION_SSE 1
+#endif
+
+void loadAnimationClips(const aiScene *scene, std::vector<AnimationClip> &clips)
+{
+    for (unsigned int i = 0; scene && i < scene->mNumAnimations; i++)
+    {
+        const aiAnimation *animation = scene->mAnimations[i];
+        // 部分格式不写 tick 频率，按 Assimp 的惯例视为 25
+        double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        AnimationClip clip;
+        clip.name = animation->mName.C_Str();
+        clip.duration = static_cast<float>(animation->mDuration / ticksPerSecond);
+        for (unsigned int c = 0; c < animation->mNumChannels; c++)
+        {
+            const aiNodeAnim *source = animation->mChannels[c];
+            AnimationChannel channel;
+            channel.node = source->mNodeName.C_Str();
+            for (unsigned int k = 0; k < source->mNumPositionKeys; k++)
+            {
+                const aiVectorKey &key = source->mPositionKeys[k];
+                channel.position.times.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                channel.position.values.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+            }
+            for (unsigned int k = 0; k < source->mNumRotationKeys; k++)
+            {
+                const aiQuatKey &key = source->mRotationKeys[k];
+                channel.rotation.times.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                channel.rotation.values.push_back(glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z));
+            }
+            for (unsigned int k = 0; k < source->mNumScalingKeys; k++)
+            {
+                const aiVectorKey &key = source->mScalingKeys[k];
+                channel.scale.times.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                channel.scale.values.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+            }
+            clip.channels.push_back(channel);
+        }
+        clips.push_back(clip);
+    }
+}
+
+glm::mat4 ChannelPose::matrix() const
+{
+    glm::mat4 result = glm::mat4_cast(rotation);
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = glm::vec4(position, 1.0f);
+    return result;
+}
+
+namespace
+{
+    size_t roundUp4(size_t n)
+    {
+        return (n + 3) & ~size_t(3);
+    }
+
+    // 游标只向后移动；时间回绕（循环播放）时从头开始
+    template <typename Key>
+    void findKeys(const Key *keys, uint32_t count, uint32_t &cursor, float time, const Key *&a, const Key *&b, float &t)
+    {
+        if (count < 2)
+        {
+            a = b = keys;
+            t = 0.0f;
+            return;
+        }
+        if (cursor + 1 >= count || time < keys[cursor].time)
+            cursor = 0;
+        while (cursor + 2 < count && time >= keys[cursor + 1].time)
+            ++cursor;
+        a = keys + cursor;
+        b = a + 1;
+        float span = b->time - a->time;
+        t = span > 0.0f ? std::min(std::max((time - a->time) / span, 0.0f), 1.0f) : 0.0f;
+    }
+
+    template <typename Key>
+    void prefetchTrack(const std::vector<Key> &keys, uint32_t first, uint32_t cursor, uint32_t count)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        if (count > 0)
+            __builtin_prefetch(&keys[first + std::min(cursor, count - 1)]);
+#endif
+    }
+
+    // 修正 nlerp 的插值参数使其接近 slerp，d 为两个四元数点积的绝对值
+    inline float slerpCorrection(float t, float d)
+    {
+        float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+        float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+        float tm = t - 0.5f;
+        float k = a * tm * tm + b;
+        return t + t * tm * (t - 1.0f) * k;
+    }
+
+    // 提前预取后面第几个通道的关键帧
+    const size_t PREFETCH_DISTANCE = 8;
+}
+
+glm::quat blendRotation(const glm::quat &a, const glm::quat &b, float t)
+{
+    float d = glm::dot(a, b);
+    float sign = d < 0.0f ? -1.0f : 1.0f;
+    t = slerpCorrection(t, d * sign);
+    return glm::normalize(a + (b * sign - a) * t);
+}
+
+void AnimationSampler::bind(const AnimationClip *clip)
+{
+    compressed = nullptr;
+    channels = clip ? clip->channels.size() : 0;
+    duration = clip ? clip->duration : 0.0f;
+    vectorKeys.clear();
+    rotationKeys.clear();
+    vectorTracks.assign(channels * 2, Track());
+    rotationTracks.assign(channels, Track());
+    for (size_t c = 0; c < channels; c++)
+    {
+        const AnimationChannel &channel = clip->channels[c];
+        const VectorKeys *vectors[2] = {&channel.position, &channel.scale};
+        for (int v = 0; v < 2; v++)
+        {
+            Track &track = vectorTracks[v * channels + c];
+            track.first = static_cast<uint32_t>(vectorKeys.size());
+            track.count = static_cast<uint32_t>(vectors[v]->values.size());
+            for (size_t k = 0; k < vectors[v]->values.size(); k++)
+            {
+                const glm::vec3 &value = vectors[v]->values[k];
+                vectorKeys.push_back({vectors[v]->times[k], {value.x, value.y, value.z}});
+            }
+        }
+        Track &track = rotationTracks[c];
+        track.first = static_cast<uint32_t>(rotationKeys.size());
+        track.count = static_cast<uint32_t>(channel.rotation.values.size());
+        for (size_t k = 0; k < channel.rotation.values.size(); k++)
+        {
+            const glm::quat &value = channel.rotation.values[k];
+            rotationKeys.push_back({channel.rotation.times[k], {value.x, value.y, value.z, value.w}});
+        }
+    }
+    allocate();
+}
+
+void AnimationSampler::bind(const CompressedClip *clip)
+{
+    compressed = clip;
+    channels = clip ? clip->channels() : 0;
+    duration = clip ? clip->duration : 0.0f;
+    vectorKeys.clear();
+    rotationKeys.clear();
+    vectorTracks.assign(channels * 2, Track());
+    rotationTracks.assign(channels, Track());
+    for (size_t slot = 0; slot < channels * 2; slot++)
+    {
+        vectorTracks[slot].first = clip->vectorTracks[slot].first;
+        vectorTracks[slot].count = clip->vectorTracks[slot].count;
+    }
+    for (size_t c = 0; c < channels; c++)
+    {
+        rotationTracks[c].first = clip->rotationTracks[c].first;
+        rotationTracks[c].count = clip->rotationTracks[c].count;
+    }
+    allocate();
+}
+
+void AnimationSampler::allocate()
+{
+    size_t vectorCount = roundUp4(channels * 2);
+    size_t quatCount = roundUp4(channels);
+    for (int i = 0; i < 3; i++)
+    {
+        vectorA[i].assign(vectorCount, 0.0f);
+        vectorB[i].assign(vectorCount, 0.0f);
+        vectorOut[i].assign(vectorCount, 0.0f);
+    }
+    vectorT.assign(vectorCount, 0.0f);
+    for (int i = 0; i < 4; i++)
+    {
+        // 填充部分保持单位四元数，避免归一化时除以零
+        quatA[i].assign(quatCount, i == 3 ? 1.0f : 0.0f);
+        quatB[i].assign(quatCount, i == 3 ? 1.0f : 0.0f);
+        quatOut[i].assign(quatCount, i == 3 ? 1.0f : 0.0f);
+    }
+    quatT.assign(quatCount, 0.0f);
+}
+
+void AnimationSampler::sample(float time)
+{
+    if (channels == 0)
+        return;
+    if (duration > 0.0f)
+    {
+        time = std::fmod(time, duration);
+        if (time < 0.0f)
+            time += duration;
+    }
+    if (compressed)
+        gatherCompressed(time);
+    else
+        gather(time);
+    blend();
+}
+
+void AnimationSampler::gather(float time)
+{
+    for (size_t slot = 0; slot < channels * 2; slot++)
+    {
+        if (slot + PREFETCH_DISTANCE < channels * 2)
+        {
+            const Track &ahead = vectorTracks[slot + PREFETCH_DISTANCE];
+            prefetchTrack(vectorKeys, ahead.first, ahead.cursor, ahead.count);
+        }
+        Track &track = vectorTracks[slot];
+        if (track.count == 0)
+        {
+            // 没有关键帧：平移为 0，缩放为 1
+            float value = slot < channels ? 0.0f : 1.0f;
+            for (int i = 0; i < 3; i++)
+                vectorA[i][slot] = vectorB[i][slot] = value;
+            vectorT[slot] = 0.0f;
+            continue;
+        }
+        const VectorKey *a, *b;
+        findKeys(&vectorKeys[track.first], track.count, track.cursor, time, a, b, vectorT[slot]);
+        for (int i = 0; i < 3; i++)
+        {
+            vectorA[i][slot] = a->value[i];
+            vectorB[i][slot] = b->value[i];
+        }
+    }
+
+    for (size_t c = 0; c < channels; c++)
+    {
+        if (c + PREFETCH_DISTANCE < channels)
+        {
+            const Track &ahead = rotationTracks[c + PREFETCH_DISTANCE];
+            prefetchTrack(rotationKeys, ahead.first, ahead.cursor, ahead.count);
+        }
+        Track &track = rotationTracks[c];
+        if (track.count == 0)
+        {
+            for (int i = 0; i < 4; i++)
+                quatA[i][c] = quatB[i][c] = i == 3 ? 1.0f : 0.0f;
+            quatT[c] = 0.0f;
+            continue;
+        }
+        const RotationKey *a, *b;
+        findKeys(&rotationKeys[track.first], track.count, track.cursor, time, a, b, quatT[c]);
+        for (int i = 0; i < 4; i++)
+        {
+            quatA[i][c] = a->value[i];
+            quatB[i][c] = b->value[i];
+        }
+    }
+}
+
+void AnimationSampler::gatherCompressed(float time)
+{
+    // 关键帧时间是 timeStep 的整数倍，查找前把采样时间换算到同一单位
+    float units = time / compressed->timeStep;
+    for (size_t slot = 0; slot < channels * 2; slot++)
+    {
+        if (slot + PREFETCH_DISTANCE < channels * 2)
+        {
+            const Track &ahead = vectorTracks[slot + PREFETCH_DISTANCE];
+            prefetchTrack(compressed->vectorKeys, ahead.first, ahead.cursor, ahead.count);
+        }
+        Track &track = vectorTracks[slot];
+        if (track.count == 0)
+        {
+            float value = slot < channels ? 0.0f : 1.0f;
+            for (int i = 0; i < 3; i++)
+                vectorA[i][slot] = vectorB[i][slot] = value;
+            vectorT[slot] = 0.0f;
+            continue;
+        }
+        const CompressedClip::VectorKey *a, *b;
+        findKeys(&compressed->vectorKeys[track.first], track.count, track.cursor, units, a, b, vectorT[slot]);
+        const CompressedClip::VectorTrack &range = compressed->vectorTracks[slot];
+        float valueA[3], valueB[3];
+        CompressedClip::decode(range, *a, valueA);
+        CompressedClip::decode(range, *b, valueB);
+        for (int i = 0; i < 3; i++)
+        {
+            vectorA[i][slot] = valueA[i];
+            vectorB[i][slot] = valueB[i];
+        }
+    }
+
+    for (size_t c = 0; c < channels; c++)
+    {
+        if (c + PREFETCH_DISTANCE < channels)
+        {
+            const Track &ahead = rotationTracks[c + PREFETCH_DISTANCE];
+            prefetchTrack(compressed->rotationKeys, ahead.first, ahead.cursor, ahead.count);
+        }
+        Track &track = rotationTracks[c];
+        if (track.count == 0)
+        {
+            for (int i = 0; i < 4; i++)
+                quatA[i][c] = quatB[i][c] = i == 3 ? 1.0f : 0.0f;
+            quatT[c] = 0.0f;
+            continue;
+        }
+        // smallest-three 解码出的符号不连续，blend 中点积为负时会翻转 b
+        const CompressedClip::RotationKey *a, *b;
+        findKeys(&compressed->rotationKeys[track.first], track.count, track.cursor, units, a, b, quatT[c]);
+        float valueA[4], valueB[4];
+        CompressedClip::decode(*a, valueA);
+        CompressedClip::decode(*b, valueB);
+        for (int i = 0; i < 4; i++)
+        {
+            quatA[i][c] = valueA[i];
+            quatB[i][c] = valueB[i];
+        }
+    }
+}
+
+void AnimationSampler::blend()
+{
+    size_t vectorCount = vectorT.size();
+    size_t quatCount = quatT.size();
+#ifdef ANIMATION_SSE
+    for (size_t i = 0; i < vectorCount; i += 4)
+    {
+        __m128 t = _mm_loadu_ps(&vectorT[i]);
+        for (int k = 0; k < 3; k++)
+        {
+            __m128 a = _mm_loadu_ps(&vectorA[k][i]);
+            __m128 b = _mm_loadu_ps(&vectorB[k][i]);
+            _mm_storeu_ps(&vectorOut[k][i], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+        }
+    }
+
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f), signBit = _mm_set1_ps(-0.0f);
+    for (size_t i = 0; i < quatCount; i += 4)
+    {
+        __m128 a[4], b[4];
+        for (int k = 0; k < 4; k++)
+        {
+            a[k] = _mm_loadu_ps(&quatA[k][i]);
+            b[k] = _mm_loadu_ps(&quatB[k][i]);
+        }
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+                              _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+        // 点积为负时翻转 b，走最短路径
+        __m128 sign = _mm_and_ps(d, signBit);
+        for (int k = 0; k < 4; k++)
+            b[k] = _mm_xor_ps(b[k], sign);
+        d = _mm_xor_ps(d, sign);
+
+        __m128 t = _mm_loadu_ps(&quatT[i]);
+        __m128 ca = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+        __m128 cb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+        __m128 tm = _mm_sub_ps(t, half);
+        __m128 k = _mm_add_ps(_mm_mul_ps(ca, _mm_mul_ps(tm, tm)), cb);
+        t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, tm), _mm_mul_ps(_mm_sub_ps(t, one), k)));
+
+        __m128 r[4];
+        for (int c = 0; c < 4; c++)
+            r[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(b[c], a[c]), t));
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])),
+                                               _mm_add_ps(_mm_mul_ps(r[2], r[2]), _mm_mul_ps(r[3], r[3]))));
+        __m128 inverse = _mm_div_ps(one, length);
+        for (int c = 0; c < 4; c++)
+            _mm_storeu_ps(&quatOut[c][i], _mm_mul_ps(r[c], inverse));
+    }
+#else
+    for (size_t i = 0; i < vectorCount; i++)
+        for (int k = 0; k < 3; k++)
+            vectorOut[k][i] = vectorA[k][i] + (vectorB[k][i] - vectorA[k][i]) * vectorT[i];
+
+    for (size_t i = 0; i < quatCount; i++)
+    {
+        float d = quatA[0][i] * quatB[0][i] + quatA[1][i] * quatB[1][i] + quatA[2][i] * quatB[2][i] + quatA[3][i] * quatB[3][i];
+        float sign = d < 0.0f ? -1.0f : 1.0f;
+        float t = slerpCorrection(quatT[i], d * sign);
+        float r[4], length = 0.0f;
+        for (int c = 0; c < 4; c++)
+        {
+            r[c] = quatA[c][i] + (quatB[c][i] * sign - quatA[c][i]) * t;
+            length += r[c] * r[c];
+        }
+        float inverse = 1.0f / std::sqrt(length);
+        for (int c = 0; c < 4; c++)
+            quatOut[c][i] = r[c] * inverse;
+    }
+#endif
+}
+
+ChannelPose AnimationSampler::pose(size_t channel) const
+{
+    ChannelPose pose;
+    size_t s = channels + channel;
+    pose.position = glm::vec3(vectorOut[0][channel], vectorOut[1][channel], vectorOut[2][channel]);
+    pose.scale = glm::vec3(vectorOut[0][s], vectorOut[1][s], vectorOut[2][s]);
+    pose.rotation = glm::quat(quatOut[3][channel], quatOut[0][channel], quatOut[1][channel], quatOut[2][channel]);
+    return pose;
+}
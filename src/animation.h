@@ -0,0 +1,118 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct aiScene;
+struct CompressedClip;
+
+// 关键帧动画
+// 每个通道驱动一个节点，平移/旋转/缩放各自一组关键帧，时间单位为秒
+
+struct VectorKeys
+{
+    std::vector<float> times;
+    std::vector<glm::vec3> values;
+};
+
+struct RotationKeys
+{
+    std::vector<float> times;
+    std::vector<glm::quat> values;
+};
+
+struct AnimationChannel
+{
+    std::string node; // 目标节点名
+    VectorKeys position;
+    RotationKeys rotation;
+    VectorKeys scale;
+};
+
+struct AnimationClip
+{
+    std::string name;
+    float duration = 0.0f;
+    std::vector<AnimationChannel> channels;
+};
+
+// 从 aiScene::mAnimations 读取全部片段，tick 换算成秒
+void loadAnimationClips(const aiScene *scene, std::vector<AnimationClip> &clips);
+
+// 一个通道的采样结果
+struct ChannelPose
+{
+    glm::vec3 position;
+    glm::quat rotation;
+    glm::vec3 scale;
+
+    glm::mat4 matrix() const;
+};
+
+// 与 AnimationSampler 相同的旋转插值（修正 nlerp，走最短路径），标量版本，供压缩时估计误差
+glm::quat blendRotation(const glm::quat &a, const glm::quat &b, float t);
+
+// 片段采样器
+// bind 时把关键帧的时间和值交错打包到连续数组，查找时前后两帧通常落在同一缓存行；
+// 每个轨道缓存上次所在的关键帧区间（游标），时间向前推进时只需向后挪几格，不做二分查找；
+// 查到的前后关键帧先按分量收集成 SoA 数组，再 4 路 SIMD 批量插值：
+// 平移/缩放为线性插值，旋转为带修正项的 nlerp（不需要 acos/sin，相邻关键帧夹角越小越接近 slerp）
+// 绑定压缩片段时不复制关键帧，收集阶段直接解码量化值，片段在采样期间必须保持有效
+class AnimationSampler
+{
+public:
+    AnimationSampler() {}
+    explicit AnimationSampler(const AnimationClip *clip) { bind(clip); }
+    explicit AnimationSampler(const CompressedClip *clip) { bind(clip); }
+    void bind(const AnimationClip *clip);
+    void bind(const CompressedClip *clip);
+
+    // time 超出片段长度时循环
+    void sample(float time);
+
+    size_t size() const { return channels; }
+    ChannelPose pose(size_t channel) const;
+
+private:
+    struct VectorKey
+    {
+        float time;
+        float value[3];
+    };
+
+    struct RotationKey
+    {
+        float time;
+        float value[4]; // x, y, z, w
+    };
+
+    // 一个轨道在打包数组中的范围和游标（相对 first 的下标）
+    struct Track
+    {
+        uint32_t first = 0, count = 0, cursor = 0;
+    };
+
+    size_t channels = 0;
+    float duration = 0.0f;
+    const CompressedClip *compressed = nullptr;
+    std::vector<VectorKey> vectorKeys;     // 全部平移与缩放关键帧
+    std::vector<RotationKey> rotationKeys; // 全部旋转关键帧
+    std::vector<Track> vectorTracks;       // 前 channels 个为平移，后 channels 个为缩放
+    std::vector<Track> rotationTracks;
+
+    // 插值输入与结果，按分量分开存放，长度向上取整到 4 的倍数
+    // 向量部分前一半为平移、后一半为缩放
+    std::vector<float> vectorA[3], vectorB[3], vectorT, vectorOut[3];
+    std::vector<float> quatA[4], quatB[4], quatT, quatOut[4];
+
+    void allocate();
+    void gather(float time);
+    void gatherCompressed(float time);
+    void blend();
+};
+
+#endif
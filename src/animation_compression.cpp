@@ -0,0 +1,285 @@
+#include "animation_compression.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+
+namespace
+{
+    // 一段最多跨越的原始关键帧数，限制贪心检查的 O(n^2) 开销
+    const size_t MAX_SEGMENT = 256;
+
+    uint16_t quantize(float value, float origin, float scale, float levels)
+    {
+        if (scale <= 0.0f)
+            return 0;
+        float q = std::round((value - origin) / scale);
+        return static_cast<uint16_t>(std::min(std::max(q, 0.0f), levels));
+    }
+
+    // 从第一个关键帧开始尽量延长线性段，fits(a, b, k) 判断只保留 a、b 时 k 是否仍在容差内
+    template <typename Fits>
+    std::vector<uint32_t> reduceKeys(size_t count, Fits fits)
+    {
+        std::vector<uint32_t> kept;
+        if (count == 0)
+            return kept;
+        kept.push_back(0);
+        size_t anchor = 0;
+        for (size_t end = 2; end < count; end++)
+        {
+            // 两端也要检查：时间量化会让保留的关键帧本身偏离原位置
+            bool ok = end - anchor <= MAX_SEGMENT;
+            for (size_t k = anchor; ok && k <= end; k++)
+                ok = fits(anchor, end, k);
+            if (!ok)
+            {
+                kept.push_back(static_cast<uint32_t>(end - 1));
+                anchor = end - 1;
+            }
+        }
+        if (count > 1)
+            kept.push_back(static_cast<uint32_t>(count - 1));
+        return kept;
+    }
+
+    float interpolationT(float time, float a, float b)
+    {
+        return b > a ? std::min(std::max((time - a) / (b - a), 0.0f), 1.0f) : 0.0f;
+    }
+
+    void compressVectorTrack(const VectorKeys &keys, float tolerance, const std::vector<uint16_t> &times,
+                             CompressedClip &clip)
+    {
+        CompressedClip::VectorTrack track;
+        track.first = static_cast<uint32_t>(clip.vectorKeys.size());
+        size_t count = keys.values.size();
+        if (count == 0)
+        {
+            clip.vectorTracks.push_back(track);
+            return;
+        }
+
+        glm::vec3 lo = keys.values[0], hi = keys.values[0];
+        for (const glm::vec3 &value : keys.values)
+        {
+            lo = glm::min(lo, value);
+            hi = glm::max(hi, value);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            track.origin[i] = lo[i];
+            track.scale[i] = (hi[i] - lo[i]) / 65535.0f;
+        }
+
+        // 整条轨道在容差内不变时只存一个关键帧
+        if (glm::length(hi - lo) * 0.5f <= tolerance)
+        {
+            CompressedClip::VectorKey key = {0, {32768, 32768, 32768}};
+            for (int i = 0; i < 3; i++)
+                if (track.scale[i] <= 0.0f)
+                    key.value[i] = 0;
+            clip.vectorKeys.push_back(key);
+            track.count = 1;
+            clip.vectorTracks.push_back(track);
+            return;
+        }
+
+        // 误差按解码后的值和量化后的时间计算，量化误差也计入容差
+        std::vector<CompressedClip::VectorKey> quantized(count);
+        std::vector<glm::vec3> decoded(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            quantized[k].time = times[k];
+            for (int i = 0; i < 3; i++)
+                quantized[k].value[i] = quantize(keys.values[k][i], track.origin[i], track.scale[i], 65535.0f);
+            float value[3];
+            CompressedClip::decode(track, quantized[k], value);
+            decoded[k] = glm::vec3(value[0], value[1], value[2]);
+        }
+        std::vector<uint32_t> kept = reduceKeys(count, [&](size_t a, size_t b, size_t k)
+        {
+            float t = interpolationT(keys.times[k] / clip.timeStep, times[a], times[b]);
+            return glm::length(glm::mix(decoded[a], decoded[b], t) - keys.values[k]) <= tolerance;
+        });
+        for (uint32_t k : kept)
+            clip.vectorKeys.push_back(quantized[k]);
+        track.count = static_cast<uint32_t>(kept.size());
+        clip.vectorTracks.push_back(track);
+    }
+
+    CompressedClip::RotationKey encodeRotation(glm::quat q, uint16_t time)
+    {
+        const float range = 0.70710678f;
+        float c[4] = {q.x, q.y, q.z, q.w};
+        int largest = 0;
+        for (int i = 1; i < 4; i++)
+            if (std::fabs(c[i]) > std::fabs(c[largest]))
+                largest = i;
+        // q 与 -q 是同一个旋转，让被去掉的分量为正，解码时取正根
+        float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+        CompressedClip::RotationKey key;
+        key.time = time;
+        for (int i = 0, slot = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float v = std::min(std::max(c[i] * sign, -range), range);
+            key.value[slot++] = static_cast<uint16_t>(std::round((v + range) / (2.0f * range) * 32767.0f));
+        }
+        key.value[0] |= static_cast<uint16_t>((largest & 1) << 15);
+        key.value[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+        return key;
+    }
+
+    // 用 atan2 而不是 acos(dot)：夹角很小时 dot 接近 1，float 的 acos 误差在 1e-3 弧度量级
+    float angleBetween(const glm::quat &a, const glm::quat &b)
+    {
+        glm::quat d = glm::inverse(a) * b;
+        return 2.0f * std::atan2(glm::length(glm::vec3(d.x, d.y, d.z)), std::fabs(d.w));
+    }
+
+    void compressRotationTrack(const RotationKeys &keys, float tolerance, const std::vector<uint16_t> &times,
+                               CompressedClip &clip)
+    {
+        CompressedClip::RotationTrack track;
+        track.first = static_cast<uint32_t>(clip.rotationKeys.size());
+        size_t count = keys.values.size();
+
+        std::vector<CompressedClip::RotationKey> quantized(count);
+        std::vector<glm::quat> decoded(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            quantized[k] = encodeRotation(glm::normalize(keys.values[k]), times[k]);
+            float value[4];
+            CompressedClip::decode(quantized[k], value);
+            decoded[k] = glm::quat(value[3], value[0], value[1], value[2]);
+        }
+
+        bool constant = count > 0;
+        for (size_t k = 1; constant && k < count; k++)
+            constant = angleBetween(decoded[k], decoded[0]) <= tolerance;
+        std::vector<uint32_t> kept;
+        if (constant)
+            kept.push_back(0);
+        else
+            kept = reduceKeys(count, [&](size_t a, size_t b, size_t k)
+            {
+                float t = interpolationT(keys.times[k] / clip.timeStep, times[a], times[b]);
+                return angleBetween(blendRotation(decoded[a], decoded[b], t), keys.values[k]) <= tolerance;
+            });
+        for (uint32_t k : kept)
+        {
+            CompressedClip::RotationKey key = quantized[k];
+            if (constant)
+                key.time = 0;
+            clip.rotationKeys.push_back(key);
+        }
+        track.count = static_cast<uint32_t>(kept.size());
+        clip.rotationTracks.push_back(track);
+    }
+
+    // 动捕等按固定频率采样的片段，关键帧时间都是最小间隔的整数倍，按帧号存放没有时间误差；
+    // 否则退回片段长度的 1/65535
+    float detectTimeStep(const AnimationClip &clip)
+    {
+        float fallback = clip.duration > 0.0f ? clip.duration / 65535.0f : 1.0f;
+        std::vector<const std::vector<float> *> tracks;
+        for (const AnimationChannel &channel : clip.channels)
+        {
+            tracks.push_back(&channel.position.times);
+            tracks.push_back(&channel.rotation.times);
+            tracks.push_back(&channel.scale.times);
+        }
+
+        // 最小间隔；时间越大 float 舍入误差越大，取时间最靠前的那个间隔作为估计
+        float smallest = 1e30f, last = 0.0f;
+        for (const std::vector<float> *times : tracks)
+        {
+            for (size_t k = 1; k < times->size(); k++)
+                if ((*times)[k] - (*times)[k - 1] > 1e-6f)
+                    smallest = std::min(smallest, (*times)[k] - (*times)[k - 1]);
+            if (!times->empty())
+                last = std::max(last, times->back());
+        }
+        if (smallest >= 1e30f)
+            return fallback;
+        float step = smallest, earliest = 1e30f;
+        for (const std::vector<float> *times : tracks)
+            for (size_t k = 1; k < times->size(); k++)
+            {
+                float span = (*times)[k] - (*times)[k - 1];
+                if (std::fabs(span - smallest) <= smallest * 0.01f && (*times)[k - 1] < earliest)
+                {
+                    earliest = (*times)[k - 1];
+                    step = span;
+                }
+            }
+        if (last / step > 65535.0f)
+            return fallback;
+        step = last > 0.0f ? last / std::round(last / step) : step;
+
+        for (const std::vector<float> *times : tracks)
+            for (float time : *times)
+                if (std::fabs(time / step - std::round(time / step)) > 1e-2f)
+                    return fallback;
+        return step;
+    }
+
+    std::vector<uint16_t> quantizeTimes(const std::vector<float> &times, float timeStep)
+    {
+        std::vector<uint16_t> result(times.size());
+        for (size_t k = 0; k < times.size(); k++)
+            result[k] = quantize(times[k], 0.0f, timeStep, 65535.0f);
+        return result;
+    }
+}
+
+CompressedClip compressClip(const AnimationClip &clip, const CompressionSettings &settings)
+{
+    CompressedClip result;
+    result.name = clip.name;
+    result.duration = clip.duration;
+    result.timeStep = detectTimeStep(clip);
+    size_t channels = clip.channels.size();
+    result.nodes.reserve(channels);
+    result.vectorTracks.reserve(channels * 2);
+    result.rotationTracks.reserve(channels);
+
+    // 与 AnimationSampler 一致：先全部平移，再全部缩放
+    for (const AnimationChannel &channel : clip.channels)
+    {
+        result.nodes.push_back(channel.node);
+        compressVectorTrack(channel.position, settings.positionError, quantizeTimes(channel.position.times, result.timeStep), result);
+    }
+    for (const AnimationChannel &channel : clip.channels)
+        compressVectorTrack(channel.scale, settings.scaleError, quantizeTimes(channel.scale.times, result.timeStep), result);
+    for (const AnimationChannel &channel : clip.channels)
+        compressRotationTrack(channel.rotation, settings.rotationError, quantizeTimes(channel.rotation.times, result.timeStep), result);
+
+    result.vectorKeys.shrink_to_fit();
+    result.rotationKeys.shrink_to_fit();
+    return result;
+}
+
+size_t CompressedClip::memoryBytes() const
+{
+    size_t bytes = sizeof(CompressedClip) + name.capacity();
+    for (const std::string &node : nodes)
+        bytes += sizeof(std::string) + node.capacity();
+    bytes += vectorTracks.capacity() * sizeof(VectorTrack) + rotationTracks.capacity() * sizeof(RotationTrack);
+    bytes += vectorKeys.capacity() * sizeof(VectorKey) + rotationKeys.capacity() * sizeof(RotationKey);
+    return bytes;
+}
+
+size_t clipMemoryBytes(const AnimationClip &clip)
+{
+    size_t bytes = sizeof(AnimationClip) + clip.name.capacity();
+    for (const AnimationChannel &channel : clip.channels)
+    {
+        bytes += sizeof(AnimationChannel) + channel.node.capacity();
+        bytes += channel.position.times.capacity() * sizeof(float) + channel.position.values.capacity() * sizeof(glm::vec3);
+        bytes += channel.rotation.times.capacity() * sizeof(float) + channel.rotation.values.capacity() * sizeof(glm::quat);
+        bytes += channel.scale.times.capacity() * sizeof(float) + channel.scale.values.capacity() * sizeof(glm::vec3);
+    }
+    return bytes;
+}
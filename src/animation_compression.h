@@ -0,0 +1,94 @@
+#ifndef ANIMATION_COMPRESSION_H
+#define ANIMATION_COMPRESSION_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "animation.h"
+
+// 关键帧片段压缩
+// 1. 关键帧删减：贪心延长线性段，段内每个被删掉的关键帧与插值结果的误差都在容差内；
+//    分段线性曲线之间的最大偏差出现在关键帧处，所以整条曲线的误差也在容差内
+// 2. 平移/缩放按轨道的包围盒量化为 3 x 16 位
+// 3. 旋转用 smallest-three：去掉绝对值最大的分量，其余三个各 15 位，被去掉的下标占 2 位
+// 4. 关键帧落在固定采样间隔上时时间按帧号存放，否则量化为片段长度的 1/65535
+// 每个关键帧 8 字节（原始为 16/20 字节），解码只需乘加和一次开方，由 AnimationSampler 在采样时直接解码
+
+struct CompressionSettings
+{
+    float positionError = 1e-3f; // 与模型单位相同
+    float rotationError = 1e-3f; // 弧度
+    float scaleError = 1e-3f;
+};
+
+struct CompressedClip
+{
+    struct VectorKey
+    {
+        uint16_t time;
+        uint16_t value[3];
+    };
+
+    struct RotationKey
+    {
+        uint16_t time;
+        uint16_t value[3]; // value[0]、value[1] 的最高位是被去掉分量的下标
+    };
+
+    struct VectorTrack
+    {
+        uint32_t first = 0, count = 0;
+        float origin[3] = {0.0f, 0.0f, 0.0f};
+        float scale[3] = {0.0f, 0.0f, 0.0f}; // 量化步长 = 范围 / 65535
+    };
+
+    struct RotationTrack
+    {
+        uint32_t first = 0, count = 0;
+    };
+
+    std::string name;
+    float duration = 0.0f;
+    float timeStep = 1.0f; // 一个时间单位对应的秒数（采样间隔或片段长度 / 65535）
+    std::vector<std::string> nodes;        // 各通道的目标节点名
+    std::vector<VectorTrack> vectorTracks; // 前 channels() 个为平移，后 channels() 个为缩放
+    std::vector<RotationTrack> rotationTracks;
+    std::vector<VectorKey> vectorKeys;
+    std::vector<RotationKey> rotationKeys;
+
+    size_t channels() const { return nodes.size(); }
+    size_t memoryBytes() const;
+
+    static void decode(const VectorTrack &track, const VectorKey &key, float out[3])
+    {
+        for (int i = 0; i < 3; i++)
+            out[i] = track.origin[i] + track.scale[i] * key.value[i];
+    }
+
+    // 输出顺序 x, y, z, w
+    static void decode(const RotationKey &key, float out[4])
+    {
+        const float range = 0.70710678f; // 被保留的三个分量在 [-1/√2, 1/√2] 内
+        int largest = (key.value[0] >> 15) | ((key.value[1] >> 15) << 1);
+        float sum = 0.0f;
+        for (int i = 0, slot = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float v = (key.value[slot++] & 0x7fff) * (2.0f * range / 32767.0f) - range;
+            out[i] = v;
+            sum += v * v;
+        }
+        out[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    }
+};
+
+CompressedClip compressClip(const AnimationClip &clip, const CompressionSettings &settings = CompressionSettings());
+// 未压缩片段的内存占用（关键帧数组、通道和名字）
+size_t clipMemoryBytes(const AnimationClip &clip);
+
+#endif
@@ -0,0 +1,2042 @@
+// 性能基准测试，不创建窗口；需要 GL 的基准用无窗口上下文（见 headless.h）
+// 用法: Benchmark <名称> [参数...]，不带名称时列出所有基准
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include "model_loader.h"
+#include "obj_loader.h"
+#include "scene_graph.h"
+#include "scene.h"
+#include "job_system.h"
+#include "frame_jobs.h"
+#include "frame_pipeline.h"
+#include "fixed_timestep.h"
+#include "animation.h"
+#include "animation_compression.h"
+#include "skinning.h"
+#include "trace.h"
+#include "headless.h"
+#include "program_cache.h"
+#include "shader.h"
+#include "shader_manager.h"
+#include "shader_variants.h"
+#include "framebuffer.h"
+#include "shadow_cascades.h"
+#include "shadow_map.h"
+#include "light_clusters.h"
+#include "light_buffers.h"
+#include "gbuffer.h"
+#include "ssao.h"
+#include "render_target_pool.h"
+#include "post_process.h"
+#include "uniform_blocks.h"
+#include <thread>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace
+{
+    double nowMs()
+    {
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 生成一个 N x N 网格的 OBJ，共 2*N*N 个三角形
+    void writeGridObj(const std::string &path, size_t faces)
+    {
+        size_t n = 1;
+        while (2 * (n + 1) * (n + 1) <= faces)
+            ++n;
+        FILE *file = std::fopen(path.c_str(), "w");
+        if (!file)
+            return;
+        for (size_t y = 0; y <= n; y++)
+            for (size_t x = 0; x <= n; x++)
+                std::fprintf(file, "v %.4f %.4f %.4f\n", x * 0.01f, 0.1f * std::sin(x * 0.05f + y * 0.03f), y * 0.01f);
+        for (size_t y = 0; y <= n; y++)
+            for (size_t x = 0; x <= n; x++)
+                std::fprintf(file, "vt %.4f %.4f\n", float(x) / n, float(y) / n);
+        for (size_t y = 0; y < n; y++)
+            for (size_t x = 0; x < n; x++)
+            {
+                size_t a = y * (n + 1) + x + 1;
+                size_t b = a + 1, c = a + n + 2, d = a + n + 1;
+                std::fprintf(file, "f %zu/%zu %zu/%zu %zu/%zu\nf %zu/%zu %zu/%zu %zu/%zu\n", a, a, b, b, c, c, a, a, c, c, d, d);
+            }
+        std::fclose(file);
+    }
+
+    void compareObjLoaders(const std::string &path)
+    {
+        double start = nowMs();
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
+        double assimpMs = nowMs() - start;
+        size_t assimpVertices = 0, assimpIndices = 0;
+        for (unsigned int i = 0; scene && i < scene->mNumMeshes; i++)
+        {
+            assimpVertices += scene->mMeshes[i]->mNumVertices;
+            assimpIndices += scene->mMeshes[i]->mNumFaces * 3;
+        }
+
+        start = nowMs();
+        ObjScene objScene;
+        loadObj(path, objScene);
+        double objMs = nowMs() - start;
+        size_t objVertices = 0, objIndices = 0;
+        for (const ObjMesh &mesh : objScene.meshes)
+        {
+            objVertices += mesh.vertices.size();
+            objIndices += mesh.indices.size();
+        }
+
+        std::printf("%s\n", path.c_str());
+        std::printf("  assimp : %9.1f ms  %zu vertices  %zu indices\n", assimpMs, assimpVertices, assimpIndices);
+        std::printf("  obj    : %9.1f ms  %zu vertices  %zu indices  (%.2fx)\n", objMs, objVertices, objIndices,
+                    objMs > 0.0 ? assimpMs / objMs : 0.0);
+    }
+
+    // obj [模型路径] [生成的面数]
+    void benchObjLoader(const std::vector<std::string> &args)
+    {
+        std::string path = args.size() > 0 ? args[0] : "resources/model.obj";
+        size_t faces = args.size() > 1 ? std::strtoull(args[1].c_str(), nullptr, 10) : 10000000;
+        compareObjLoaders(path);
+
+        std::string generated = "/tmp/benchmark_grid.obj";
+        writeGridObj(generated, faces);
+        compareObjLoaders(generated);
+        std::remove(generated.c_str());
+    }
+
+    // scenegraph [节点数] [每帧变化比例] [帧数]
+    void benchSceneGraph(const std::vector<std::string> &args)
+    {
+        size_t numNodes = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 100000;
+        double changeRatio = args.size() > 1 ? std::atof(args[1].c_str()) : 0.01;
+        int frames = args.size() > 2 ? std::atoi(args[2].c_str()) : 1000;
+
+        // 随机先序树：新节点挂在当前祖先链上的某一层
+        std::mt19937 rng(42);
+        SceneGraph graph;
+        std::vector<int> chain(1, graph.addNode(-1, glm::mat4(1.0f)));
+        for (size_t i = 1; i < numNodes; i++)
+        {
+            size_t keep = 1 + rng() % chain.size();
+            chain.resize(keep);
+            glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+            chain.push_back(graph.addNode(chain.back(), local));
+        }
+
+        size_t changesPerFrame = std::max<size_t>(1, static_cast<size_t>(numNodes * changeRatio));
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(numNodes) - 1);
+        glm::mat4 local = glm::rotate(glm::mat4(1.0f), 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        size_t updated = 0;
+        double start = nowMs();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (size_t i = 0; i < changesPerFrame; i++)
+                graph.setLocal(pick(rng), local);
+            updated += graph.update();
+        }
+        double dirtyMs = (nowMs() - start) / frames;
+
+        start = nowMs();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (size_t i = 0; i < changesPerFrame; i++)
+                graph.setLocal(pick(rng), local);
+            graph.updateAll();
+        }
+        double fullMs = (nowMs() - start) / frames;
+
+        std::printf("%zu nodes, %zu changes/frame, %d frames\n", numNodes, changesPerFrame, frames);
+        std::printf("  dirty update : %8.3f ms/frame  %zu nodes recomputed/frame\n", dirtyMs, updated / frames);
+        std::printf("  full update  : %8.3f ms/frame\n", fullMs);
+    }
+
+    // ecs [实体数] [帧数]
+    void benchScene(const std::vector<std::string> &args)
+    {
+        size_t numEntities = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 100000;
+        int frames = args.size() > 1 ? std::atoi(args[1].c_str()) : 100;
+
+        Scene scene;
+        for (size_t i = 0; i < numEntities; i++)
+        {
+            Entity entity = scene.create();
+            scene.transforms.add(entity).position = glm::vec3(float(i % 100), 0.0f, float(i / 100));
+            scene.meshes.add(entity).localRadius = 1.0f;
+            scene.materials.add(entity);
+            scene.animations.add(entity).dancing = (i % 2) == 0;
+            scene.bounds.add(entity);
+        }
+
+        std::vector<DrawPacket> packets;
+        double updateMs = 0.0, submitMs = 0.0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            double start = nowMs();
+            scene.updateAnimations(frame / 60.0f, 1.0f / 60.0f);
+            scene.updateTransforms();
+            scene.updateBounds();
+            double mid = nowMs();
+            packets.clear();
+            scene.submit(packets);
+            submitMs += nowMs() - mid;
+            updateMs += mid - start;
+        }
+        updateMs /= frames;
+        submitMs /= frames;
+        std::printf("%zu entities, %d frames\n", numEntities, frames);
+        std::printf("  update : %8.3f ms/frame  %6.1f M entities/s\n", updateMs, numEntities / updateMs / 1000.0);
+        std::printf("  submit : %8.3f ms/frame  %6.1f M packets/s\n", submitMs, packets.size() / submitMs / 1000.0);
+
+        // 同样的工作交给任务图，按线程数扩展
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 1000.0f) *
+                                   glm::lookAt(glm::vec3(50.0f, 20.0f, -20.0f), glm::vec3(50.0f, 0.0f, 500.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            JobSystem jobs(static_cast<int>(threads) - 1);
+            FrameJobs frameJobs(jobs);
+            double start = nowMs();
+            for (int frame = 0; frame < frames; frame++)
+                frameJobs.run(scene, frame / 60.0f, 1.0f / 60.0f, viewProjection, packets);
+            double frameMs = (nowMs() - start) / frames;
+            std::vector<float> utilization = jobs.sampleUtilization();
+            std::printf("  jobs x%-2u: %8.3f ms/frame  %zu visible  utilization", threads, frameMs, packets.size());
+            for (float u : utilization)
+                std::printf(" %.0f%%", u * 100.0f);
+            std::printf("\n");
+        }
+    }
+
+    // pipeline [实体数] [帧数] [每个绘制包的模拟提交开销]
+    // 渲染阶段没有 GL，用逐包矩阵运算代替驱动提交开销
+    void benchPipeline(const std::vector<std::string> &args)
+    {
+        size_t numEntities = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 200000;
+        int frames = args.size() > 1 ? std::atoi(args[1].c_str()) : 200;
+        int renderCost = args.size() > 2 ? std::atoi(args[2].c_str()) : 8;
+
+        Scene scene;
+        for (size_t i = 0; i < numEntities; i++)
+        {
+            Entity entity = scene.create();
+            scene.transforms.add(entity).position = glm::vec3(float(i % 100), 0.0f, float(i / 100));
+            scene.meshes.add(entity).localRadius = 1.0f;
+            scene.materials.add(entity);
+            scene.animations.add(entity).dancing = (i % 2) == 0;
+            scene.bounds.add(entity);
+        }
+        scene.camera.position = glm::vec3(50.0f, 20.0f, -20.0f);
+        scene.camera.front = glm::vec3(0.0f, -0.1f, 1.0f);
+
+        JobSystem jobs;
+        FrameJobs frameJobs(jobs);
+        auto simulate = [&](const FrameInput &frame, FrameSnapshot &snapshot)
+        {
+            const Camera &camera = scene.camera;
+            snapshot.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+            snapshot.projection = glm::perspective(glm::radians(45.0f), frame.aspect, 0.1f, 1000.0f);
+            frameJobs.run(scene, frame.time, frame.deltaTime, snapshot.projection * snapshot.view, snapshot.packets);
+            snapshot.camera = camera;
+            snapshot.lightPos = scene.lightPos;
+        };
+        FramePipeline pipeline(simulate, false);
+
+        std::printf("%zu entities, %d frames, render cost %d\n", numEntities, frames, renderCost);
+        double singleMs = 0.0;
+        for (bool threaded : {false, true})
+        {
+            pipeline.setThreaded(threaded);
+            double waitStart = pipeline.waitMs();
+            float checksum = 0.0f;
+            size_t drawn = 0;
+            double start = nowMs();
+            for (int i = 0; i < frames; i++)
+            {
+                FrameInput input;
+                input.time = i / 60.0f;
+                input.deltaTime = 1.0f / 60.0f;
+                input.aspect = 4.0f / 3.0f;
+                const FrameSnapshot &frame = pipeline.beginFrame(input);
+                glm::mat4 viewProjection = frame.projection * frame.view;
+                for (const DrawPacket &packet : frame.packets)
+                {
+                    glm::mat4 mvp = viewProjection * packet.matrix;
+                    for (int k = 1; k < renderCost; k++)
+                        mvp = viewProjection * mvp;
+                    checksum += mvp[3][3];
+                }
+                drawn += frame.packets.size();
+            }
+            double frameMs = (nowMs() - start) / frames;
+            if (!threaded)
+                singleMs = frameMs;
+            std::printf("  %-10s: %8.3f ms/frame  %7.1f fps  %zu packets/frame  render wait %.3f ms/frame  (checksum %g)\n",
+                        threaded ? "pipelined" : "serial", frameMs, 1000.0 / frameMs, drawn / frames,
+                        (pipeline.waitMs() - waitStart) / frames, checksum);
+            if (threaded)
+                std::printf("  throughput gain: %.2fx\n", singleMs / frameMs);
+        }
+    }
+
+    // timestep [实体数] [模拟秒数] [步频]
+    // 固定步长下每秒模拟开销与帧率无关；无窗口时可以远快于实时地推进模拟
+    void benchTimestep(const std::vector<std::string> &args)
+    {
+        size_t numEntities = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 100000;
+        double seconds = args.size() > 1 ? std::atof(args[1].c_str()) : 10.0;
+        double hz = args.size() > 2 ? std::atof(args[2].c_str()) : 60.0;
+
+        Scene scene;
+        for (size_t i = 0; i < numEntities; i++)
+        {
+            Entity entity = scene.create();
+            scene.transforms.add(entity).position = glm::vec3(float(i % 100), 0.0f, float(i / 100));
+            scene.meshes.add(entity).localRadius = 1.0f;
+            scene.animations.add(entity).dancing = (i % 2) == 0;
+            scene.bounds.add(entity);
+        }
+        JobSystem jobs;
+        FrameJobs frameJobs(jobs);
+        std::vector<DrawPacket> packets;
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 1000.0f) *
+                                   glm::lookAt(glm::vec3(50.0f, 20.0f, -20.0f), glm::vec3(50.0f, 0.0f, 500.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        std::printf("%zu entities, %.1f s simulated at %.0f Hz\n", numEntities, seconds, hz);
+        // 模拟不同显示帧率：每秒更新次数固定为步频，只有插值/提交随帧率增加
+        for (double fps : {30.0, 60.0, 144.0, 240.0})
+        {
+            FixedTimestep timestep(1.0 / hz, 1 << 20);
+            int frames = static_cast<int>(seconds * fps);
+            double updateMs = 0.0, buildMs = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                double start = nowMs();
+                timestep.accumulate(1.0 / fps);
+                while (timestep.step())
+                    frameJobs.update(scene, (float)timestep.time(), (float)timestep.delta());
+                double mid = nowMs();
+                frameJobs.build(scene, timestep.alpha(), viewProjection, packets);
+                buildMs += nowMs() - mid;
+                updateMs += mid - start;
+            }
+            std::printf("  %4.0f fps: %6.1f steps/s  update %7.2f ms per simulated second  build %6.3f ms/frame\n",
+                        fps, timestep.total() / seconds, updateMs / seconds, buildMs / frames);
+        }
+
+        // 无窗口：一次给足全部时间，尽快推进
+        FixedTimestep timestep(1.0 / hz, 1 << 20);
+        double start = nowMs();
+        timestep.accumulate(seconds);
+        while (timestep.step())
+            frameJobs.update(scene, (float)timestep.time(), (float)timestep.delta());
+        frameJobs.build(scene, timestep.alpha(), viewProjection, packets);
+        double wallMs = nowMs() - start;
+        std::printf("  headless : %llu steps in %.1f ms, %.1fx real time\n", timestep.total(), wallMs, seconds * 1000.0 / wallMs);
+    }
+
+    // 随机关键帧片段，每个通道的三组关键帧在 [0, duration] 内均匀分布
+    AnimationClip makeRandomClip(size_t numChannels, size_t numKeys, float duration)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        AnimationClip clip;
+        clip.name = "random";
+        clip.duration = duration;
+        clip.channels.resize(numChannels);
+        for (AnimationChannel &channel : clip.channels)
+        {
+            for (size_t k = 0; k < numKeys; k++)
+            {
+                float time = duration * k / (numKeys - 1);
+                channel.position.times.push_back(time);
+                channel.position.values.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)));
+                channel.rotation.times.push_back(time);
+                channel.rotation.values.push_back(glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng))));
+                channel.scale.times.push_back(time);
+                channel.scale.values.push_back(glm::vec3(1.0f + 0.1f * unit(rng)));
+            }
+        }
+        return clip;
+    }
+
+    // 对照实现：每次二分查找关键帧，逐通道 glm::slerp / glm::mix
+    ChannelPose sampleReference(const AnimationChannel &channel, float time)
+    {
+        auto locate = [time](const std::vector<float> &times, size_t &a, size_t &b, float &t)
+        {
+            size_t upper = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+            b = std::min(upper, times.size() - 1);
+            a = upper == 0 ? 0 : upper - 1;
+            t = b == a ? 0.0f : (time - times[a]) / (times[b] - times[a]);
+        };
+        size_t a, b;
+        float t;
+        ChannelPose pose;
+        locate(channel.position.times, a, b, t);
+        pose.position = glm::mix(channel.position.values[a], channel.position.values[b], t);
+        locate(channel.rotation.times, a, b, t);
+        pose.rotation = glm::slerp(channel.rotation.values[a], channel.rotation.values[b], t);
+        locate(channel.scale.times, a, b, t);
+        pose.scale = glm::mix(channel.scale.values[a], channel.scale.values[b], t);
+        return pose;
+    }
+
+    // animation [通道数] [每通道关键帧数] [帧数]
+    void benchAnimation(const std::vector<std::string> &args)
+    {
+        size_t numChannels = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 10000;
+        size_t numKeys = args.size() > 1 ? std::strtoull(args[1].c_str(), nullptr, 10) : 120;
+        int frames = args.size() > 2 ? std::atoi(args[2].c_str()) : 240;
+        numKeys = std::max<size_t>(numKeys, 2);
+
+        float duration = 4.0f;
+        AnimationClip clip = makeRandomClip(numChannels, numKeys, duration);
+        float step = 1.0f / 60.0f;
+
+        std::vector<ChannelPose> reference(numChannels);
+        double start = nowMs();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            float time = std::fmod(frame * step, duration);
+            for (size_t c = 0; c < numChannels; c++)
+                reference[c] = sampleReference(clip.channels[c], time);
+        }
+        double referenceMs = nowMs() - start;
+
+        AnimationSampler sampler(&clip);
+        start = nowMs();
+        for (int frame = 0; frame < frames; frame++)
+            sampler.sample(frame * step);
+        double samplerMs = nowMs() - start;
+
+        // 与 slerp 的最大角度误差（最后一帧）
+        float maxAngle = 0.0f, maxPosition = 0.0f;
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            ChannelPose pose = sampler.pose(c);
+            float d = std::min(1.0f, std::fabs(glm::dot(pose.rotation, reference[c].rotation)));
+            maxAngle = std::max(maxAngle, 2.0f * std::acos(d));
+            maxPosition = std::max(maxPosition, glm::length(pose.position - reference[c].position));
+        }
+
+        double tracks = double(numChannels) * frames;
+        std::printf("%zu channels x %zu keys, %d frames\n", numChannels, numKeys, frames);
+        std::printf("  reference (bsearch + glm::slerp): %8.3f ms/frame  %8.0f tracks/ms\n", referenceMs / frames, tracks / referenceMs);
+        std::printf("  cursor + SoA batch              : %8.3f ms/frame  %8.0f tracks/ms  (%.2fx)\n", samplerMs / frames, tracks / samplerMs, referenceMs / samplerMs);
+        std::printf("  max error: rotation %.2e rad, position %.2e\n", maxAngle, maxPosition);
+    }
+
+    // skinning [角色数] [每角色顶点数] [骨骼数] [帧数]
+    // 所有角色共用一份网格，各自一套骨骼姿态；GPU 路径需要 GL 上下文，这里只测 CPU 路径
+    void benchSkinning(const std::vector<std::string> &args)
+    {
+        size_t numCharacters = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 1000;
+        size_t numVertices = args.size() > 1 ? std::strtoull(args[1].c_str(), nullptr, 10) : 5000;
+        size_t numBones = args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 10) : 64;
+        int frames = args.size() > 3 ? std::atoi(args[3].c_str()) : 10;
+        numBones = std::max<size_t>(1, std::min<size_t>(numBones, MAX_BONES));
+        numCharacters = std::max<size_t>(1, numCharacters);
+        numVertices = std::max<size_t>(1, numVertices);
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> share(0.0f, 1.0f);
+        std::vector<Vertex> vertices(numVertices);
+        std::vector<VertexWeights> weights(numVertices);
+        for (size_t i = 0; i < numVertices; i++)
+        {
+            vertices[i].Position = glm::vec3(unit(random), unit(random), unit(random));
+            vertices[i].Normal = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+            vertices[i].TexCoords = glm::vec2(0.0f);
+            // 大多数顶点受 2~4 根相邻骨骼影响
+            size_t first = random() % numBones;
+            int influences = 2 + random() % 3;
+            for (int k = 0; k < influences; k++)
+                weights[i].add(static_cast<int>((first + k) % numBones), share(random) + 0.01f);
+            weights[i].normalize();
+        }
+
+        // 骨骼链：每根骨骼挂在前一根之下
+        std::vector<glm::mat4> offsets(numBones);
+        for (size_t b = 0; b < numBones; b++)
+            offsets[b] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.1f * b, 0.0f));
+        std::vector<std::vector<PaletteMatrix>> palettes(numCharacters, std::vector<PaletteMatrix>(numBones));
+        auto evaluatePose = [&](size_t character, float time)
+        {
+            glm::mat4 world(1.0f);
+            for (size_t b = 0; b < numBones; b++)
+            {
+                float angle = 0.2f * std::sin(time * 2.0f + character * 0.37f + b * 0.11f);
+                world = world * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.1f, 0.0f)) *
+                        glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f));
+                palettes[character][b] = toPaletteMatrix(world * offsets[b]);
+            }
+        };
+
+        std::vector<SkinnedVertex> output(numVertices), scalarOutput(numVertices);
+        double poseMs = 0.0;
+        auto runSingle = [&](SkinningPath path) -> double
+        {
+            double start = nowMs();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                double poseStart = nowMs();
+                for (size_t c = 0; c < numCharacters; c++)
+                    evaluatePose(c, frame / 60.0f);
+                poseMs += nowMs() - poseStart;
+                for (size_t c = 0; c < numCharacters; c++)
+                    skinVertices(path, vertices.data(), weights.data(), numVertices, palettes[c].data(), output.data());
+            }
+            return (nowMs() - start) / frames;
+        };
+
+        double vertsPerFrame = double(numCharacters) * numVertices;
+        std::printf("%zu characters x %zu vertices, %zu bones, %d frames\n", numCharacters, numVertices, numBones, frames);
+        double scalarMs = runSingle(SkinningPath::CpuScalar);
+        scalarOutput = output;
+        std::printf("  pose     : %8.3f ms/frame\n", poseMs / frames);
+        std::printf("  scalar   : %8.3f ms/frame  %6.1f M vertices/s\n", scalarMs, vertsPerFrame / scalarMs / 1000.0);
+        if (!cpuSupportsAvx2())
+        {
+            std::printf("  avx2     : unsupported on this CPU\n");
+            return;
+        }
+        double avxMs = runSingle(SkinningPath::CpuAvx2);
+        float maxError = 0.0f;
+        for (size_t i = 0; i < numVertices; i++)
+        {
+            maxError = std::max(maxError, glm::length(output[i].Position - scalarOutput[i].Position));
+            maxError = std::max(maxError, glm::length(output[i].Normal - scalarOutput[i].Normal));
+        }
+        std::printf("  avx2     : %8.3f ms/frame  %6.1f M vertices/s  (%.2fx, max error %.2e)\n", avxMs,
+                    vertsPerFrame / avxMs / 1000.0, scalarMs / avxMs, maxError);
+
+        // 输出缓冲后面放一个哨兵顶点：最后一个顶点的写入不能越过缓冲末尾
+        std::vector<SkinnedVertex> guarded(numVertices + 1);
+        const float sentinel = 12345.0f;
+        guarded[numVertices].Position = guarded[numVertices].Normal = glm::vec3(sentinel);
+        skinVertices(SkinningPath::CpuAvx2, vertices.data(), weights.data(), numVertices, palettes[0].data(), guarded.data());
+        skinVertices(SkinningPath::CpuScalar, vertices.data(), weights.data(), numVertices, palettes[0].data(), scalarOutput.data());
+        const SkinnedVertex &last = guarded[numVertices - 1], &expected = scalarOutput[numVertices - 1];
+        float lastError = std::max(glm::length(last.Position - expected.Position), glm::length(last.Normal - expected.Normal));
+        bool intact = guarded[numVertices].Position == glm::vec3(sentinel) && guarded[numVertices].Normal == glm::vec3(sentinel);
+        std::printf("  avx2 last vertex error %.2e, write past end: %s\n", lastError, intact ? "none" : "DETECTED");
+
+        // 按角色分块交给任务系统，每个线程写自己的输出缓冲
+        unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 2; threads <= maxThreads; threads *= 2)
+        {
+            JobSystem jobs(static_cast<int>(threads) - 1);
+            double start = nowMs();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                JobSystem::Counter counter;
+                jobs.parallelFor(numCharacters, 8, [&](size_t begin, size_t end)
+                                 {
+                    thread_local std::vector<SkinnedVertex> local;
+                    local.resize(numVertices);
+                    for (size_t c = begin; c < end; c++)
+                    {
+                        evaluatePose(c, frame / 60.0f);
+                        skinVertices(SkinningPath::CpuAvx2, vertices.data(), weights.data(), numVertices, palettes[c].data(), local.data());
+                    } }, counter);
+                jobs.wait(counter);
+            }
+            double frameMs = (nowMs() - start) / frames;
+            std::printf("  avx2 x%-2u : %8.3f ms/frame  %6.1f M vertices/s  (pose included)\n", threads, frameMs,
+                        vertsPerFrame / frameMs / 1000.0);
+        }
+    }
+
+    // 类似动捕的片段：固定频率采样，旋转为平滑曲线加少量噪声，只有根通道有平移，缩放恒为 1
+    AnimationClip makeMocapClip(size_t numChannels, float seconds, float hz)
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        size_t numKeys = std::max<size_t>(2, static_cast<size_t>(seconds * hz) + 1);
+        AnimationClip clip;
+        clip.name = "mocap";
+        clip.duration = (numKeys - 1) / hz;
+        clip.channels.resize(numChannels);
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            AnimationChannel &channel = clip.channels[c];
+            channel.node = "bone" + std::to_string(c);
+            glm::vec3 frequency(0.3f + 2.0f * std::fabs(unit(rng)), 0.3f + 2.0f * std::fabs(unit(rng)), 0.3f + 2.0f * std::fabs(unit(rng)));
+            glm::vec3 amplitude(0.6f * unit(rng), 0.6f * unit(rng), 0.3f * unit(rng));
+            glm::vec3 offset(0.0f, 0.1f + 0.1f * std::fabs(unit(rng)), 0.0f);
+            for (size_t k = 0; k < numKeys; k++)
+            {
+                float time = k / hz;
+                glm::vec3 euler = amplitude * glm::vec3(std::sin(time * frequency.x), std::sin(time * frequency.y), std::cos(time * frequency.z));
+                euler += glm::vec3(unit(rng), unit(rng), unit(rng)) * 1e-4f;
+                channel.rotation.times.push_back(time);
+                channel.rotation.values.push_back(glm::quat(euler));
+                channel.position.times.push_back(time);
+                channel.position.values.push_back(c == 0 ? glm::vec3(std::sin(time * 0.5f), 0.05f * std::sin(time * 4.0f), time * 1.2f) : offset);
+                channel.scale.times.push_back(time);
+                channel.scale.values.push_back(glm::vec3(1.0f));
+            }
+        }
+        return clip;
+    }
+
+    // compression [通道数] [秒数] [采样频率]
+    void benchCompression(const std::vector<std::string> &args)
+    {
+        size_t numChannels = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : 64;
+        float seconds = args.size() > 1 ? static_cast<float>(std::atof(args[1].c_str())) : 120.0f;
+        float hz = args.size() > 2 ? static_cast<float>(std::atof(args[2].c_str())) : 60.0f;
+
+        AnimationClip clip = makeMocapClip(numChannels, seconds, hz);
+        double start = nowMs();
+        CompressionSettings settings;
+        CompressedClip compressed = compressClip(clip, settings);
+        double compressMs = nowMs() - start;
+
+        size_t rawKeys = 0;
+        for (const AnimationChannel &channel : clip.channels)
+            rawKeys += channel.position.values.size() + channel.rotation.values.size() + channel.scale.values.size();
+        size_t keptKeys = compressed.vectorKeys.size() + compressed.rotationKeys.size();
+        size_t rawBytes = clipMemoryBytes(clip), compressedBytes = compressed.memoryBytes();
+        std::printf("%zu channels, %.0f s at %.0f Hz (%zu keys)\n", numChannels, clip.duration, hz, rawKeys);
+        std::printf("  memory   : raw %8.1f KB  compressed %8.1f KB  (%.1fx, %.1f%% keys kept)  compress %.1f ms\n",
+                    rawBytes / 1024.0, compressedBytes / 1024.0, double(rawBytes) / compressedBytes, 100.0 * keptKeys / rawKeys, compressMs);
+
+        // 播放一遍：两个采样器的每帧开销，以及压缩结果相对原始曲线（二分 + slerp）的误差
+        AnimationSampler rawSampler(&clip), compressedSampler(&compressed);
+        float step = 1.0f / 60.0f;
+        int frames = static_cast<int>(clip.duration / step);
+        double rawMs = 0.0, decodeMs = 0.0;
+        float maxPosition = 0.0f, maxRotation = 0.0f, maxScale = 0.0f;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            // 错开采样时间，不总是落在关键帧上
+            float time = frame * step + 0.37f * step;
+            start = nowMs();
+            rawSampler.sample(time);
+            rawMs += nowMs() - start;
+            start = nowMs();
+            compressedSampler.sample(time);
+            decodeMs += nowMs() - start;
+            for (size_t c = 0; c < numChannels; c++)
+            {
+                ChannelPose reference = sampleReference(clip.channels[c], time);
+                ChannelPose pose = compressedSampler.pose(c);
+                // 小角度下 acos(dot) 的 float 精度不够，用 atan2
+                glm::quat d = glm::inverse(reference.rotation) * pose.rotation;
+                maxRotation = std::max(maxRotation, 2.0f * std::atan2(glm::length(glm::vec3(d.x, d.y, d.z)), std::fabs(d.w)));
+                maxPosition = std::max(maxPosition, glm::length(pose.position - reference.position));
+                maxScale = std::max(maxScale, glm::length(pose.scale - reference.scale));
+            }
+        }
+        std::printf("  decode   : raw %8.4f ms/frame  compressed %8.4f ms/frame  (%.2fx)\n", rawMs / frames, decodeMs / frames, decodeMs / rawMs);
+        std::printf("  max error: position %.2e (tol %.0e)  rotation %.2e rad (tol %.0e)  scale %.2e (tol %.0e)\n",
+                    maxPosition, settings.positionError, maxRotation, settings.rotationError, maxScale, settings.scaleError);
+    }
+
+    // trace [每轮作用域数] [轮数] [线程数] [输出路径]
+    // 每轮结束后导出一次，缓冲不会写满；开销按空作用域计
+    void benchTrace(const std::vector<std::string> &args)
+    {
+        size_t scopes = args.size() > 0 ? std::strtoull(args[0].c_str(), nullptr, 10) : Trace::CAPACITY / 2;
+        int rounds = args.size() > 1 ? std::atoi(args[1].c_str()) : 20;
+        unsigned int numThreads = args.size() > 2 ? static_cast<unsigned int>(std::atoi(args[2].c_str())) : 4;
+        std::string path = args.size() > 3 ? args[3] : "trace.json";
+        scopes = std::min<size_t>(scopes, Trace::CAPACITY);
+
+        auto runScopes = [scopes]()
+        {
+            for (size_t i = 0; i < scopes; i++)
+                TraceScope scope("scope");
+        };
+
+        // 每个开启的作用域读两次时钟，单独测出来以区分时钟本身和记录的开销
+        uint64_t gaps = 0;
+        double start = nowMs();
+        for (size_t i = 0; i < scopes * rounds; i++)
+        {
+            uint64_t begin = Trace::now();
+            gaps += Trace::now() - begin;
+        }
+        double clockNs = (nowMs() - start) * 1e6 / (double(scopes) * rounds);
+
+        Trace::setEnabled(false);
+        start = nowMs();
+        for (int round = 0; round < rounds; round++)
+            runScopes();
+        double disabledNs = (nowMs() - start) * 1e6 / (double(scopes) * rounds);
+
+        Trace::setEnabled(true);
+        Trace::setThreadName("benchmark");
+        double recordMs = 0.0, writeMs = 0.0;
+        for (int round = 0; round < rounds; round++)
+        {
+            start = nowMs();
+            runScopes();
+            recordMs += nowMs() - start;
+            start = nowMs();
+            Trace::write(path);
+            writeMs += nowMs() - start;
+        }
+        double enabledNs = recordMs * 1e6 / (double(scopes) * rounds);
+
+        // 多个线程同时记录，各写各的缓冲
+        double threadedNs = 0.0;
+        for (int round = 0; round < rounds; round++)
+        {
+            std::vector<std::thread> threads;
+            std::vector<double> elapsed(numThreads);
+            for (unsigned int t = 0; t < numThreads; t++)
+                threads.emplace_back([&, t]()
+                                     {
+                    double begin = nowMs();
+                    runScopes();
+                    elapsed[t] = nowMs() - begin; });
+            for (std::thread &thread : threads)
+                thread.join();
+            for (double ms : elapsed)
+                threadedNs += ms * 1e6 / (double(scopes) * rounds * numThreads);
+            Trace::write(path);
+        }
+        Trace::setEnabled(false);
+
+        std::printf("%zu scopes x %d rounds\n", scopes, rounds);
+        std::printf("  2x now()   : %6.1f ns  (back-to-back gap %.1f ns)\n", clockNs, double(gaps) / (double(scopes) * rounds));
+        std::printf("  disabled   : %6.1f ns/scope\n", disabledNs);
+        std::printf("  enabled    : %6.1f ns/scope  (export %.2f ms per %zu events)\n", enabledNs, writeMs / rounds, scopes);
+        std::printf("  %u threads  : %6.1f ns/scope\n", numThreads, threadedNs);
+        std::printf("  dropped    : %llu\n", (unsigned long long)Trace::dropped());
+    }
+
+    // shaders [变体数] [缓存目录] [顶点着色器] [片段着色器]
+    // 模拟启动时编译一批变体：冷启动（空缓存，源码编译并写入二进制）vs 热启动（全部从二进制载入）
+    // 每次运行在定义里加一个随机种子，驱动自带的着色器缓存（例如 Mesa 的磁盘缓存）也不会命中冷启动
+    void benchShaderCache(const std::vector<std::string> &args)
+    {
+        int variants = args.size() > 0 ? std::atoi(args[0].c_str()) : 50;
+        std::string directory = args.size() > 1 ? args[1] : "shader_cache_benchmark";
+        std::string vertexPath = args.size() > 2 ? args[2] : "shaders/vertex.glsl";
+        std::string fragmentPath = args.size() > 3 ? args[3] : "shaders/fragment.glsl";
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::loadExtensions(HeadlessContext::loader());
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", program binary "
+                  << (ProgramCache::isSupported() ? "supported" : "unsupported (warm pass compiles again)") << std::endl;
+
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+        ProgramCache::setDirectory(directory);
+        std::mt19937 random(static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()));
+        unsigned int seed = random();
+        std::vector<std::string> defines(variants);
+        for (int i = 0; i < variants; i++)
+            defines[i] = "#define BENCHMARK_SEED " + std::to_string(seed) + "u\n#define VARIANT " + std::to_string(i) + "\n";
+
+        auto buildAll = [&](const char *label)
+        {
+            ProgramCache::resetStats();
+            double start = nowMs();
+            std::vector<GLuint> programs;
+            for (const std::string &define : defines)
+                programs.push_back(Shader(vertexPath.c_str(), fragmentPath.c_str(), define).ID);
+            glFinish();
+            double ms = nowMs() - start;
+            size_t failed = std::count(programs.begin(), programs.end(), 0u);
+            for (GLuint program : programs)
+                glDeleteProgram(program);
+            ProgramCache::Stats stats = ProgramCache::stats();
+            std::printf("%-5s %8.1f ms  %6.2f ms/variant  hits %llu  misses %llu  rejected %llu  failed %zu\n", label, ms, ms / variants,
+                        (unsigned long long)stats.hits, (unsigned long long)stats.misses, (unsigned long long)stats.rejected, failed);
+            return ms;
+        };
+        double cold = buildAll("cold");
+        uintmax_t bytes = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+            bytes += entry.file_size(error);
+        double warm = buildAll("warm");
+        std::printf("%d variants, cache %.1f KB, warm start %.1fx faster\n", variants, bytes / 1024.0, cold / warm);
+        std::filesystem::remove_all(directory, error);
+    }
+
+    // shadercompile [变体数] [顶点着色器] [片段着色器]
+    // 关闭程序缓存，启动时一次请求全部变体，之后每帧（2 ms 模拟工作）poll 直到全部就绪；
+    // 比较同步编译、共享上下文后台线程和 parallel_shader_compile 三种方式下主线程被占用的时间
+    void benchShaderCompile(const std::vector<std::string> &args)
+    {
+        int variants = args.size() > 0 ? std::atoi(args[0].c_str()) : 50;
+        std::string vertexPath = args.size() > 1 ? args[1] : "shaders/vertex.glsl";
+        std::string fragmentPath = args.size() > 2 ? args[2] : "shaders/fragment.glsl";
+
+        HeadlessContext context, compileContext;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::loadExtensions(HeadlessContext::loader());
+        ShaderManager::loadExtensions(HeadlessContext::loader());
+        ProgramCache::setDirectory("");
+        compileContext.createShared(context);
+        ShaderManager::WorkerContext worker;
+        worker.bind = [&compileContext]()
+        { compileContext.makeCurrent(); };
+        worker.unbind = []()
+        { HeadlessContext::releaseCurrent(); };
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", parallel_shader_compile "
+                  << (ShaderManager::hasParallelCompile() ? "yes" : "no") << ", " << std::thread::hardware_concurrency() << " threads" << std::endl;
+
+        std::mt19937 random(static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()));
+        const ShaderManager::Mode modes[] = {ShaderManager::Mode::Synchronous, ShaderManager::Mode::Worker, ShaderManager::Mode::Parallel};
+        const char *names[] = {"sync", "worker", "parallel"};
+        for (int m = 0; m < 3; m++)
+        {
+            if (modes[m] == ShaderManager::Mode::Parallel && !ShaderManager::hasParallelCompile())
+                continue;
+            ShaderManager manager;
+            manager.create(worker, modes[m]);
+            // 每种方式换一个种子，驱动自带的缓存不会命中
+            std::string seed = "#define BENCHMARK_SEED " + std::to_string(random()) + "u\n";
+            double start = nowMs();
+            std::vector<ShaderManager::Handle> handles;
+            for (int i = 0; i < variants; i++)
+                handles.push_back(manager.request(vertexPath, fragmentPath, seed + "#define VARIANT " + std::to_string(i) + "\n"));
+            double firstFrame = nowMs() - start;
+            int frames = 1;
+            double longestPoll = 0.0;
+            while (manager.pending() > 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                double pollStart = nowMs();
+                manager.poll();
+                longestPoll = std::max(longestPoll, nowMs() - pollStart);
+                frames++;
+            }
+            double total = nowMs() - start;
+            const ShaderManager::Stats &stats = manager.stats();
+            std::printf("%-8s requests %8.1f ms  longest poll %6.2f ms  all ready %8.1f ms  frames %4d  ready %llu  failed %llu\n",
+                        names[m], firstFrame, longestPoll, total, frames, (unsigned long long)stats.ready, (unsigned long long)stats.failed);
+            manager.destroy();
+        }
+        compileContext.destroy();
+    }
+
+    // variants [帧数] [宽x高] [叠加层数]
+    // 着色器排列 vs uniform 分支：同一份片段着色器，特性开关要么是 const bool（由 HAS_* 定义决定，编译期裁掉），
+    // 要么是 uniform bool（运行时分支）；全屏四边形叠加若干层，比较每帧片段着色的耗时
+    const char *VARIANT_BENCH_VERTEX = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+uniform float depth;
+void main()
+{
+    FragPos = vec3(aPos * 4.0, depth);
+    Normal = normalize(vec3(aPos * 0.3, 1.0));
+    TexCoords = aPos * 2.0 + 0.5;
+    gl_Position = vec4(aPos, depth * 0.1, 1.0);
+}
+)";
+
+    const char *VARIANT_BENCH_FRAGMENT = R"(#version 330 core
+out vec4 FragColor;
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+uniform sampler2D texture_diffuse1;
+uniform sampler2D texture_normal1;
+#ifdef DYNAMIC
+uniform bool hasTexture;
+uniform bool hasNormalMap;
+#else
+#ifdef HAS_TEXTURE
+const bool hasTexture = true;
+#else
+const bool hasTexture = false;
+#endif
+#ifdef HAS_NORMAL_MAP
+const bool hasNormalMap = true;
+#else
+const bool hasNormalMap = false;
+#endif
+#endif
+const vec3 lightPos = vec3(2.0, 3.0, 4.0);
+const vec3 viewPos = vec3(0.0, 0.0, 5.0);
+void main()
+{
+    vec3 albedo = vec3(1.0, 0.9, 0.9);
+    if (hasTexture)
+        albedo = texture(texture_diffuse1, TexCoords).rgb;
+    vec3 norm = normalize(Normal);
+    if (hasNormalMap)
+    {
+        vec3 dp1 = dFdx(FragPos), dp2 = dFdy(FragPos);
+        vec2 duv1 = dFdx(TexCoords), duv2 = dFdy(TexCoords);
+        vec3 dp2perp = cross(dp2, norm), dp1perp = cross(norm, dp1);
+        vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+        vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+        float invmax = inversesqrt(max(max(dot(T, T), dot(B, B)), 1e-8));
+        vec3 tangentNormal = texture(texture_normal1, TexCoords).xyz * 2.0 - 1.0;
+        norm = normalize(mat3(T * invmax, B * invmax, norm) * tangentNormal);
+    }
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32.0);
+    FragColor = vec4((0.1 + diff + 0.5 * spec) * albedo, 1.0);
+}
+)";
+
+    void benchShaderVariants(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 20;
+        int width = 1280, height = 720;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+        int layers = args.size() > 2 ? std::atoi(args[2].c_str()) : 4;
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << ", "
+                  << layers << " layers" << std::endl;
+
+        Framebuffer target;
+        if (!target.create(width, height))
+            return;
+        target.bind();
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_ALWAYS);
+
+        // 两张随机纹理，法线贴图的 z 分量偏向 +1
+        std::mt19937 random(7);
+        const int TEXTURE_SIZE = 256;
+        std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+        GLuint textures[2];
+        glGenTextures(2, textures);
+        for (int t = 0; t < 2; t++)
+        {
+            for (size_t i = 0; i < pixels.size(); i++)
+                pixels[i] = (t == 1 && i % 4 == 2) ? 200 + random() % 56 : random() % 256;
+            glActiveTexture(GL_TEXTURE0 + t);
+            glBindTexture(GL_TEXTURE_2D, textures[t]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+
+        const float quad[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        GLuint vao, vbo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+
+        auto build = [](const std::string &defines)
+        {
+            GLuint program = ProgramCache::build(Shader::injectDefines(VARIANT_BENCH_VERTEX, defines),
+                                                 Shader::injectDefines(VARIANT_BENCH_FRAGMENT, defines));
+            Shader shader(program);
+            shader.use();
+            shader.setInt("texture_diffuse1", DIFFUSE_TEXTURE_UNIT);
+            shader.setInt("texture_normal1", NORMAL_TEXTURE_UNIT);
+            return program;
+        };
+        GLuint dynamicProgram = build("#define DYNAMIC\n");
+
+        // 每种特性组合绘制 frames 帧，返回平均每帧毫秒数
+        auto measure = [&](GLuint program, uint32_t features)
+        {
+            Shader shader(program);
+            shader.use();
+            shader.setBool("hasTexture", (features & ShaderFeature::Texture) != 0);
+            shader.setBool("hasNormalMap", (features & ShaderFeature::NormalMap) != 0);
+            auto frame = [&]()
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                for (int layer = 0; layer < layers; layer++)
+                {
+                    shader.setFloat("depth", layer / float(layers));
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                }
+                glFinish();
+            };
+            frame(); // 预热，驱动可能在第一次绘制时才完成编译
+            double start = nowMs();
+            for (int i = 0; i < frames; i++)
+                frame();
+            return (nowMs() - start) / frames;
+        };
+
+        const uint32_t cases[] = {0, ShaderFeature::Texture, ShaderFeature::Texture | ShaderFeature::NormalMap};
+        double megapixels = double(width) * height * layers / 1e6;
+        for (uint32_t features : cases)
+        {
+            GLuint staticProgram = build(featureDefines(features));
+            double staticMs = measure(staticProgram, features);
+            double dynamicMs = measure(dynamicProgram, features);
+            std::printf("%-20s permutation %7.2f ms (%6.2f ns/px)  uniform branch %7.2f ms (%6.2f ns/px)  %+5.1f%%\n",
+                        featureName(features).c_str(), staticMs, staticMs / megapixels, dynamicMs, dynamicMs / megapixels,
+                        (dynamicMs / staticMs - 1.0) * 100.0);
+            glDeleteProgram(staticProgram);
+        }
+
+        glDeleteProgram(dynamicProgram);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteTextures(2, textures);
+        target.destroy();
+    }
+
+    const char *SHADOW_BENCH_VERTEX = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 viewProjection;
+uniform mat4 model;
+void main()
+{
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+}
+)";
+
+    const char *SHADOW_BENCH_FRAGMENT = R"(#version 330 core
+void main()
+{
+}
+)";
+
+    // 一个大场景：side x side 个立方体铺在地面上，相机贴近地面斜看远处
+    // 每个级联分别计时：全部物体都画 vs 只画包围球与该级联相交的投射体
+    void benchShadows(const std::vector<std::string> &args)
+    {
+        int side = args.size() > 0 ? std::atoi(args[0].c_str()) : 64;
+        int cascades = args.size() > 1 ? std::atoi(args[1].c_str()) : ShadowCascades::MAX_CASCADES;
+        int resolution = args.size() > 2 ? std::atoi(args[2].c_str()) : 2048;
+        int frames = args.size() > 3 ? std::atoi(args[3].c_str()) : 10;
+        cascades = std::max(1, std::min(cascades, ShadowCascades::MAX_CASCADES));
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << side * side << " casters, " << cascades
+                  << " cascades at " << resolution << "x" << resolution << std::endl;
+
+        ShadowMap shadowMap;
+        if (!shadowMap.create(resolution, cascades))
+            return;
+        GLuint program = ProgramCache::build(SHADOW_BENCH_VERTEX, SHADOW_BENCH_FRAGMENT);
+        Shader shader(program);
+        shader.use();
+
+        // 单位立方体，12 个三角形
+        const float cube[] = {-0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f,
+                              -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f};
+        const unsigned int indices[] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                        3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+        GLuint vao, vbo, ebo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+
+        const float SPACING = 3.0f;
+        std::vector<glm::mat4> models;
+        std::vector<glm::vec3> centers;
+        std::mt19937 random(11);
+        for (int z = 0; z < side; z++)
+            for (int x = 0; x < side; x++)
+            {
+                float height = 1.0f + random() % 4;
+                glm::vec3 center((x - side * 0.5f) * SPACING, height * 0.5f, (z - side * 0.5f) * SPACING);
+                models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(1.0f, height, 1.0f)));
+                centers.push_back(center);
+            }
+        // 包围球半径取最高的立方体
+        const float CASTER_RADIUS = glm::length(glm::vec3(0.5f, 2.0f, 0.5f));
+
+        glm::vec3 eye(0.0f, 6.0f, side * SPACING * 0.5f);
+        glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(0.0f, -0.3f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        ShadowCascades shadows = ShadowCascades::compute(view, projection, glm::vec3(-0.4f, -1.0f, -0.3f), cascades, 150.0f, resolution);
+
+        double cullStart = nowMs();
+        std::vector<uint32_t> masks(centers.size());
+        for (int i = 0; i < frames; i++)
+            for (size_t j = 0; j < centers.size(); j++)
+                masks[j] = shadows.casterMask(centers[j], CASTER_RADIUS);
+        double cullMs = (nowMs() - cullStart) / frames;
+
+        // 返回第 cascade 层平均每帧毫秒数，culled 为 false 时画全部物体
+        auto measure = [&](int cascade, bool culled, int &drawn)
+        {
+            auto pass = [&]()
+            {
+                drawn = 0;
+                shadowMap.bindCascade(cascade);
+                shader.setMat4("viewProjection", shadows.viewProjection(cascade));
+                for (size_t j = 0; j < models.size(); j++)
+                {
+                    if (culled && !(masks[j] & (1u << cascade)))
+                        continue;
+                    shader.setMat4("model", models[j]);
+                    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+                    drawn++;
+                }
+                glFinish();
+            };
+            pass(); // 预热
+            double start = nowMs();
+            for (int i = 0; i < frames; i++)
+                pass();
+            return (nowMs() - start) / frames;
+        };
+
+        shadowMap.beginPass();
+        double totalAll = 0.0, totalCulled = 0.0;
+        for (int c = 0; c < cascades; c++)
+        {
+            int drawnAll, drawnCulled;
+            double allMs = measure(c, false, drawnAll);
+            double culledMs = measure(c, true, drawnCulled);
+            totalAll += allMs;
+            totalCulled += culledMs;
+            std::printf("cascade %d  split %6.1f  extent %6.1f  all %6d draws %7.2f ms  culled %6d draws %7.2f ms  %5.1fx\n", c,
+                        shadows.splits[c], shadows.extent[c], drawnAll, allMs, drawnCulled, culledMs, allMs / culledMs);
+        }
+        shadowMap.endPass();
+        std::printf("total       all %7.2f ms  culled %7.2f ms (+ %.3f ms CPU caster culling)\n", totalAll, totalCulled, cullMs);
+
+        glDeleteProgram(program);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    const char *LIGHTS_BENCH_VERTEX = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 view;
+uniform mat4 projection;
+out vec3 FragPos;
+void main()
+{
+    FragPos = aPos;
+    gl_Position = projection * view * vec4(aPos, 1.0);
+}
+)";
+
+    // 与 shaders/clustered_lights.glsl 相同的光照计算；未定义 CLUSTERED 时遍历全部光源
+    const char *LIGHTS_BENCH_FRAGMENT = R"(#version 330 core
+out vec4 FragColor;
+in vec3 FragPos;
+uniform mat4 view;
+uniform vec3 viewPos;
+uniform int lightCount;
+uniform vec4 clusterGrid;
+uniform vec4 clusterSlices;
+uniform vec4 clusterScreen;
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterCells;
+uniform usamplerBuffer lightIndices;
+
+vec3 shade(int light, vec3 norm, vec3 viewDir)
+{
+    vec4 positionRadius = texelFetch(lightData, light * 2);
+    vec3 color = texelFetch(lightData, light * 2 + 1).rgb;
+    vec3 toLight = positionRadius.xyz - FragPos;
+    float distance = length(toLight);
+    vec3 lightDir = toLight / max(distance, 1e-4);
+    float ratio = distance / positionRadius.w;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    float attenuation = window * window / (1.0 + distance * distance);
+    float diff = max(dot(norm, lightDir), 0.0);
+    float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32);
+    return (diff + 0.5 * spec) * attenuation * color;
+}
+
+void main()
+{
+    vec3 norm = vec3(0.0, 1.0, 0.0);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 result = vec3(0.1);
+#ifdef CLUSTERED
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int slice = clamp(int(log(depth) * clusterSlices.x + clusterSlices.y), 0, int(clusterGrid.z) - 1);
+    ivec2 tile = min(ivec2(gl_FragCoord.xy * clusterScreen.xy), ivec2(clusterGrid.xy) - 1);
+    uvec2 cell = texelFetch(clusterCells, (slice * int(clusterGrid.y) + tile.y) * int(clusterGrid.x) + tile.x).xy;
+    for (uint i = 0u; i < cell.y; i++)
+        result += shade(int(texelFetch(lightIndices, int(cell.x + i)).r), norm, viewDir);
+#else
+    for (int i = 0; i < lightCount; i++)
+        result += shade(i, norm, viewDir);
+#endif
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+    // 大平面上的随机点光源，相机斜看平面
+    // CPU：分簇的标量/SSE 耗时；GPU：分簇着色 vs 每个片段遍历全部光源
+    void benchLights(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 5;
+        int width = 640, height = 360;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+        std::vector<int> counts = {1, 64, 256, 1024};
+        if (args.size() > 2)
+            counts = {std::atoi(args[2].c_str())};
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << ", grid "
+                  << LightClusters::TILES_X << "x" << LightClusters::TILES_Y << "x" << LightClusters::SLICES << std::endl;
+
+        Framebuffer target;
+        if (!target.create(width, height))
+            return;
+        target.bind();
+        glEnable(GL_DEPTH_TEST);
+
+        const float GROUND = 60.0f;
+        const float quad[] = {-GROUND, 0.0f, -GROUND, GROUND, 0.0f, -GROUND, -GROUND, 0.0f, GROUND, GROUND, 0.0f, GROUND};
+        GLuint vao, vbo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+
+        glm::vec3 eye(0.0f, 10.0f, 45.0f);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), float(width) / height, 0.1f, 100.0f);
+
+        auto build = [&](const std::string &defines)
+        {
+            GLuint program = ProgramCache::build(LIGHTS_BENCH_VERTEX, Shader::injectDefines(LIGHTS_BENCH_FRAGMENT, defines));
+            Shader shader(program);
+            shader.use();
+            shader.setMat4("view", view);
+            shader.setMat4("projection", projection);
+            shader.setVec3("viewPos", eye.x, eye.y, eye.z);
+            shader.setInt("lightData", LIGHT_TEXTURE_UNIT);
+            shader.setInt("clusterCells", CLUSTER_TEXTURE_UNIT);
+            shader.setInt("lightIndices", LIGHT_INDEX_TEXTURE_UNIT);
+            return program;
+        };
+        GLuint clusteredProgram = build("#define CLUSTERED\n");
+        GLuint bruteProgram = build("");
+
+        LightBuffers buffers;
+        buffers.create();
+        LightClusters clusters;
+        for (int count : counts)
+        {
+            std::mt19937 random(5);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            std::vector<LightPacket> lights(count);
+            for (LightPacket &light : lights)
+            {
+                light.positionRadius = glm::vec4(unit(random) * 2.0f * GROUND - GROUND, 1.0f + unit(random) * 2.0f,
+                                                 unit(random) * 2.0f * GROUND - GROUND, 6.0f + unit(random) * 6.0f);
+                light.color = glm::vec4(unit(random), unit(random), unit(random), 1.0f) * 6.0f;
+            }
+
+            // CPU 分配：标量与 SSE 各跑若干轮
+            const int ROUNDS = 200;
+            double cpuMs[2];
+            for (int simd = 0; simd < 2; simd++)
+            {
+                clusters.assign(view, projection, lights, simd != 0);
+                double start = nowMs();
+                for (int i = 0; i < ROUNDS; i++)
+                    clusters.assign(view, projection, lights, simd != 0);
+                cpuMs[simd] = (nowMs() - start) / ROUNDS;
+            }
+            double uploadStart = nowMs();
+            buffers.upload(lights, clusters);
+            glFinish();
+            double uploadMs = nowMs() - uploadStart;
+            buffers.bind();
+
+            auto measure = [&](GLuint program)
+            {
+                Shader shader(program);
+                shader.use();
+                shader.setInt("lightCount", count);
+                glUniform4f(glGetUniformLocation(program, "clusterGrid"), LightClusters::TILES_X, LightClusters::TILES_Y, LightClusters::SLICES, count);
+                glUniform4f(glGetUniformLocation(program, "clusterSlices"), clusters.sliceScale(), clusters.sliceBias(), 0.0f, 0.0f);
+                glUniform4f(glGetUniformLocation(program, "clusterScreen"), float(LightClusters::TILES_X) / width,
+                            float(LightClusters::TILES_Y) / height, 0.0f, 0.0f);
+                auto frame = [&]()
+                {
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                    glFinish();
+                };
+                frame(); // 预热
+                double start = nowMs();
+                for (int i = 0; i < frames; i++)
+                    frame();
+                return (nowMs() - start) / frames;
+            };
+            // 两种方式的画面应当一致（簇外的光源贡献为 0），记录最大的通道差
+            std::vector<unsigned char> clusteredPixels(size_t(width) * height * 4), brutePixels(clusteredPixels.size());
+            double clusteredMs = measure(clusteredProgram);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, clusteredPixels.data());
+            double bruteMs = measure(bruteProgram);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, brutePixels.data());
+            int maxDifference = 0;
+            for (size_t i = 0; i < clusteredPixels.size(); i++)
+                maxDifference = std::max(maxDifference, std::abs(int(clusteredPixels[i]) - int(brutePixels[i])));
+
+            const LightClusters::Stats &stats = clusters.stats();
+            std::printf("%5d lights  assign scalar %6.3f ms  sse %6.3f ms  upload %5.2f ms (%6.1f KB)  %5zu refs, max %3u/cluster\n",
+                        count, cpuMs[0], cpuMs[1], uploadMs, buffers.uploadedBytes() / 1024.0, stats.references, stats.maxPerCluster);
+            std::printf("             shading clustered %8.2f ms  all lights %8.2f ms  %6.1fx  max difference %d/255\n", clusteredMs, bruteMs,
+                        bruteMs / clusteredMs, maxDifference);
+        }
+
+        glDeleteProgram(clusteredProgram);
+        glDeleteProgram(bruteProgram);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        target.destroy();
+    }
+
+    // 重叠平面场景（deferred、prepass 基准共用）：layers 层全屏平面从远到近绘制（最坏的重叠顺序），外加随机点光源
+    // 使用 shaders/ 下的实际着色器和 uniform block，点光源按簇分配
+    struct LayerScene
+    {
+        int width = 0, height = 0;
+        std::vector<ObjectUniforms> objects;
+        glm::mat4 view = glm::mat4(1.0f), projection = glm::mat4(1.0f);
+        GLuint vao = 0, vbo = 0, fullscreenVAO = 0, query = 0;
+        GLuint ubos[3] = {0, 0, 0};
+        LightBuffers buffers;
+        LightClusters clusters;
+
+        void create(int sceneWidth, int sceneHeight, int layers)
+        {
+            width = sceneWidth;
+            height = sceneHeight;
+            // 朝向 +z 的单位平面：位置和法线
+            const float quad[] = {-1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+                                  -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+            glGenVertexArrays(1, &vao);
+            glGenVertexArrays(1, &fullscreenVAO);
+            glGenBuffers(1, &vbo);
+            glBindVertexArray(vao);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float)));
+
+            // 相机在原点看向 -z，第 k 层在距离 4 + 2k 处，放大到覆盖整个视野
+            float aspect = float(width) / height;
+            projection = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+            objects.resize(layers);
+            for (int k = 0; k < layers; k++)
+            {
+                float distance = 4.0f + 2.0f * (layers - 1 - k);
+                objects[k].model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance)),
+                                              glm::vec3(distance * aspect, distance, 1.0f));
+                objects[k].color = glm::vec4(0.6f + 0.1f * (k % 4), 0.7f, 0.8f - 0.1f * (k % 3), 1.0f);
+                objects[k].material.x = 0.3f + 0.4f * (k % 2);
+            }
+            FrameUniforms frameUniforms;
+            frameUniforms.view = view;
+            frameUniforms.projection = projection;
+            frameUniforms.lightPos = glm::vec4(2.0f, 3.0f, 2.0f, 1.0f);
+            frameUniforms.viewPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            frameUniforms.lightColor = glm::vec4(1.0f);
+            frameUniforms.inverseViewProjection = glm::inverse(projection * view);
+
+            glGenBuffers(3, ubos);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[0]);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frameUniforms, GL_STATIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ubos[0]);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[1]);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(ObjectUniforms), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, OBJECT_BLOCK_BINDING, ubos[1]);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[2]);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(ClusterUniforms), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, CLUSTER_BLOCK_BINDING, ubos[2]);
+            glGenQueries(1, &query);
+            buffers.create();
+        }
+
+        void destroy()
+        {
+            buffers.destroy();
+            glDeleteQueries(1, &query);
+            glDeleteBuffers(3, ubos);
+            glDeleteBuffers(1, &vbo);
+            glDeleteVertexArrays(1, &vao);
+            glDeleteVertexArrays(1, &fullscreenVAO);
+        }
+
+        // 程序按主程序的方式绑定 uniform block 和纹理单元
+        static GLuint build(const char *vertexPath, const char *fragmentPath, uint32_t features)
+        {
+            Shader shader(vertexPath, fragmentPath, featureDefines(features));
+            shader.bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+            shader.bindUniformBlock("Object", OBJECT_BLOCK_BINDING);
+            shader.bindUniformBlock("Clusters", CLUSTER_BLOCK_BINDING);
+            shader.use();
+            shader.setInt("lightData", LIGHT_TEXTURE_UNIT);
+            shader.setInt("clusterCells", CLUSTER_TEXTURE_UNIT);
+            shader.setInt("lightIndices", LIGHT_INDEX_TEXTURE_UNIT);
+            shader.setInt("gAlbedoRoughness", GBUFFER_TEXTURE_UNIT);
+            shader.setInt("gNormal", GBUFFER_TEXTURE_UNIT + 1);
+            shader.setInt("gDepth", GBUFFER_TEXTURE_UNIT + 2);
+            return shader.ID;
+        }
+
+        // 在层与层之间随机放置 count 个点光源并上传簇表
+        void setLights(int count)
+        {
+            std::mt19937 random(9);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            float aspect = float(width) / height;
+            float depth = 4.0f + 2.0f * objects.size();
+            std::vector<LightPacket> lights(count);
+            for (LightPacket &light : lights)
+            {
+                float z = -1.0f - unit(random) * depth;
+                light.positionRadius = glm::vec4((unit(random) * 2.0f - 1.0f) * -z * aspect * 0.5f, (unit(random) * 2.0f - 1.0f) * -z * 0.5f, z,
+                                                 1.5f + unit(random) * 2.5f);
+                light.color = glm::vec4(unit(random), unit(random), unit(random), 1.0f) * 4.0f;
+            }
+            clusters.assign(view, projection, lights);
+            buffers.upload(lights, clusters);
+            buffers.bind();
+            ClusterUniforms clusterUniforms;
+            clusterUniforms.grid = glm::vec4(LightClusters::TILES_X, LightClusters::TILES_Y, LightClusters::SLICES, count);
+            clusterUniforms.slices = glm::vec4(clusters.sliceScale(), clusters.sliceBias(), 0.0f, 0.0f);
+            clusterUniforms.screen = glm::vec4(float(LightClusters::TILES_X) / width, float(LightClusters::TILES_Y) / height, 0.0f, 0.0f);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[2]);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(clusterUniforms), &clusterUniforms);
+        }
+
+        void drawLayers(GLuint program)
+        {
+            glUseProgram(program);
+            glBindVertexArray(vao);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[1]);
+            for (const ObjectUniforms &object : objects)
+            {
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(object), &object);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+
+        void drawFullscreen(GLuint program)
+        {
+            glUseProgram(program);
+            glBindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+
+        // draw 期间通过深度测试的片段数（等待结果）
+        GLuint countSamples(const std::function<void()> &draw)
+        {
+            GLuint samples = 0;
+            glBeginQuery(GL_SAMPLES_PASSED, query);
+            draw();
+            glEndQuery(GL_SAMPLES_PASSED);
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samples);
+            return samples;
+        }
+
+        std::vector<unsigned char> readPixels() const
+        {
+            std::vector<unsigned char> pixels(size_t(width) * height * 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            return pixels;
+        }
+    };
+
+    // 返回平均每帧毫秒数（先预热一帧）
+    double measureFrames(int frames, const std::function<void()> &frame)
+    {
+        frame();
+        double start = nowMs();
+        for (int i = 0; i < frames; i++)
+            frame();
+        return (nowMs() - start) / frames;
+    }
+
+    int maxDifference(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b)
+    {
+        int result = 0;
+        for (size_t i = 0; i < a.size() && i < b.size(); i++)
+            result = std::max(result, std::abs(int(a[i]) - int(b[i])));
+        return result;
+    }
+
+    // 前向与延迟着色的对比，GL_SAMPLES_PASSED 统计每个通道实际着色的片段数
+    void benchDeferred(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 5;
+        int width = 640, height = 360;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+        int layers = args.size() > 2 ? std::atoi(args[2].c_str()) : 4;
+        std::vector<int> counts = {16, 256, 1024};
+        if (args.size() > 3)
+            counts = {std::atoi(args[3].c_str())};
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << ", " << layers
+                  << " layers, G-buffer " << GBuffer::BYTES_PER_PIXEL << " B/px" << std::endl;
+
+        Framebuffer target;
+        GBuffer gbuffer;
+        if (!target.create(width, height) || !gbuffer.create(width, height))
+            return;
+        target.bind();
+        glEnable(GL_DEPTH_TEST);
+
+        LayerScene scene;
+        scene.create(width, height, layers);
+        GLuint forwardProgram = LayerScene::build("shaders/vertex.glsl", "shaders/fragment.glsl", ShaderFeature::Lights);
+        GLuint geometryProgram = LayerScene::build("shaders/vertex.glsl", "shaders/gbuffer_fragment.glsl", 0);
+        GLuint lightingProgram = LayerScene::build("shaders/deferred_vertex.glsl", "shaders/deferred_fragment.glsl", ShaderFeature::Lights);
+
+        for (int count : counts)
+        {
+            scene.setLights(count);
+            GLuint forwardSamples = 0, geometrySamples = 0, lightingSamples = 0;
+            double forwardMs = measureFrames(frames, [&]()
+                                             {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                forwardSamples = scene.countSamples([&]() { scene.drawLayers(forwardProgram); });
+                glFinish(); });
+            std::vector<unsigned char> forwardPixels = scene.readPixels();
+            double deferredMs = measureFrames(frames, [&]()
+                                              {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                gbuffer.beginGeometry();
+                geometrySamples = scene.countSamples([&]() { scene.drawLayers(geometryProgram); });
+                gbuffer.endGeometry();
+                gbuffer.bindTextures();
+                glDepthFunc(GL_ALWAYS);
+                lightingSamples = scene.countSamples([&]() { scene.drawFullscreen(lightingProgram); });
+                glDepthFunc(GL_LESS);
+                glFinish(); });
+
+            // G-buffer 带宽估计：几何通道每个通过深度测试的片段写一次，光照通道每像素读一次
+            double gbufferMB = (double(geometrySamples) + lightingSamples) * GBuffer::BYTES_PER_PIXEL / (1024.0 * 1024.0);
+            std::printf("%5d lights  forward %8.2f ms (%8u shaded)  deferred %8.2f ms (%8u shaded, G-buffer ~%.1f MB/frame)  %5.2fx  max difference %d/255\n",
+                        count, forwardMs, forwardSamples, deferredMs, lightingSamples, gbufferMB, forwardMs / deferredMs,
+                        maxDifference(forwardPixels, scene.readPixels()));
+        }
+
+        glDeleteProgram(forwardProgram);
+        glDeleteProgram(geometryProgram);
+        glDeleteProgram(lightingProgram);
+        scene.destroy();
+        gbuffer.destroy();
+        target.destroy();
+    }
+
+    // 深度预通道：只写深度的位置流通道 + GL_EQUAL 颜色通道，对比直接着色
+    // 画面应完全一致（位置计算是 invariant 的），片段数显示预通道消除了多少重复着色
+    void benchPrepass(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 5;
+        int width = 640, height = 360;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+        int lightCount = args.size() > 2 ? std::atoi(args[2].c_str()) : 256;
+        std::vector<int> layerCounts = {1, 2, 4, 8};
+        if (args.size() > 3)
+            layerCounts = {std::atoi(args[3].c_str())};
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << ", " << lightCount
+                  << " lights" << std::endl;
+
+        Framebuffer target;
+        if (!target.create(width, height))
+            return;
+        target.bind();
+        glEnable(GL_DEPTH_TEST);
+
+        GLuint colorProgram = LayerScene::build("shaders/vertex.glsl", "shaders/fragment.glsl", ShaderFeature::Lights);
+        GLuint depthProgram = LayerScene::build("shaders/shadow_vertex.glsl", "shaders/shadow_fragment.glsl", 0);
+        for (int layers : layerCounts)
+        {
+            LayerScene scene;
+            scene.create(width, height, layers);
+            scene.setLights(lightCount);
+            GLuint directSamples = 0, depthSamples = 0, colorSamples = 0;
+            double depthMs = 0.0;
+            double directMs = measureFrames(frames, [&]()
+                                            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                directSamples = scene.countSamples([&]() { scene.drawLayers(colorProgram); });
+                glFinish(); });
+            std::vector<unsigned char> directPixels = scene.readPixels();
+            double prepassMs = measureFrames(frames, [&]()
+                                             {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                double start = nowMs();
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                depthSamples = scene.countSamples([&]() { scene.drawLayers(depthProgram); });
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                glFinish();
+                depthMs = nowMs() - start;
+                glDepthFunc(GL_EQUAL);
+                glDepthMask(GL_FALSE);
+                colorSamples = scene.countSamples([&]() { scene.drawLayers(colorProgram); });
+                glDepthFunc(GL_LESS);
+                glDepthMask(GL_TRUE);
+                glFinish(); });
+
+            std::printf("%2d layers  overdraw %5.2fx  direct %8.2f ms (%8u shaded)  pre-pass %8.2f ms (depth %6.2f ms, %8u shaded)  %5.2fx  max difference %d/255\n",
+                        layers, double(depthSamples) / std::max(colorSamples, 1u), directMs, directSamples, prepassMs, depthMs, colorSamples,
+                        directMs / prepassMs, maxDifference(directPixels, scene.readPixels()));
+            scene.destroy();
+        }
+
+        glDeleteProgram(colorProgram);
+        glDeleteProgram(depthProgram);
+        target.destroy();
+    }
+
+    // 环境光遮蔽：地面上一排排立方体，相机斜看；使用 shaders/ 下的实际 SSAO 着色器
+    // 耗时：不同分辨率和采样数下深度通道与遮蔽通道的 GPU 时间（glFinish 计时）
+    // 质量：与 32 采样、累积 64 帧的参考结果比较均方根误差，对比单帧和时间累积
+    void benchSSAO(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 10;
+        int width = 1280, height = 720;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << std::endl;
+        glEnable(GL_DEPTH_TEST);
+
+        auto build = [](const char *vertexPath, const char *fragmentPath)
+        {
+            Shader shader(vertexPath, fragmentPath);
+            shader.bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+            shader.bindUniformBlock("Object", OBJECT_BLOCK_BINDING);
+            shader.bindUniformBlock("Occlusion", OCCLUSION_BLOCK_BINDING);
+            shader.use();
+            shader.setInt("occlusionDepth", OCCLUSION_DEPTH_TEXTURE_UNIT);
+            shader.setInt("occlusionHistory", OCCLUSION_HISTORY_TEXTURE_UNIT);
+            return shader.ID;
+        };
+        GLuint depthProgram = build("shaders/shadow_vertex.glsl", "shaders/shadow_fragment.glsl");
+        GLuint occlusionProgram = build("shaders/deferred_vertex.glsl", "shaders/ssao_fragment.glsl");
+
+        const float cube[] = {-0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f,
+                              -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f};
+        const unsigned int indices[] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                        3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+        GLuint vao, vbo, ebo, fullscreenVAO;
+        glGenVertexArrays(1, &vao);
+        glGenVertexArrays(1, &fullscreenVAO);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+
+        // 地面（压扁的立方体）和 8x8 个高低不一的立方体
+        std::vector<glm::mat4> models = {glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.05f, 0.0f)), glm::vec3(40.0f, 0.1f, 40.0f))};
+        std::mt19937 random(3);
+        for (int z = 0; z < 8; z++)
+            for (int x = 0; x < 8; x++)
+            {
+                float size = 0.5f + (random() % 4) * 0.25f;
+                models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3((x - 3.5f) * 1.6f, size * 0.5f, (z - 3.5f) * 1.6f)),
+                                            glm::vec3(size)));
+            }
+        glm::vec3 eye(0.0f, 5.0f, 12.0f);
+        FrameUniforms frameUniforms;
+        frameUniforms.view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frameUniforms.projection = glm::perspective(glm::radians(45.0f), float(width) / height, 0.1f, 100.0f);
+        frameUniforms.viewPos = glm::vec4(eye, 1.0f);
+        frameUniforms.inverseViewProjection = glm::inverse(frameUniforms.projection * frameUniforms.view);
+        GLuint ubos[3];
+        glGenBuffers(3, ubos);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubos[0]);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(frameUniforms), &frameUniforms, GL_STATIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ubos[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubos[1]);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(ObjectUniforms), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, OBJECT_BLOCK_BINDING, ubos[1]);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubos[2]);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(OcclusionUniforms), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, OCCLUSION_BLOCK_BINDING, ubos[2]);
+
+        SSAO ssao;
+        unsigned int frameIndex = 0;
+        // 一帧 SSAO，返回深度通道和遮蔽通道的毫秒数
+        auto run = [&](int samples, bool temporal, double &depthMs, double &occlusionMs)
+        {
+            double start = nowMs();
+            ssao.beginDepth();
+            glUseProgram(depthProgram);
+            glBindVertexArray(vao);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[1]);
+            for (const glm::mat4 &model : models)
+            {
+                ObjectUniforms object;
+                object.model = model;
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(object), &object);
+                glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+            }
+            ssao.endDepth();
+            glFinish();
+            double middle = nowMs();
+            OcclusionUniforms occlusionUniforms;
+            occlusionUniforms.previousViewProjection = frameUniforms.projection * frameUniforms.view;
+            occlusionUniforms.params = glm::vec4(0.5f, samples, float(frameIndex++ % 64), temporal && ssao.hasHistory() ? 0.1f : 1.0f);
+            occlusionUniforms.target = glm::vec4(ssao.width(), ssao.height(), float(ssao.width()) / width, float(ssao.height()) / height);
+            glBindBuffer(GL_UNIFORM_BUFFER, ubos[2]);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(occlusionUniforms), &occlusionUniforms);
+            ssao.beginOcclusion();
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(occlusionProgram);
+            glBindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glEnable(GL_DEPTH_TEST);
+            ssao.endOcclusion();
+            glFinish();
+            depthMs = middle - start;
+            occlusionMs = nowMs() - middle;
+        };
+        // endOcclusion 把结果留在 OCCLUSION_TEXTURE_UNIT 上
+        auto readResult = [&]()
+        {
+            std::vector<float> values(size_t(ssao.width()) * ssao.height() * 2);
+            glActiveTexture(GL_TEXTURE0 + OCCLUSION_TEXTURE_UNIT);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, values.data());
+            glActiveTexture(GL_TEXTURE0);
+            return values;
+        };
+        auto rmsError = [](const std::vector<float> &a, const std::vector<float> &b)
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < a.size(); i += 2)
+                sum += (a[i] - b[i]) * (a[i] - b[i]);
+            return std::sqrt(sum / (a.size() / 2));
+        };
+
+        for (int divisor : {1, 2, 4})
+        {
+            if (!ssao.create(width, height, divisor))
+                return;
+            for (int samples : {4, 8, 16})
+            {
+                double depthMs = 0.0, occlusionMs = 0.0, d, o;
+                run(samples, true, d, o); // 预热
+                for (int i = 0; i < frames; i++)
+                {
+                    run(samples, true, d, o);
+                    depthMs += d;
+                    occlusionMs += o;
+                }
+                std::printf("1/%d resolution %4dx%-4d %2d samples  depth %6.2f ms  occlusion %6.2f ms\n", divisor, ssao.width(), ssao.height(),
+                            samples, depthMs / frames, occlusionMs / frames);
+            }
+        }
+
+        // 质量：半分辨率，静止相机
+        ssao.create(width, height, 2);
+        double d, o;
+        ssao.resetHistory();
+        for (int i = 0; i < 64; i++)
+            run(SSAO::MAX_SAMPLES, true, d, o);
+        std::vector<float> reference = readResult();
+        for (int samples : {4, 8})
+        {
+            ssao.resetHistory();
+            run(samples, false, d, o);
+            double single = rmsError(readResult(), reference);
+            for (int i = 0; i < 30; i++)
+                run(samples, true, d, o);
+            std::printf("half resolution %d samples: rms error vs reference  single frame %.4f  accumulated 30 frames %.4f\n", samples, single,
+                        rmsError(readResult(), reference));
+        }
+
+        glDeleteProgram(depthProgram);
+        glDeleteProgram(occlusionProgram);
+        glDeleteBuffers(3, ubos);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteVertexArrays(1, &fullscreenVAO);
+        ssao.destroy();
+    }
+
+    // HDR 后处理：重叠平面加点光源画进 HDR 目标（光源附近远超 1），使用 shaders/ 下的实际后处理着色器
+    // 耗时：测光（直方图散射 + 归约）、不同层数的泛光、色调映射（glFinish 计时）
+    // 渲染目标池：每帧借还 vs 每帧重新创建（相当于各通道自己分配）的耗时与分配次数
+    // 自动曝光：场景整体变亮/变暗后输出的平均亮度，手动曝光随之变化，自动曝光应回到相近的水平
+    void benchPostProcess(const std::vector<std::string> &args)
+    {
+        int frames = args.size() > 0 ? std::atoi(args[0].c_str()) : 10;
+        int width = 1280, height = 720;
+        if (args.size() > 1)
+            std::sscanf(args[1].c_str(), "%dx%d", &width, &height);
+        int lightCount = args.size() > 2 ? std::atoi(args[2].c_str()) : 256;
+
+        HeadlessContext context;
+        if (!context.create() || !gladLoadGLLoader(HeadlessContext::loader()))
+            return;
+        ProgramCache::setDirectory("");
+        std::cout << reinterpret_cast<const char *>(glGetString(GL_RENDERER)) << ", " << width << "x" << height << ", " << lightCount
+                  << " lights" << std::endl;
+
+        Framebuffer output;
+        if (!output.create(width, height))
+            return;
+        output.bind();
+        glEnable(GL_DEPTH_TEST);
+
+        auto build = [](const char *vertexPath, const char *fragmentPath)
+        {
+            Shader shader(LayerScene::build(vertexPath, fragmentPath, 0));
+            shader.bindUniformBlock("PostProcess", POST_PROCESS_BLOCK_BINDING);
+            shader.use();
+            shader.setInt("postSource", POST_SOURCE_TEXTURE_UNIT);
+            shader.setInt("postBloom", POST_BLOOM_TEXTURE_UNIT);
+            shader.setInt("postExposure", POST_EXPOSURE_TEXTURE_UNIT);
+            return shader.ID;
+        };
+        GLuint sceneProgram = LayerScene::build("shaders/vertex.glsl", "shaders/fragment.glsl", ShaderFeature::Lights);
+        GLuint histogramProgram = build("shaders/luminance_histogram_vertex.glsl", "shaders/luminance_histogram_fragment.glsl");
+        GLuint exposureProgram = build("shaders/deferred_vertex.glsl", "shaders/exposure_fragment.glsl");
+        GLuint prefilterProgram = build("shaders/deferred_vertex.glsl", "shaders/bloom_prefilter_fragment.glsl");
+        GLuint downsampleProgram = build("shaders/deferred_vertex.glsl", "shaders/bloom_downsample_fragment.glsl");
+        GLuint upsampleProgram = build("shaders/deferred_vertex.glsl", "shaders/bloom_upsample_fragment.glsl");
+        GLuint tonemapProgram = build("shaders/deferred_vertex.glsl", "shaders/tonemap_fragment.glsl");
+
+        LayerScene scene;
+        scene.create(width, height, 4);
+        scene.setLights(lightCount);
+        GLuint postUBO;
+        glGenBuffers(1, &postUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, postUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(PostProcessUniforms), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, POST_PROCESS_BLOCK_BINDING, postUBO);
+
+        RenderTargetPool pool;
+        PostProcess post;
+        if (!post.create())
+            return;
+        // 一帧：场景 + 后处理，times 为借场景目标、测光、泛光、色调映射的毫秒数；manualExposure 为 0 时自动曝光
+        auto frame = [&](int levels, float manualExposure, double times[4])
+        {
+            double acquire = nowMs();
+            post.beginScene(pool, width, height);
+            glFinish();
+            times[0] = nowMs() - acquire;
+            glClearColor(0.02f, 0.02f, 0.03f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene.drawLayers(sceneProgram);
+            PostProcessUniforms uniforms;
+            int count = PostProcess::bloomLevelCount(width, height, levels);
+            // 60 帧每秒，适应速度 3
+            uniforms.bloom = glm::vec4(1.0f, 0.5f, 0.6f, 1.0f);
+            uniforms.exposure = glm::vec4(0.0f, post.hasExposure() ? 1.0f - std::exp(-3.0f / 60.0f) : 1.0f, manualExposure, float(count));
+            uniforms.histogram = glm::vec4(-10.0f, 18.0f, 0.5f, 0.95f);
+            glBindBuffer(GL_UNIFORM_BUFFER, postUBO);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(uniforms), &uniforms);
+            glFinish();
+            double start = nowMs();
+            if (manualExposure == 0.0f)
+                post.measureExposure(histogramProgram, exposureProgram);
+            glFinish();
+            double exposed = nowMs();
+            if (count > 0)
+                post.bloom(prefilterProgram, downsampleProgram, upsampleProgram, count);
+            glFinish();
+            double bloomed = nowMs();
+            post.composite(tonemapProgram);
+            glFinish();
+            times[1] = exposed - start;
+            times[2] = bloomed - exposed;
+            times[3] = nowMs() - bloomed;
+            pool.endFrame();
+        };
+        auto run = [&](int levels, float manualExposure, double total[4])
+        {
+            double times[4];
+            frame(levels, manualExposure, times); // 预热
+            total[0] = total[1] = total[2] = total[3] = 0.0;
+            for (int i = 0; i < frames; i++)
+            {
+                frame(levels, manualExposure, times);
+                for (int k = 0; k < 4; k++)
+                    total[k] += times[k] / frames;
+            }
+        };
+
+        for (int levels : {0, 4, 6, 8})
+        {
+            double times[4];
+            run(levels, 0.0f, times);
+            std::printf("bloom %d levels (%d used)  exposure %6.2f ms  bloom %6.2f ms  tone map %6.2f ms  total %6.2f ms\n", levels,
+                        PostProcess::bloomLevelCount(width, height, levels), times[1], times[2], times[3], times[1] + times[2] + times[3]);
+        }
+
+        // 池：每帧借还 vs 每帧重建，只计借场景目标和后处理部分
+        for (bool pooled : {true, false})
+        {
+            RenderTargetPool::Stats before = pool.stats();
+            double postMs = 0.0, times[4];
+            for (int i = 0; i < frames; i++)
+            {
+                if (!pooled)
+                    pool.destroy();
+                frame(6, 0.0f, times);
+                postMs += times[0] + times[1] + times[2] + times[3];
+            }
+            RenderTargetPool::Stats after = pool.stats();
+            std::printf("%-9s  post %6.2f ms/frame  %4.1f targets created/frame", pooled ? "pooled" : "per-frame", postMs / frames,
+                        double(after.created - before.created) / frames);
+            if (pooled)
+                std::printf("  (pool holds %zu targets, %.1f MB)", after.targets, after.bytes / (1024.0 * 1024.0));
+            std::printf("\n");
+        }
+
+        // 曝光：改变方向光强度，比较输出的平均亮度（自动曝光每种亮度跑 120 帧，约 2 秒）
+        auto meanOutput = [&]()
+        {
+            std::vector<unsigned char> pixels = scene.readPixels();
+            double sum = 0.0;
+            for (size_t i = 0; i < pixels.size(); i += 4)
+                sum += 0.2126 * pixels[i] + 0.7152 * pixels[i + 1] + 0.0722 * pixels[i + 2];
+            return sum / (pixels.size() / 4) / 255.0;
+        };
+        for (float scale : {0.25f, 1.0f, 4.0f, 16.0f})
+        {
+            glm::vec4 lightColor(scale, scale, scale, 1.0f);
+            glBindBuffer(GL_UNIFORM_BUFFER, scene.ubos[0]);
+            glBufferSubData(GL_UNIFORM_BUFFER, offsetof(FrameUniforms, lightColor), sizeof(lightColor), &lightColor);
+            double times[4];
+            frame(6, 1.0f, times);
+            double manual = meanOutput();
+            for (int i = 0; i < 120; i++)
+                frame(6, 0.0f, times);
+            std::printf("light x%-5g  mean output (sRGB)  manual exposure %.3f  auto exposure %.3f\n", scale, manual, meanOutput());
+        }
+
+        for (GLuint program : {sceneProgram, histogramProgram, exposureProgram, prefilterProgram, downsampleProgram, upsampleProgram, tonemapProgram})
+            glDeleteProgram(program);
+        glDeleteBuffers(1, &postUBO);
+        post.destroy();
+        pool.destroy();
+        scene.destroy();
+        output.destroy();
+    }
+
+    struct Benchmark
+    {
+        const char *name;
+        const char *description;
+        std::function<void(const std::vector<std::string> &)> run;
+    };
+
+    const std::vector<Benchmark> &benchmarks()
+    {
+        static const std::vector<Benchmark> list = {
+            {"obj", "Assimp vs 并行 OBJ 解析 [路径] [生成面数]", benchObjLoader},
+            {"scenegraph", "场景图脏标记更新 [节点数] [变化比例] [帧数]", benchSceneGraph},
+            {"ecs", "场景组件更新/提交吞吐 [实体数] [帧数]", benchScene},
+            {"pipeline", "模拟/渲染流水线 vs 单线程 [实体数] [帧数] [提交开销]", benchPipeline},
+            {"animation", "关键帧采样：二分 + slerp vs 游标 + SIMD [通道数] [关键帧数] [帧数]", benchAnimation},
+            {"timestep", "固定步长更新：不同帧率下的开销与无窗口加速 [实体数] [秒数] [步频]", benchTimestep},
+            {"compression", "片段压缩：内存、解码开销与误差 [通道数] [秒数] [采样频率]", benchCompression},
+            {"skinning", "CPU 蒙皮：标量 vs AVX2，单线程与任务系统 [角色数] [顶点数] [骨骼数] [帧数]", benchSkinning},
+            {"trace", "跟踪作用域开销：关闭/开启/多线程 [作用域数] [轮数] [线程数] [输出路径]", benchTrace},
+            {"shaders", "程序二进制缓存：冷启动 vs 热启动 [变体数] [缓存目录] [顶点着色器] [片段着色器]", benchShaderCache},
+            {"shadercompile", "异步着色器编译：同步 vs 后台线程 vs parallel_shader_compile [变体数] [顶点着色器] [片段着色器]", benchShaderCompile},
+            {"variants", "着色器排列 vs uniform 分支的片段着色开销 [帧数] [宽x高] [叠加层数]", benchShaderVariants},
+            {"shadows", "级联阴影：每个级联的阴影通道耗时，投射体剔除前后 [每边物体数] [级联数] [分辨率] [帧数]", benchShadows},
+            {"lights", "分簇光照：CPU 分配（标量 vs SSE）与着色耗时（分簇 vs 遍历全部光源）[帧数] [宽x高] [光源数]", benchLights},
+            {"deferred", "前向 vs 延迟着色：重叠平面加点光源的着色耗时、片段数和 G-buffer 带宽 [帧数] [宽x高] [层数] [光源数]", benchDeferred},
+            {"prepass", "深度预通道 + GL_EQUAL vs 直接着色：不同重叠层数下的耗时和着色片段数 [帧数] [宽x高] [光源数] [层数]", benchPrepass},
+            {"ssao", "环境光遮蔽：各分辨率和采样数的通道耗时，单帧与时间累积的误差 [帧数] [宽x高]", benchSSAO},
+            {"post", "HDR 后处理：测光、泛光、色调映射的耗时，渲染目标池 vs 每帧分配，自动曝光的输出亮度 [帧数] [宽x高] [光源数]", benchPostProcess},
+        };
+        return list;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "用法: Benchmark <名称> [参数...]" << std::endl;
+        for (const Benchmark &benchmark : benchmarks())
+            std::cout << "  " << benchmark.name << "\t" << benchmark.description << std::endl;
+        return 0;
+    }
+    std::vector<std::string> args(argv + 2, argv + argc);
+    for (const Benchmark &benchmark : benchmarks())
+    {
+        if (std::strcmp(benchmark.name, argv[1]) == 0)
+        {
+            benchmark.run(args);
+            return 0;
+        }
+    }
+    std::cerr << "未知的基准: " << argv[1] << std::endl;
+    return 1;
+}
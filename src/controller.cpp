@@ -1,22 +1,5 @@
 #include "controller.h"
 
-// 摄像机参数
-glm::vec3 cameraPos(0.0f, 3.0f, 30.0f);
-glm::vec3 cameraFront(0.0f, -0.3f, -1.0f);
-glm::vec3 cameraUp(0.0f, 1.0f, 0.0f);
-
-// 模型变换参数
-glm::vec3 modelPos(0.0f, -10.0f, 0.0f);
-glm::vec3 modelRotation(0.0f, 0.0f, 0.0f);
-float modelScale = 0.6f;
-
-// 添加舞蹈状态变量
-bool isDancing = false;
-
-// 定义插值参数
-float interpolationFactor = 0.0f;
-bool isInterpolating = false;
-
 // 时间相关
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
@@ -26,90 +9,116 @@ void framebufferSizeCallback(GLFWwindow *window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
-void processInput(GLFWwindow *window)
+// 控制用到的按键
+static const int CONTROL_KEYS[] = {
+    GLFW_KEY_R, GLFW_KEY_T, GLFW_KEY_J, GLFW_KEY_K, GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D,
+    GLFW_KEY_Q, GLFW_KEY_E, GLFW_KEY_I, GLFW_KEY_O, GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT,
+    GLFW_KEY_LEFT_SHIFT};
+
+InputState pollInput(GLFWwindow *window)
 {
-    float cameraSpeed = 2.5f * deltaTime;
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    InputState input;
+    for (int key : CONTROL_KEYS)
+        input.keys[key] = glfwGetKey(window, key) == GLFW_PRESS;
+    return input;
+}
+
+void processInput(GLFWwindow *window, Scene &scene, Entity selected)
+{
+    applyInput(pollInput(window), scene, selected);
+}
+
+void applyInput(const InputState &input, Scene &scene, Entity selected)
+{
+    Camera &camera = scene.camera;
+    Transform &model = scene.transforms.get(selected);
     float modelMoveSpeed = 0.1;
     float rotateSpeed = 0.2;
     // 添加模型复位逻辑
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
-    {                                                // 按下 R 键复位模型
-        modelPos = glm::vec3(0.0f, -10.0f, 0.0f);    // 复位模型位置
-        modelRotation = glm::vec3(0.0f, 0.0f, 0.0f); // 复位模型旋转
-        modelScale = 0.6f;                           // 复位模型缩放
+    if (input.pressed(GLFW_KEY_R))
+    {                                                 // 按下 R 键复位模型
+        model.position = DEFAULT_MODEL_POS;           // 复位模型位置
+        model.rotation = glm::vec3(0.0f, 0.0f, 0.0f); // 复位模型旋转
+        model.scale = DEFAULT_MODEL_SCALE;            // 复位模型缩放
     }
     // 添加相机复位逻辑
-    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
-    {                                                // 按下 T 键复位相机
-        cameraPos = glm::vec3(0.0f, 3.0f, 30.0f);    // 复位相机位置
-        cameraFront = glm::vec3(0.0f, -0.3f, -1.0f); // 复位相机朝向
+    if (input.pressed(GLFW_KEY_T))
+    {                                                  // 按下 T 键复位相机
+        camera.position = glm::vec3(0.0f, 3.0f, 30.0f); // 复位相机位置
+        camera.front = glm::vec3(0.0f, -0.3f, -1.0f);   // 复位相机朝向
     }
-    if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)           // 向上移动
-        cameraPos += modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向上移动
-    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)           // 向下移动
-        cameraPos -= modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向下移动
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (input.pressed(GLFW_KEY_J))                 // 向上移动
+        camera.position += modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向上移动
+    if (input.pressed(GLFW_KEY_K))                 // 向下移动
+        camera.position -= modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向下移动
+    if (input.pressed(GLFW_KEY_LEFT_SHIFT))
     {
 
         // 控制相机旋转
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // 向上旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), glm::normalize(glm::cross(cameraUp, cameraFront)))) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // 向下旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), glm::normalize(glm::cross(cameraUp, cameraFront)))) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // 向左旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), cameraUp)) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // 向右旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), cameraUp)) * cameraFront;
+        if (input.pressed(GLFW_KEY_W)) // 向上旋转
+            camera.front = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), glm::normalize(glm::cross(camera.up, camera.front)))) * camera.front;
+        if (input.pressed(GLFW_KEY_S)) // 向下旋转
+            camera.front = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), glm::normalize(glm::cross(camera.up, camera.front)))) * camera.front;
+        if (input.pressed(GLFW_KEY_A)) // 向左旋转
+            camera.front = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), camera.up)) * camera.front;
+        if (input.pressed(GLFW_KEY_D)) // 向右旋转
+            camera.front = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), camera.up)) * camera.front;
         // 控制模型旋转
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) // 向上旋转
-            modelRotation.x += rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) // 向下旋转
-            modelRotation.x -= rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) // 向左旋转
-            modelRotation.y -= rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) // 向右旋转
-            modelRotation.y += rotateSpeed;
+        if (input.pressed(GLFW_KEY_UP)) // 向上旋转
+            model.rotation.x += rotateSpeed;
+        if (input.pressed(GLFW_KEY_DOWN)) // 向下旋转
+            model.rotation.x -= rotateSpeed;
+        if (input.pressed(GLFW_KEY_LEFT)) // 向左旋转
+            model.rotation.y -= rotateSpeed;
+        if (input.pressed(GLFW_KEY_RIGHT)) // 向右旋转
+            model.rotation.y += rotateSpeed;
     }
     else
     {
         // 控制相机移动
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // 向前移动
-            cameraPos += modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // 向后移动
-            cameraPos -= modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // 向左移动
-            cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // 向右移动
-            cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_W)) // 向前移动
+            camera.position += modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
+        if (input.pressed(GLFW_KEY_S)) // 向后移动
+            camera.position -= modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
+        if (input.pressed(GLFW_KEY_A)) // 向左移动
+            camera.position -= glm::normalize(glm::cross(camera.front, camera.up)) * modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_D)) // 向右移动
+            camera.position += glm::normalize(glm::cross(camera.front, camera.up)) * modelMoveSpeed;
 
         // 控制模型平移
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) // 向上平移
-            modelPos.y += modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) // 向下平移
-            modelPos.y -= modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) // 向左平移
-            modelPos.x -= modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) // 向右平移
-            modelPos.x += modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_UP)) // 向上平移
+            model.position.y += modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_DOWN)) // 向下平移
+            model.position.y -= modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_LEFT)) // 向左平移
+            model.position.x -= modelMoveSpeed;
+        if (input.pressed(GLFW_KEY_RIGHT)) // 向右平移
+            model.position.x += modelMoveSpeed;
     }
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) // 放大模型
-        modelScale += 0.01;
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) // 缩小模型
-        modelScale -= 0.01;
+    if (input.pressed(GLFW_KEY_Q)) // 放大模型
+        model.scale += 0.01;
+    if (input.pressed(GLFW_KEY_E)) // 缩小模型
+        model.scale -= 0.01;
+
+    Animation *animation = scene.animations.find(selected);
+    if (!animation)
+        return;
 
-    // 开始插值
-    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
+    // 开始插值（目标沿用上次 Apply 的输入）
+    if (input.pressed(GLFW_KEY_I))
     {
-        isInterpolating = true;
-        interpolationFactor = 0.0f;
+        animation->startPosition = model.position;
+        animation->startRotation = model.rotation;
+        animation->interpolating = true;
+        animation->factor = 0.0f;
     }
 
     // 按下 O 键触发舞蹈
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+    if (input.pressed(GLFW_KEY_O))
     {
-        isDancing = !isDancing; // 切换舞蹈状态
+        animation->dancing = !animation->dancing; // 切换舞蹈状态
     }
 }
 
@@ -2,31 +2,33 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <bitset>
+#include "scene.h"
 
-// 摄像机参数
-extern glm::vec3 cameraPos;
-extern glm::vec3 cameraFront;
-extern glm::vec3 cameraUp;
+// 模型初始变换，R 键复位时使用
+const glm::vec3 DEFAULT_MODEL_POS(0.0f, -10.0f, 0.0f);
+const float DEFAULT_MODEL_SCALE = 0.6f;
 
-// 模型变换参数
-extern glm::vec3 modelPos;
-extern glm::vec3 modelRotation;
-extern float modelScale;
-
-// 添加舞蹈状态变量
-extern bool isDancing;
-
-// 定义插值参数
-extern float interpolationFactor;
-extern bool isInterpolating;
+// 一帧的按键状态，在 GLFW 主线程采集后交给模拟线程
+struct InputState
+{
+    std::bitset<GLFW_KEY_LAST + 1> keys;
+    bool pressed(int key) const { return keys[key]; }
+};
 
 // 回调函数声明
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
-void processInput(GLFWwindow *window);
+// 键盘控制相机和选中的实体
+void processInput(GLFWwindow *window, Scene &scene, Entity selected);
+// 采集按键（ESC 直接关闭窗口），必须在主线程调用
+InputState pollInput(GLFWwindow *window);
+// 把按键状态作用到场景上，可在任意线程调用
+void applyInput(const InputState &input, Scene &scene, Entity selected);
 void mouseCallback(GLFWwindow *window, double xpos, double ypos);
 void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
 
@@ -34,4 +36,4 @@ void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
 extern float deltaTime;
 extern float lastFrame;
 
-#endif // CONTROLLER_H
\ No newline at end of file
+#endif // CONTROLLER_H
@@ -0,0 +1,113 @@
+#include "file_watcher.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+constexpr std::chrono::milliseconds FileWatcher::POLL_INTERVAL;
+
+FileWatcher::~FileWatcher()
+{
+    destroy();
+}
+
+bool FileWatcher::create()
+{
+    destroy();
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        std::cerr << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED, polling modification times" << std::endl;
+#endif
+    lastPoll = std::chrono::steady_clock::now();
+    active = true;
+    return true;
+}
+
+void FileWatcher::destroy()
+{
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+    fd = -1;
+    directories.clear();
+    files.clear();
+    modified.clear();
+    active = false;
+}
+
+void FileWatcher::watch(const std::string &path)
+{
+    if (!active || !files.insert(path).second)
+        return;
+    std::error_code error;
+#ifdef __linux__
+    if (fd >= 0)
+    {
+        // 同一目录重复添加时返回相同的描述符
+        std::string directory = std::filesystem::path(path).parent_path().string();
+        int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0)
+            std::cerr << "ERROR::FILE_WATCHER::WATCH_FAILED " << directory << std::endl;
+        else
+            directories[wd] = directory;
+        return;
+    }
+#endif
+    modified[path] = std::filesystem::last_write_time(path, error);
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::vector<std::string> changed;
+    if (!active)
+        return changed;
+#ifdef __linux__
+    if (fd >= 0)
+    {
+        std::unordered_set<std::string> seen;
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                if (length < 0 && errno != EAGAIN)
+                    std::cerr << "ERROR::FILE_WATCHER::READ_FAILED" << std::endl;
+                break;
+            }
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+                auto directory = directories.find(event->wd);
+                if (directory == directories.end() || event->len == 0)
+                    continue;
+                std::string path = (std::filesystem::path(directory->second) / event->name).string();
+                if (files.count(path) && seen.insert(path).second)
+                    changed.push_back(path);
+            }
+        }
+        return changed;
+    }
+#endif
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < POLL_INTERVAL)
+        return changed;
+    lastPoll = now;
+    for (auto &entry : modified)
+    {
+        std::error_code error;
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(entry.first, error);
+        if (error || time == entry.second)
+            continue;
+        entry.second = time;
+        changed.push_back(entry.first);
+    }
+    return changed;
+}
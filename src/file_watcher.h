@@ -0,0 +1,47 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 文件改动监视，用于着色器热重载
+// Linux 上用 inotify 监视文件所在目录（编辑器常用"写临时文件再改名"的方式保存，直接监视文件会丢失），
+// 只关心 IN_CLOSE_WRITE 和 IN_MOVED_TO，避免读到写了一半的文件；
+// 其他平台每隔 POLL_INTERVAL 比较一次修改时间。
+// poll 不阻塞，每帧在主线程调用。
+class FileWatcher
+{
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{250};
+
+    FileWatcher() {}
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    bool create();
+    void destroy();
+    bool isActive() const { return active; }
+    // 是否为 inotify（否则为轮询修改时间）
+    bool isNative() const { return fd >= 0; }
+
+    // path 应已规范化（见 normalizeShaderPath），重复添加无影响
+    void watch(const std::string &path);
+    // 返回自上次调用以来改动过的被监视文件，每个文件只出现一次
+    std::vector<std::string> poll();
+
+private:
+    bool active = false;
+    int fd = -1;
+    std::unordered_map<int, std::string> directories; // inotify 监视描述符到目录
+    std::unordered_set<std::string> files;
+    // 轮询模式
+    std::unordered_map<std::string, std::filesystem::file_time_type> modified;
+    std::chrono::steady_clock::time_point lastPoll;
+};
+
+#endif
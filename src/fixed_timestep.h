@@ -0,0 +1,64 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+// 固定步长更新的累加器
+// 每帧把真实经过的时间累加进来，再按固定步长 step 逐步消耗：
+//     timestep.accumulate(frameTime);
+//     while (timestep.step())
+//         update(timestep.time(), timestep.delta());
+//     render(interpolate(previous, current, timestep.alpha()));
+// 模拟的开销只取决于模拟时长，与帧率无关；渲染用 alpha 在最近两步之间插值。
+class FixedTimestep
+{
+public:
+    // maxSteps 限制一帧内追赶的步数，超出的时间直接丢弃，避免越慢越追不上
+    explicit FixedTimestep(double step = 1.0 / 60.0, int maxSteps = 8) : dt(step), maxSteps(maxSteps) {}
+
+    void accumulate(double frameTime)
+    {
+        if (frameTime > 0.0)
+            accumulator += frameTime;
+        stepsThisFrame = 0;
+    }
+
+    // 还能再走一步时推进模拟时间并返回 true
+    bool step()
+    {
+        if (accumulator < dt)
+            return false;
+        if (stepsThisFrame == maxSteps)
+        {
+            // 本帧已追赶到上限，把欠下的整步丢掉
+            int skipped = static_cast<int>(accumulator / dt);
+            droppedSteps += skipped;
+            accumulator -= skipped * dt;
+            return false;
+        }
+        accumulator -= dt;
+        current += dt;
+        ++stepsThisFrame;
+        ++totalSteps;
+        return true;
+    }
+
+    double delta() const { return dt; }
+    // 当前这一步结束时的模拟时间
+    double time() const { return current; }
+    // 渲染插值因子：上一步到当前步之间的比例
+    float alpha() const { return static_cast<float>(accumulator / dt); }
+
+    int steps() const { return stepsThisFrame; }
+    unsigned long long total() const { return totalSteps; }
+    unsigned long long dropped() const { return droppedSteps; }
+
+private:
+    double dt;
+    int maxSteps;
+    double accumulator = 0.0;
+    double current = 0.0;
+    int stepsThisFrame = 0;
+    unsigned long long totalSteps = 0;
+    unsigned long long droppedSteps = 0;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "frame_capture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include "image_writer.h"
+#include "trace.h"
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start(int width, int height, const std::string &directory, Format format, bool lossless)
+{
+    stop();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cerr << "ERROR::FRAME_CAPTURE::CANNOT_CREATE_DIRECTORY " << directory << " " << error.message() << std::endl;
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    this->directory = directory;
+    this->format = format;
+    this->lossless = lossless;
+
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    pbos.resize(RING);
+    glGenBuffers(RING, pbos.data());
+    for (GLuint pbo : pbos)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    head = 0;
+    inFlight = 0;
+    frame = 0;
+
+    counters = Stats();
+    stopping = false;
+    started = std::chrono::steady_clock::now();
+    writer = std::thread(&FrameCapture::writerLoop, this);
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (pbos.empty())
+        return;
+    while (collect(true))
+        ;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+
+    for (GLsync &fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    glDeleteBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+    pbos.clear();
+    queue.clear();
+    spare.clear();
+}
+
+void FrameCapture::capture()
+{
+    if (pbos.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.requested;
+    }
+    uint64_t current = frame++;
+
+    // 先取回已经完成的帧，不等待
+    while (collect(false))
+        ;
+    if (inFlight == RING)
+    {
+        // GPU 落后了整整一个环
+        if (!lossless)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++counters.droppedGpu;
+            return;
+        }
+        collect(true);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[head]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[head] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slotFrames[head] = current;
+    head = (head + 1) % RING;
+    ++inFlight;
+}
+
+bool FrameCapture::collect(bool wait)
+{
+    if (inFlight == 0)
+        return false;
+    unsigned int slot = (head + RING - inFlight) % RING;
+    GLenum status = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        if (!wait)
+            return false;
+        while ((status = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000)) == GL_TIMEOUT_EXPIRED)
+            ;
+    }
+    if (status == GL_WAIT_FAILED)
+        std::cerr << "ERROR::FRAME_CAPTURE::FENCE_WAIT_FAILED" << std::endl;
+    glDeleteSync(fences[slot]);
+    fences[slot] = nullptr;
+    --inFlight;
+
+    Image image;
+    image.frame = slotFrames[slot];
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queue.size() >= QUEUE)
+        {
+            if (!lossless)
+            {
+                ++counters.droppedQueue;
+                return true;
+            }
+            changed.wait(lock, [this]()
+                         { return queue.size() < QUEUE; });
+        }
+        if (!spare.empty())
+        {
+            image.pixels.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    image.pixels.resize(bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (mapped)
+    {
+        std::memcpy(image.pixels.data(), mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+        std::cerr << "ERROR::FRAME_CAPTURE::MAP_FAILED" << std::endl;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped)
+        return true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(image));
+    }
+    changed.notify_all();
+    return true;
+}
+
+void FrameCapture::writerLoop()
+{
+    Trace::setThreadName("capture writer");
+    std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+    char name[32];
+    const char *extension = format == Format::PNG ? "png" : "ppm";
+    for (;;)
+    {
+        Image image;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]()
+                         { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            image = std::move(queue.front());
+            queue.pop_front();
+        }
+        changed.notify_all();
+
+        auto begin = std::chrono::steady_clock::now();
+        bool ok;
+        std::string path;
+        {
+            TraceScope scope("Capture write");
+            // GL 的行从下到上，图像文件从上到下；顺便去掉 alpha
+            for (int y = 0; y < height; y++)
+            {
+                const unsigned char *src = image.pixels.data() + static_cast<size_t>(height - 1 - y) * width * 4;
+                unsigned char *dst = rgb.data() + static_cast<size_t>(y) * width * 3;
+                for (int x = 0; x < width; x++)
+                {
+                    dst[x * 3 + 0] = src[x * 4 + 0];
+                    dst[x * 3 + 1] = src[x * 4 + 1];
+                    dst[x * 3 + 2] = src[x * 4 + 2];
+                }
+            }
+            std::snprintf(name, sizeof(name), "/frame_%05llu.%s", (unsigned long long)image.frame, extension);
+            path = directory + name;
+            ok = format == Format::PNG ? writePNG(path, width, height, rgb.data()) : writePPM(path, width, height, rgb.data());
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::error_code error;
+        uintmax_t size = ok ? std::filesystem::file_size(path, error) : 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ok)
+        {
+            ++counters.written;
+            counters.bytes += error ? 0 : size;
+        }
+        counters.writeMs += std::chrono::duration<double, std::milli>(end - begin).count();
+        counters.seconds = std::chrono::duration<double>(end - started).count();
+        spare.push_back(std::move(image.pixels));
+    }
+}
+
+FrameCapture::Stats FrameCapture::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
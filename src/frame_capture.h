@@ -0,0 +1,95 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 异步帧读回与图像序列导出
+// 每帧 glReadPixels 读到环中下一个 PBO（GL_PIXEL_PACK_BUFFER），随后插入围栏，调用立即返回；
+// 之后的帧轮询围栏，已完成的 PBO 才映射并拷贝到队列，渲染线程不会等待 GPU。
+// 写线程从有界队列取图像，翻转行序、去掉 alpha 后写成 PNG 或 PPM。
+// 丢帧模式下 PBO 环或队列满时直接丢弃该帧并计数；无损模式（无窗口批处理）改为等待。
+class FrameCapture
+{
+public:
+    static const unsigned int RING = 3;  // 读回中的 PBO 数
+    static const size_t QUEUE = 8;       // 等待写出的图像数
+
+    enum class Format
+    {
+        PPM,
+        PNG
+    };
+
+    struct Stats
+    {
+        uint64_t requested = 0;    // capture() 调用次数
+        uint64_t written = 0;      // 已写出的文件
+        uint64_t droppedGpu = 0;   // PBO 环全部在读回中
+        uint64_t droppedQueue = 0; // 写线程跟不上
+        uint64_t bytes = 0;        // 写出的文件总大小
+        double seconds = 0.0;      // start 到最近一次写出的时间
+        double writeMs = 0.0;      // 写线程累计编码和写文件时间
+
+        uint64_t dropped() const { return droppedGpu + droppedQueue; }
+        double framesPerSecond() const { return seconds > 0.0 ? written / seconds : 0.0; }
+        double megabytesPerSecond() const { return seconds > 0.0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0; }
+    };
+
+    FrameCapture() {}
+    ~FrameCapture();
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    // 文件写到 directory/frame_00000.png，目录不存在时创建
+    bool start(int width, int height, const std::string &directory, Format format, bool lossless = false);
+    // 取回所有读回中的帧，等写线程写完后返回
+    void stop();
+    bool isActive() const { return !pbos.empty(); }
+
+    // 读回当前读帧缓冲左下角 width x height 的区域
+    void capture();
+
+    Stats stats();
+
+private:
+    struct Image
+    {
+        uint64_t frame = 0;
+        std::vector<unsigned char> pixels; // RGBA，行从下到上
+    };
+
+    int width = 0, height = 0;
+    std::string directory;
+    Format format = Format::PNG;
+    bool lossless = false;
+
+    std::vector<GLuint> pbos;
+    GLsync fences[RING] = {};
+    uint64_t slotFrames[RING] = {};
+    unsigned int head = 0;     // 下一个写入的 PBO
+    unsigned int inFlight = 0; // 读回中的 PBO 数
+    uint64_t frame = 0;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Image> queue;
+    std::vector<std::vector<unsigned char>> spare; // 复用的像素缓冲
+    bool stopping = false;
+    Stats counters;
+    std::chrono::steady_clock::time_point started;
+    std::thread writer;
+
+    // 取回已完成的最早一个 PBO；wait 为 true 时等待围栏
+    bool collect(bool wait);
+    void writerLoop();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "frame_jobs.h"
+
+namespace
+{
+    // 每个任务处理的组件数，太小会被调度开销淹没
+    const size_t ANIMATION_GRAIN = 512;
+    const size_t LIGHT_GRAIN = 1024;
+    const size_t TRANSFORM_GRAIN = 1024;
+    const size_t BOUNDS_GRAIN = 2048;
+    const size_t SUBMIT_GRAIN = 2048;
+}
+
+void FrameJobs::update(Scene &scene, float time, float step, const std::function<void()> &input)
+{
+    JobSystem::Counter stored, handled, animated, moved;
+    jobs.parallelFor(scene.transforms.size(), TRANSFORM_GRAIN, [&scene](size_t begin, size_t end)
+                     { scene.storePrevious(begin, end); },
+                     stored);
+    jobs.runAfter(stored, [&input]()
+                  {
+        if (input)
+            input(); },
+                  &handled);
+    jobs.parallelForAfter(handled, scene.animations.size(), ANIMATION_GRAIN, [&scene, time, step](size_t begin, size_t end)
+                          { scene.updateAnimations(time, step, begin, end); },
+                          animated);
+    jobs.parallelForAfter(handled, scene.lights.size(), LIGHT_GRAIN, [&scene, time](size_t begin, size_t end)
+                          { scene.updateLights(time, begin, end); },
+                          moved);
+    jobs.wait(animated);
+    jobs.wait(moved);
+}
+
+void FrameJobs::build(Scene &scene, float alpha, const glm::mat4 &viewProjection, std::vector<DrawPacket> &packets,
+                      const ShadowCascades *shadows, std::vector<LightPacket> *lights)
+{
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+    size_t numChunks = (scene.meshes.size() + SUBMIT_GRAIN - 1) / SUBMIT_GRAIN;
+    chunkPackets.resize(numChunks);
+
+    JobSystem::Counter transformed, culled, submitted, gathered;
+    jobs.parallelFor(scene.transforms.size(), TRANSFORM_GRAIN, [&scene, alpha](size_t begin, size_t end)
+                     { scene.updateTransforms(alpha, begin, end); },
+                     transformed);
+    jobs.parallelForAfter(transformed, scene.bounds.size(), BOUNDS_GRAIN, [&scene, &frustum, shadows](size_t begin, size_t end)
+                          {
+        scene.updateBounds(begin, end);
+        scene.cull(frustum, begin, end);
+        if (shadows)
+            scene.cullShadowCasters(*shadows, begin, end); },
+                          culled);
+    jobs.parallelForAfter(culled, numChunks, 1, [this, &scene](size_t begin, size_t end)
+                          {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            chunkPackets[chunk].clear();
+            scene.submit(chunkPackets[chunk], chunk * SUBMIT_GRAIN, (chunk + 1) * SUBMIT_GRAIN);
+        } },
+                          submitted);
+    if (lights)
+    {
+        jobs.runAfter(transformed, [&scene, lights]()
+                      {
+            lights->clear();
+            scene.submitLights(*lights); },
+                      &gathered);
+    }
+    jobs.wait(submitted);
+    jobs.wait(gathered);
+
+    packets.clear();
+    for (const std::vector<DrawPacket> &chunk : chunkPackets)
+        packets.insert(packets.end(), chunk.begin(), chunk.end());
+}
+
+void FrameJobs::run(Scene &scene, float time, float deltaTime, const glm::mat4 &viewProjection, std::vector<DrawPacket> &packets)
+{
+    update(scene, time, deltaTime);
+    build(scene, 1.0f, viewProjection, packets);
+}
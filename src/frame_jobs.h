@@ -0,0 +1,32 @@
+#ifndef FRAME_JOBS_H
+#define FRAME_JOBS_H
+
+#include <functional>
+#include <vector>
+#include "job_system.h"
+#include "scene.h"
+
+// 一帧的 CPU 任务图
+// update 对应一个固定步：保存上一步状态 -> 输入 -> 动画（与光源运动并行）；
+// build 每帧一次：插值变换 -> 包围球与剔除 -> 生成绘制包（与收集光源并行）。
+// 每个阶段按组件数组切块并行，阶段之间用计数器串联
+class FrameJobs
+{
+public:
+    explicit FrameJobs(JobSystem &jobs) : jobs(jobs) {}
+
+    // input 在保存状态之后、动画之前串行执行，可以为空
+    void update(Scene &scene, float time, float step, const std::function<void()> &input = nullptr);
+    // shadows 不为空时同时剔除阴影投射体，相机不可见但投射阴影的网格也会生成绘制包；
+    // lights 不为空时写入本帧的点光源
+    void build(Scene &scene, float alpha, const glm::mat4 &viewProjection, std::vector<DrawPacket> &packets,
+               const ShadowCascades *shadows = nullptr, std::vector<LightPacket> *lights = nullptr);
+    // 可变步长的一步加一次 build，不做插值
+    void run(Scene &scene, float time, float deltaTime, const glm::mat4 &viewProjection, std::vector<DrawPacket> &packets);
+
+private:
+    JobSystem &jobs;
+    std::vector<std::vector<DrawPacket>> chunkPackets; // 每块各自生成，最后按顺序拼接
+};
+
+#endif
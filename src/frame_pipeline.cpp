@@ -0,0 +1,99 @@
+#include "frame_pipeline.h"
+
+#include <chrono>
+#include "trace.h"
+
+FramePipeline::FramePipeline(SimulateFn simulate, bool threaded) : simulate(simulate)
+{
+    setThreaded(threaded);
+}
+
+FramePipeline::~FramePipeline()
+{
+    setThreaded(false);
+}
+
+void FramePipeline::post(std::function<void()> command)
+{
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commands.push_back(std::move(command));
+}
+
+void FramePipeline::step(const FrameInput &input, FrameSnapshot &snapshot)
+{
+    TraceScope trace("Simulate");
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pending.swap(commands);
+    }
+    for (std::function<void()> &command : pending)
+        command();
+    snapshot.frame = ++frameCount;
+    simulate(input, snapshot);
+}
+
+const FrameSnapshot &FramePipeline::beginFrame(const FrameInput &input)
+{
+    if (!isThreaded())
+    {
+        step(input, slots[0]);
+        return slots[0];
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto start = std::chrono::steady_clock::now();
+    changed.wait(lock, [this]
+                 { return completed == requested; });
+    waitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // requested 号槽是上一帧的结果，模拟线程接下来写另一个槽
+    const FrameSnapshot &ready = slots[requested % 2];
+    pendingInput = input;
+    ++requested;
+    changed.notify_all();
+    return ready;
+}
+
+void FramePipeline::simulationLoop()
+{
+    Trace::setThreadName("simulation");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this]
+                     { return !running || requested > completed; });
+        if (requested == completed)
+            break; // 已停止且没有未完成的帧
+        FrameInput input = pendingInput;
+        uint64_t target = requested;
+        lock.unlock();
+        step(input, slots[target % 2]);
+        lock.lock();
+        completed = target;
+        changed.notify_all();
+    }
+}
+
+void FramePipeline::setThreaded(bool enabled)
+{
+    if (enabled == isThreaded())
+        return;
+    if (enabled)
+    {
+        // 最近一次单线程模拟的结果在 0 号槽，作为第一帧绘制
+        requested = completed = 0;
+        running = true;
+        thread = std::thread(&FramePipeline::simulationLoop, this);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    changed.notify_all();
+    thread.join();
+    // 把最新结果放回 0 号槽，单线程模式下继续使用
+    if (requested % 2 != 0)
+        std::swap(slots[0], slots[1]);
+}
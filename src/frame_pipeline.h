@@ -0,0 +1,89 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "controller.h"
+#include "scene.h"
+#include "light_clusters.h"
+
+// 渲染线程交给模拟线程的一帧输入
+struct FrameInput
+{
+    InputState input;
+    float time = 0.0f;
+    float deltaTime = 0.0f;
+    float aspect = 1.0f;
+    int shadowCascades = 0; // 0 表示关闭阴影
+};
+
+// 模拟线程产出的一帧快照，渲染线程只读
+struct FrameSnapshot
+{
+    uint64_t frame = 0;
+    float time = 0.0f; // 插值后的模拟时间
+    Camera camera;
+    glm::vec3 lightPos = glm::vec3(0.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    std::vector<DrawPacket> packets;
+    ShadowCascades shadows; // count 为 0 时本帧不画阴影
+    std::vector<LightPacket> lights; // 为空时不开分簇光照
+    LightClusters clusters;
+    float clusterMs = 0.0f; // 光源分簇的 CPU 耗时
+    Transform selected; // 界面显示用
+    int simulationSteps = 0; // 本帧执行的固定步数
+    float alpha = 1.0f;      // 渲染插值因子
+};
+
+// 模拟/渲染两级流水线
+// 模拟线程用第 N 帧输入写一个快照槽，同时渲染线程绘制另一个槽里的第 N-1 帧；
+// 下一次 beginFrame 先等第 N 帧完成再交换，所以模拟最多领先渲染一帧。
+// 关闭多线程时 beginFrame 直接在调用线程模拟并返回当帧快照。
+class FramePipeline
+{
+public:
+    typedef std::function<void(const FrameInput &, FrameSnapshot &)> SimulateFn;
+
+    explicit FramePipeline(SimulateFn simulate, bool threaded = true);
+    ~FramePipeline();
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    // 提交本帧输入，返回可以绘制的快照；引用在下一次 beginFrame 之前有效
+    const FrameSnapshot &beginFrame(const FrameInput &input);
+    // 在模拟线程下一帧开始前执行，用于修改场景（例如界面按钮）
+    void post(std::function<void()> command);
+
+    void setThreaded(bool enabled);
+    bool isThreaded() const { return thread.joinable(); }
+    // 渲染线程在 beginFrame 中等待模拟的累计时间
+    double waitMs() const { return waitNs / 1e6; }
+
+private:
+    SimulateFn simulate;
+    FrameSnapshot slots[2];
+    FrameInput pendingInput;
+    uint64_t requested = 0; // 已提交给模拟线程的帧数
+    uint64_t completed = 0; // 模拟线程已完成的帧数
+    uint64_t frameCount = 0;
+    bool running = false;
+    uint64_t waitNs = 0;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread thread;
+
+    std::mutex commandMutex;
+    std::vector<std::function<void()>> commands;
+
+    void step(const FrameInput &input, FrameSnapshot &snapshot);
+    void simulationLoop();
+};
+
+#endif
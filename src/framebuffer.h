@@ -0,0 +1,34 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <glad/glad.h>
+
+// 离屏帧缓冲：一个颜色纹理加一个深度纹理
+// 两个附件都是纹理而不是渲染缓冲，后续的处理步骤可以直接采样
+class Framebuffer
+{
+public:
+    Framebuffer() {}
+    ~Framebuffer();
+    Framebuffer(const Framebuffer &) = delete;
+    Framebuffer &operator=(const Framebuffer &) = delete;
+
+    // colorFormat 为内部格式（GL_RGBA8、GL_RGBA16F 等）
+    bool create(int width, int height, GLenum colorFormat = GL_RGBA8);
+    void destroy();
+
+    // 绑定为绘制目标并把视口设成整个附件
+    void bind() const;
+
+    GLuint id() const { return fbo; }
+    GLuint colorTexture() const { return color; }
+    GLuint depthTexture() const { return depth; }
+    int width() const { return w; }
+    int height() const { return h; }
+
+private:
+    GLuint fbo = 0, color = 0, depth = 0;
+    int w = 0, h = 0;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "gbuffer.h"
+#include "shader_variants.h"
+
+#include <iostream>
+
+GBuffer::~GBuffer()
+{
+    destroy();
+}
+
+bool GBuffer::create(int width, int height)
+{
+    destroy();
+    w = width;
+    h = height;
+
+    // 光照通道按像素读取，不需要过滤
+    auto attachment = [width, height](GLuint &texture, GLenum internalFormat, GLenum format, GLenum type)
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    };
+    attachment(albedo, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    attachment(normal, GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+    attachment(depth, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 可能在帧中间（视口尺寸变化时）重建，完成后恢复原来的绘制目标
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "ERROR::GBUFFER::INCOMPLETE 0x" << std::hex << status << std::dec << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void GBuffer::destroy()
+{
+    if (fbo)
+        glDeleteFramebuffers(1, &fbo);
+    for (GLuint *texture : {&albedo, &normal, &depth})
+    {
+        if (*texture)
+            glDeleteTextures(1, texture);
+        *texture = 0;
+    }
+    fbo = 0;
+    w = h = 0;
+}
+
+void GBuffer::beginGeometry()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, w, h);
+    // 反照率清零、法线清成 +z，没有几何的像素由深度 1 识别
+    const GLfloat clearAlbedo[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat clearNormal[] = {0.5f, 0.5f, 0.0f, 0.0f};
+    glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+    glClearBufferfv(GL_COLOR, 1, clearNormal);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void GBuffer::endGeometry()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void GBuffer::bindTextures() const
+{
+    const GLuint textures[] = {albedo, normal, depth};
+    for (int i = 0; i < 3; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + GBUFFER_TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
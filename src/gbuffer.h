@@ -0,0 +1,40 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+// 延迟着色的 G-buffer，每像素 12 字节：
+//   0 号附件 RGBA8：反照率 rgb + 粗糙度
+//   1 号附件 RG16：八面体映射编码的法线（见 shaders/octahedral.glsl）
+//   深度 DEPTH_COMPONENT24：光照通道用逆视图投影矩阵重建世界坐标，不单独存位置
+class GBuffer
+{
+public:
+    static const int BYTES_PER_PIXEL = 12;
+
+    GBuffer() {}
+    ~GBuffer();
+    GBuffer(const GBuffer &) = delete;
+    GBuffer &operator=(const GBuffer &) = delete;
+
+    bool create(int width, int height);
+    void destroy();
+
+    // 几何通道：保存当前帧缓冲和视口，绑定 G-buffer 并清空
+    void beginGeometry();
+    // 恢复 beginGeometry 之前的帧缓冲和视口
+    void endGeometry();
+    // 绑定到 GBUFFER_TEXTURE_UNIT 起的三个纹理单元，调用后活动纹理单元恢复为 0
+    void bindTextures() const;
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+private:
+    GLuint fbo = 0, albedo = 0, normal = 0, depth = 0;
+    int w = 0, h = 0;
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4] = {};
+};
+
+#endif
@@ -0,0 +1,618 @@
+#include "gltf_loader.h"
+#include "stb_image.h"
+#include "trace.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <utility>
+
+namespace
+{
+    // 只满足 glTF 需要的最小 JSON 解析器
+    struct JsonValue
+    {
+        enum Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Type type = Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> object;
+
+        const JsonValue &operator[](const char *key) const
+        {
+            for (const auto &member : object)
+                if (member.first == key)
+                    return member.second;
+            return null();
+        }
+
+        const JsonValue &operator[](size_t index) const
+        {
+            return index < array.size() ? array[index] : null();
+        }
+
+        const JsonValue &operator[](int index) const
+        {
+            return index >= 0 ? (*this)[static_cast<size_t>(index)] : null();
+        }
+
+        bool has(const char *key) const { return (*this)[key].type != Null; }
+        size_t size() const { return type == Array ? array.size() : object.size(); }
+        int asInt(int fallback = -1) const { return type == Number ? static_cast<int>(number) : fallback; }
+        size_t asSize(size_t fallback = 0) const { return type == Number ? static_cast<size_t>(number) : fallback; }
+        bool asBool(bool fallback = false) const { return type == Bool ? boolean : fallback; }
+
+        static const JsonValue &null()
+        {
+            static const JsonValue value;
+            return value;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char *begin, const char *end) : p(begin), end(end) {}
+
+        bool parse(JsonValue &value)
+        {
+            return parseValue(value) && (skipSpaces(), p == end || *p == '\0');
+        }
+
+    private:
+        const char *p;
+        const char *end;
+
+        void skipSpaces()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+                ++p;
+        }
+
+        bool parseValue(JsonValue &value)
+        {
+            skipSpaces();
+            if (p >= end)
+                return false;
+            switch (*p)
+            {
+            case '{':
+                return parseObject(value);
+            case '[':
+                return parseArray(value);
+            case '"':
+                value.type = JsonValue::String;
+                return parseString(value.string);
+            case 't':
+                value.type = JsonValue::Bool;
+                value.boolean = true;
+                return literal("true");
+            case 'f':
+                value.type = JsonValue::Bool;
+                value.boolean = false;
+                return literal("false");
+            case 'n':
+                value.type = JsonValue::Null;
+                return literal("null");
+            default:
+            {
+                char *numberEnd = nullptr;
+                value.type = JsonValue::Number;
+                value.number = std::strtod(p, &numberEnd);
+                if (numberEnd == p)
+                    return false;
+                p = numberEnd;
+                return true;
+            }
+            }
+        }
+
+        bool literal(const char *text)
+        {
+            size_t len = std::strlen(text);
+            if (static_cast<size_t>(end - p) < len || std::memcmp(p, text, len) != 0)
+                return false;
+            p += len;
+            return true;
+        }
+
+        bool parseString(std::string &out)
+        {
+            ++p; // 跳过 "
+            while (p < end && *p != '"')
+            {
+                if (*p == '\\' && p + 1 < end)
+                {
+                    ++p;
+                    switch (*p)
+                    {
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    case 'r':
+                        out += '\r';
+                        break;
+                    case 'b':
+                        out += '\b';
+                        break;
+                    case 'f':
+                        out += '\f';
+                        break;
+                    case 'u':
+                    {
+                        // 只处理 BMP 内的字符，编码为 UTF-8
+                        if (end - p < 5)
+                            return false;
+                        unsigned int code = std::strtoul(std::string(p + 1, p + 5).c_str(), nullptr, 16);
+                        if (code < 0x80)
+                            out += static_cast<char>(code);
+                        else if (code < 0x800)
+                        {
+                            out += static_cast<char>(0xC0 | (code >> 6));
+                            out += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        else
+                        {
+                            out += static_cast<char>(0xE0 | (code >> 12));
+                            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                            out += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        p += 4;
+                        break;
+                    }
+                    default:
+                        out += *p;
+                    }
+                }
+                else
+                    out += *p;
+                ++p;
+            }
+            if (p >= end)
+                return false;
+            ++p; // 跳过 "
+            return true;
+        }
+
+        bool parseArray(JsonValue &value)
+        {
+            value.type = JsonValue::Array;
+            ++p;
+            skipSpaces();
+            if (p < end && *p == ']')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                value.array.emplace_back();
+                if (!parseValue(value.array.back()))
+                    return false;
+                skipSpaces();
+                if (p < end && *p == ',')
+                    ++p;
+                else if (p < end && *p == ']')
+                {
+                    ++p;
+                    return true;
+                }
+                else
+                    return false;
+            }
+        }
+
+        bool parseObject(JsonValue &value)
+        {
+            value.type = JsonValue::Object;
+            ++p;
+            skipSpaces();
+            if (p < end && *p == '}')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                skipSpaces();
+                if (p >= end || *p != '"')
+                    return false;
+                value.object.emplace_back();
+                if (!parseString(value.object.back().first))
+                    return false;
+                skipSpaces();
+                if (p >= end || *p != ':')
+                    return false;
+                ++p;
+                if (!parseValue(value.object.back().second))
+                    return false;
+                skipSpaces();
+                if (p < end && *p == ',')
+                    ++p;
+                else if (p < end && *p == '}')
+                {
+                    ++p;
+                    return true;
+                }
+                else
+                    return false;
+            }
+        }
+    };
+
+    const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+    inline uint32_t readU32(const char *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    int componentCount(const std::string &type)
+    {
+        if (type == "SCALAR")
+            return 1;
+        if (type == "VEC2")
+            return 2;
+        if (type == "VEC3")
+            return 3;
+        if (type == "VEC4")
+            return 4;
+        return 0;
+    }
+
+    // 顶点属性与 vertex.glsl 中的 location 对应
+    struct AttributeBinding
+    {
+        const char *name;
+        GLuint location;
+    };
+    const AttributeBinding ATTRIBUTES[] = {{"POSITION", 0}, {"NORMAL", 1}, {"TEXCOORD_0", 2}};
+}
+
+GltfAsset::~GltfAsset()
+{
+    // 等待仍在解码的图片（解码读的是映射内存），释放像素内存
+    for (PendingImage &image : pending)
+    {
+        DecodedImage decoded = image.decoded.get();
+        stbi_image_free(decoded.pixels);
+    }
+    // GL 对象由资源持有，需要 GL 上下文仍然有效
+    for (const GltfPrimitive &primitive : primitives)
+        glDeleteVertexArrays(1, &primitive.VAO);
+    if (!buffers.empty())
+        glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+    if (!images.empty())
+        glDeleteTextures(static_cast<GLsizei>(images.size()), images.data());
+}
+
+bool GltfAsset::load(const std::string &path)
+{
+    if (!file.open(path))
+    {
+        std::cerr << "ERROR::GLTF::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+    const char *data = file.data();
+    const size_t size = file.size();
+    if (size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2)
+    {
+        std::cerr << "ERROR::GLTF::NOT_A_GLB_V2 " << path << std::endl;
+        return false;
+    }
+
+    // 文件头之后依次是 JSON 块和可选的 BIN 块
+    const char *json = nullptr, *bin = nullptr;
+    size_t jsonSize = 0, binSize = 0;
+    for (size_t offset = 12; offset + 8 <= size;)
+    {
+        uint32_t chunkSize = readU32(data + offset);
+        uint32_t chunkType = readU32(data + offset + 4);
+        if (offset + 8 + chunkSize > size)
+            break;
+        if (chunkType == GLB_CHUNK_JSON && !json)
+        {
+            json = data + offset + 8;
+            jsonSize = chunkSize;
+        }
+        else if (chunkType == GLB_CHUNK_BIN && !bin)
+        {
+            bin = data + offset + 8;
+            binSize = chunkSize;
+        }
+        offset += 8 + ((chunkSize + 3) & ~3u);
+    }
+
+    JsonValue root;
+    if (!json || !JsonParser(json, json + jsonSize).parse(root))
+    {
+        std::cerr << "ERROR::GLTF::INVALID_JSON " << path << std::endl;
+        return false;
+    }
+
+    const JsonValue &bufferViews = root["bufferViews"];
+    const JsonValue &accessors = root["accessors"];
+
+    // bufferView 在 BIN 块中的位置，只支持 GLB 内嵌的 buffer 0
+    auto viewData = [&](const JsonValue &view, size_t &length) -> const char *
+    {
+        size_t offset = view["byteOffset"].asSize(0);
+        length = view["byteLength"].asSize(0);
+        if (view["buffer"].asInt(0) != 0 || !bin || offset + length > binSize)
+            return nullptr;
+        return bin + offset;
+    };
+
+    // 每个 bufferView 只上传一次，顶点和索引共用
+    std::vector<unsigned int> viewBuffers(bufferViews.size(), 0);
+    auto bufferForView = [&](size_t viewIndex, GLenum target) -> unsigned int
+    {
+        if (viewIndex >= bufferViews.size())
+            return 0;
+        if (!viewBuffers[viewIndex])
+        {
+            size_t length;
+            const char *bytes = viewData(bufferViews[viewIndex], length);
+            if (!bytes)
+                return 0;
+            unsigned int buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+            glBufferData(target, length, bytes, GL_STATIC_DRAW);
+            viewBuffers[viewIndex] = buffer;
+            buffers.push_back(buffer);
+        }
+        return viewBuffers[viewIndex];
+    };
+
+    // 图片：内嵌的交给后台线程从映射内存解码，外部文件在后台线程读取后解码
+    std::string directory = path.substr(0, path.find_last_of('/'));
+    const JsonValue &imageList = root["images"];
+    for (size_t i = 0; i < imageList.size(); i++)
+    {
+        const JsonValue &image = imageList[i];
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const unsigned char white[4] = {255, 255, 255, 255};
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        images.push_back(texture);
+
+        if (image.has("bufferView"))
+        {
+            size_t length;
+            const char *bytes = viewData(bufferViews[image["bufferView"].asSize()], length);
+            if (!bytes)
+                continue;
+            pending.push_back({texture, std::async(std::launch::async, [bytes, length]()
+                                                   {
+                TraceScope trace("Texture decode");
+                DecodedImage decoded;
+                decoded.pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(bytes), static_cast<int>(length),
+                                                       &decoded.width, &decoded.height, &decoded.channels, 0);
+                if (!decoded.pixels)
+                    decoded.failure = stbi_failure_reason();
+                return decoded; })});
+        }
+        else if (image.has("uri") && image["uri"].string.compare(0, 5, "data:") != 0)
+        {
+            std::string filename = directory + '/' + image["uri"].string;
+            pending.push_back({texture, std::async(std::launch::async, [filename]()
+                                                   {
+                TraceScope trace("Texture decode");
+                DecodedImage decoded;
+                decoded.pixels = stbi_load(filename.c_str(), &decoded.width, &decoded.height, &decoded.channels, 0);
+                if (!decoded.pixels)
+                    decoded.failure = stbi_failure_reason();
+                return decoded; })});
+        }
+        else
+            std::cerr << "WARNING::GLTF::UNSUPPORTED_IMAGE " << i << std::endl;
+    }
+
+    // 材质只取 baseColorTexture
+    const JsonValue &textureList = root["textures"];
+    auto baseColorTexture = [&](int materialIndex) -> unsigned int
+    {
+        const JsonValue &material = root["materials"][static_cast<size_t>(materialIndex)];
+        int textureIndex = material["pbrMetallicRoughness"]["baseColorTexture"]["index"].asInt();
+        if (textureIndex < 0)
+            return 0;
+        int source = textureList[static_cast<size_t>(textureIndex)]["source"].asInt();
+        return source >= 0 && static_cast<size_t>(source) < images.size() ? images[source] : 0;
+    };
+
+    const JsonValue &meshList = root["meshes"];
+    for (size_t m = 0; m < meshList.size(); m++)
+    {
+        const JsonValue &primitiveList = meshList[m]["primitives"];
+        for (size_t p = 0; p < primitiveList.size(); p++)
+        {
+            const JsonValue &primitive = primitiveList[p];
+            const JsonValue &attributes = primitive["attributes"];
+            if (!attributes.has("POSITION"))
+                continue;
+
+            GltfPrimitive out;
+            out.mode = static_cast<GLenum>(primitive["mode"].asInt(GL_TRIANGLES));
+            out.indexType = 0;
+            out.indexOffset = 0;
+            out.mesh = static_cast<int>(m);
+            out.baseColorTexture = primitive.has("material") ? baseColorTexture(primitive["material"].asInt()) : 0;
+            const JsonValue &position = accessors[attributes["POSITION"].asSize()];
+            out.count = static_cast<GLsizei>(position["count"].asSize());
+            out.boundsMin = glm::vec3(position["min"][0].number, position["min"][1].number, position["min"][2].number);
+            out.boundsMax = glm::vec3(position["max"][0].number, position["max"][1].number, position["max"][2].number);
+
+            glGenVertexArrays(1, &out.VAO);
+            glBindVertexArray(out.VAO);
+
+            bool valid = true;
+            for (const AttributeBinding &binding : ATTRIBUTES)
+            {
+                if (!attributes.has(binding.name))
+                {
+                    glDisableVertexAttribArray(binding.location);
+                    continue;
+                }
+                const JsonValue &accessor = accessors[attributes[binding.name].asSize()];
+                if (!accessor.has("bufferView") || accessor.has("sparse"))
+                {
+                    valid = false;
+                    break;
+                }
+                const JsonValue &view = bufferViews[accessor["bufferView"].asSize()];
+                unsigned int buffer = bufferForView(accessor["bufferView"].asSize(), GL_ARRAY_BUFFER);
+                if (!buffer)
+                {
+                    valid = false;
+                    break;
+                }
+                // 直接使用 accessor 的分量类型，量化/归一化的数据交给 GL 转换
+                glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                glEnableVertexAttribArray(binding.location);
+                glVertexAttribPointer(binding.location, componentCount(accessor["type"].string),
+                                      static_cast<GLenum>(accessor["componentType"].asInt(GL_FLOAT)),
+                                      accessor["normalized"].asBool() ? GL_TRUE : GL_FALSE,
+                                      static_cast<GLsizei>(view["byteStride"].asSize(0)),
+                                      reinterpret_cast<void *>(accessor["byteOffset"].asSize(0)));
+            }
+            // 缺少法线时给一个常量，避免光照出现 NaN
+            if (!attributes.has("NORMAL"))
+                glVertexAttrib3f(1, 0.0f, 1.0f, 0.0f);
+
+            if (valid && primitive.has("indices"))
+            {
+                const JsonValue &accessor = accessors[primitive["indices"].asSize()];
+                unsigned int buffer = accessor.has("bufferView") ? bufferForView(accessor["bufferView"].asSize(), GL_ELEMENT_ARRAY_BUFFER) : 0;
+                if (buffer)
+                {
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+                    out.indexType = static_cast<GLenum>(accessor["componentType"].asInt(GL_UNSIGNED_INT));
+                    out.indexOffset = accessor["byteOffset"].asSize(0);
+                    out.count = static_cast<GLsizei>(accessor["count"].asSize());
+                }
+                else
+                    valid = false;
+            }
+            glBindVertexArray(0);
+
+            if (!valid)
+            {
+                std::cerr << "WARNING::GLTF::UNSUPPORTED_PRIMITIVE mesh " << m << " primitive " << p << std::endl;
+                glDeleteVertexArrays(1, &out.VAO);
+                continue;
+            }
+            primitives.push_back(out);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // 把默认场景的节点树展开成先序数组
+    const JsonValue &nodeList = root["nodes"];
+    const JsonValue &scene = root["scenes"][root["scene"].asSize(0)];
+    std::vector<bool> visited(nodeList.size(), false);
+    std::function<void(size_t, int)> addNode = [&](size_t index, int parent)
+    {
+        if (index >= nodeList.size() || visited[index])
+            return;
+        visited[index] = true;
+        const JsonValue &node = nodeList[index];
+        GltfNode out;
+        out.parent = parent;
+        out.mesh = node["mesh"].asInt();
+        out.local = glm::mat4(1.0f);
+        const JsonValue &matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    out.local[c][r] = static_cast<float>(matrix[c * 4 + r].number);
+        }
+        else
+        {
+            const JsonValue &t = node["translation"];
+            const JsonValue &r = node["rotation"];
+            const JsonValue &s = node["scale"];
+            if (t.size() == 3)
+                out.local = glm::translate(out.local, glm::vec3(t[0].number, t[1].number, t[2].number));
+            if (r.size() == 4)
+                out.local = out.local * glm::mat4_cast(glm::quat(static_cast<float>(r[3].number), static_cast<float>(r[0].number),
+                                                                 static_cast<float>(r[1].number), static_cast<float>(r[2].number)));
+            if (s.size() == 3)
+                out.local = glm::scale(out.local, glm::vec3(s[0].number, s[1].number, s[2].number));
+        }
+        int self = static_cast<int>(nodes.size());
+        nodes.push_back(out);
+        const JsonValue &children = node["children"];
+        for (size_t c = 0; c < children.size(); c++)
+            addNode(children[c].asSize(), self);
+    };
+    const JsonValue &sceneNodes = scene["nodes"];
+    for (size_t i = 0; i < sceneNodes.size(); i++)
+        addNode(sceneNodes[i].asSize(), -1);
+
+    return !primitives.empty();
+}
+
+bool GltfAsset::uploadPendingImages()
+{
+    for (size_t i = 0; i < pending.size();)
+    {
+        PendingImage &image = pending[i];
+        if (image.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++i;
+            continue;
+        }
+        TraceScope trace("Texture upload");
+        DecodedImage decoded = image.decoded.get();
+        if (decoded.pixels)
+        {
+            GLenum format = decoded.channels == 1 ? GL_RED : decoded.channels == 2 ? GL_RG
+                                                         : decoded.channels == 3   ? GL_RGB
+                                                                                   : GL_RGBA;
+            glBindTexture(GL_TEXTURE_2D, image.texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, decoded.width, decoded.height, 0, format, GL_UNSIGNED_BYTE, decoded.pixels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            stbi_image_free(decoded.pixels);
+        }
+        else
+            std::cout << "Texture failed to decode: " << (decoded.failure ? decoded.failure : "unknown") << std::endl;
+        pending.erase(pending.begin() + i);
+    }
+    // 图片都解码完后不再需要映射
+    if (pending.empty())
+        file.close();
+    return pending.empty();
+}
@@ -0,0 +1,71 @@
+#ifndef GLTF_LOADER_H
+#define GLTF_LOADER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <future>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// 原生 GLB (glTF 2.0 二进制) 加载器
+// BIN 块中的 bufferView 直接从内存映射上传为 GL 缓冲，按 accessor 的格式设置顶点属性，
+// 不做逐顶点重排；内嵌图片在后台线程解码，解码完成前使用 1x1 白色占位纹理
+// 缓冲、纹理和各图元的 VAO 归资源所有，析构时删除，使用它们的模型需要持有资源
+
+struct GltfPrimitive
+{
+    unsigned int VAO;
+    GLenum mode;       // GL_TRIANGLES 等
+    GLsizei count;     // 索引数（无索引时为顶点数）
+    GLenum indexType;  // 0 表示无索引，使用 glDrawArrays
+    size_t indexOffset; // 索引在缓冲中的字节偏移
+    int mesh;          // 所属 glTF mesh 下标
+    glm::vec3 boundsMin, boundsMax; // POSITION accessor 的 min/max
+    unsigned int baseColorTexture; // GL 纹理，0 表示无贴图
+};
+
+// 默认场景中的节点，按先序排列（父节点在前）
+struct GltfNode
+{
+    int parent; // nodes 中的下标，-1 表示场景根
+    glm::mat4 local;
+    int mesh; // -1 表示不挂网格
+};
+
+class GltfAsset
+{
+public:
+    GltfAsset() {}
+    ~GltfAsset();
+    GltfAsset(const GltfAsset &) = delete;
+    GltfAsset &operator=(const GltfAsset &) = delete;
+
+    bool load(const std::string &path);
+    // 把已解码完成的图片上传到 GL（必须在 GL 线程调用），全部完成后返回 true 并释放文件映射
+    bool uploadPendingImages();
+
+    std::vector<GltfPrimitive> primitives;
+    std::vector<GltfNode> nodes;
+    std::vector<unsigned int> images;   // GL 纹理，每个 glTF image 一个
+    std::vector<unsigned int> buffers;  // GL 缓冲，每个被几何引用的 bufferView 一个
+
+private:
+    struct DecodedImage
+    {
+        int width = 0, height = 0, channels = 0;
+        unsigned char *pixels = nullptr;
+        const char *failure = nullptr; // stbi_failure_reason() 是线程局部的，须在解码线程读取
+    };
+
+    struct PendingImage
+    {
+        unsigned int texture;
+        std::future<DecodedImage> decoded;
+    };
+
+    MappedFile file; // 后台解码期间必须保持映射
+    std::vector<PendingImage> pending;
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include "headless.h"
+
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "image_writer.h"
+
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+static void printUsage(const char *program)
+{
+    std::cerr << "usage: " << program
+              << " [--headless] [--model PATH] [--shader-dir DIR] [--resource-dir DIR] [--camera X,Y,Z] [--target X,Y,Z] [--size WxH] [--frames N]"
+                 " [--output PATH] [--trace PATH] [--capture DIR] [--capture-format png|ppm]"
+                 " [--shader-cache DIR|off] [--lights N] [--renderer forward|deferred] [--prepass off|on|auto]"
+                 " [--ssao off|half|quarter] [--post on|off]"
+              << std::endl;
+}
+
+static bool parseVec3(const char *text, glm::vec3 &out)
+{
+    return std::sscanf(text, "%f,%f,%f", &out.x, &out.y, &out.z) == 3;
+}
+
+bool parseRenderOptions(int argc, char **argv, RenderOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+        {
+            options.headless = true;
+            continue;
+        }
+        // 其余参数都带一个值
+        if (i + 1 >= argc)
+        {
+            std::cerr << "ERROR::ARGS::MISSING_VALUE " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        const char *value = argv[++i];
+        bool ok = true;
+        if (arg == "--model")
+            options.model = value;
+        else if (arg == "--shader-dir")
+            options.shaderDir = value;
+        else if (arg == "--resource-dir")
+            options.resourceDir = value;
+        else if (arg == "--camera")
+            ok = options.hasCamera = parseVec3(value, options.cameraPosition);
+        else if (arg == "--target")
+            ok = parseVec3(value, options.cameraTarget);
+        else if (arg == "--size")
+            ok = std::sscanf(value, "%dx%d", &options.width, &options.height) == 2 && options.width > 0 && options.height > 0;
+        else if (arg == "--frames")
+            ok = (options.frames = std::atoi(value)) > 0;
+        else if (arg == "--output")
+            options.output = value;
+        else if (arg == "--trace")
+            options.trace = value;
+        else if (arg == "--capture")
+            options.capture = value;
+        else if (arg == "--shader-cache")
+            options.shaderCache = std::strcmp(value, "off") == 0 ? "" : value;
+        else if (arg == "--lights")
+            ok = (options.lights = std::atoi(value)) >= 0;
+        else if (arg == "--renderer")
+            ok = (options.deferred = std::strcmp(value, "deferred") == 0) || std::strcmp(value, "forward") == 0;
+        else if (arg == "--prepass")
+            ok = (options.prepass = value) == "off" || options.prepass == "on" || options.prepass == "auto";
+        else if (arg == "--ssao")
+            ok = (options.ssao = value) == "off" || options.ssao == "half" || options.ssao == "quarter";
+        else if (arg == "--post")
+            ok = (options.postProcess = std::strcmp(value, "on") == 0) || std::strcmp(value, "off") == 0;
+        else if (arg == "--capture-format")
+            ok = (options.captureFormat = value) == "png" || options.captureFormat == "ppm";
+        else
+        {
+            std::cerr << "ERROR::ARGS::UNKNOWN " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        if (!ok)
+        {
+            std::cerr << "ERROR::ARGS::INVALID " << arg << " " << value << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+#ifdef HEADLESS_EGL
+
+static bool hasExtension(const char *extensions, const char *name)
+{
+    if (!extensions)
+        return false;
+    size_t length = std::strlen(name);
+    for (const char *p = extensions; (p = std::strstr(p, name)) != nullptr; p += length)
+    {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+bool HeadlessContext::create()
+{
+    destroy();
+    // 优先用 surfaceless 平台，完全不需要显示服务器；不支持时退回默认显示
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY)
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        std::cerr << "ERROR::HEADLESS::EGL_INIT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        return false;
+    }
+    display = eglDisplay;
+    if (!hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        std::cerr << "ERROR::HEADLESS::NO_SURFACELESS_CONTEXT" << std::endl;
+        destroy();
+        return false;
+    }
+
+    // 不创建任何 surface，配置只要求能跑桌面 GL
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_DONT_CARE,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cerr << "ERROR::HEADLESS::NO_GL_CONFIG" << std::endl;
+        destroy();
+        return false;
+    }
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT)
+    {
+        std::cerr << "ERROR::HEADLESS::CONTEXT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        destroy();
+        return false;
+    }
+    context = eglContext;
+    this->config = config;
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        std::cerr << "ERROR::HEADLESS::MAKE_CURRENT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        destroy();
+        return false;
+    }
+    std::cout << "Headless EGL " << major << "." << minor << std::endl;
+    return true;
+}
+
+bool HeadlessContext::createShared(const HeadlessContext &main)
+{
+    destroy();
+    if (!main.context)
+        return false;
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext eglContext = eglCreateContext(main.display, main.config, main.context, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT)
+    {
+        std::cerr << "ERROR::HEADLESS::SHARED_CONTEXT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        return false;
+    }
+    display = main.display;
+    context = eglContext;
+    config = main.config;
+    shared = true;
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (!display)
+        return;
+    if (eglGetCurrentContext() == context)
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context)
+        eglDestroyContext(display, context);
+    if (!shared)
+        eglTerminate(display);
+    display = nullptr;
+    context = nullptr;
+    config = nullptr;
+    shared = false;
+}
+
+void HeadlessContext::makeCurrent()
+{
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+void HeadlessContext::releaseCurrent()
+{
+    EGLDisplay current = eglGetCurrentDisplay();
+    if (current != EGL_NO_DISPLAY)
+        eglMakeCurrent(current, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+GLADloadproc HeadlessContext::loader()
+{
+    return reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+}
+
+#else
+
+bool HeadlessContext::create()
+{
+    destroy();
+    if (!glfwInit())
+    {
+        std::cerr << "ERROR::HEADLESS::GLFW_INIT_FAILED" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(1, 1, "Headless", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "ERROR::HEADLESS::WINDOW_FAILED" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    display = window;
+    return true;
+}
+
+bool HeadlessContext::createShared(const HeadlessContext &main)
+{
+    destroy();
+    if (!main.display)
+        return false;
+    // 窗口提示沿用 create 时设置的版本和隐藏属性
+    GLFWwindow *window = glfwCreateWindow(1, 1, "Headless", nullptr, static_cast<GLFWwindow *>(main.display));
+    if (!window)
+    {
+        std::cerr << "ERROR::HEADLESS::SHARED_CONTEXT_FAILED" << std::endl;
+        return false;
+    }
+    display = window;
+    shared = true;
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (!display)
+        return;
+    glfwDestroyWindow(static_cast<GLFWwindow *>(display));
+    if (!shared)
+        glfwTerminate();
+    display = nullptr;
+    shared = false;
+}
+
+void HeadlessContext::makeCurrent()
+{
+    glfwMakeContextCurrent(static_cast<GLFWwindow *>(display));
+}
+
+void HeadlessContext::releaseCurrent()
+{
+    glfwMakeContextCurrent(nullptr);
+}
+
+GLADloadproc HeadlessContext::loader()
+{
+    return reinterpret_cast<GLADloadproc>(glfwGetProcAddress);
+}
+
+#endif
+
+bool writeFramebufferPPM(const std::string &path, int width, int height)
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    // GL 的行从下到上
+    size_t row = static_cast<size_t>(width) * 3;
+    std::vector<unsigned char> flipped(pixels.size());
+    for (int y = 0; y < height; y++)
+        std::memcpy(flipped.data() + y * row, pixels.data() + (height - 1 - y) * row, row);
+    return writePPM(path, width, height, flipped.data());
+}
@@ -0,0 +1,92 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+
+// 源码树位置由构建系统定义，着色器和资源的默认目录都相对于它
+#ifndef SOURCE_DIR
+#define SOURCE_DIR "."
+#endif
+
+// 命令行参数
+//   --headless            不创建窗口，渲染到离屏帧缓冲
+//   --model PATH          要加载的模型，默认为资源目录下的骷髅模型
+//   --shader-dir DIR      着色器目录，默认为源码树的 shaders
+//   --resource-dir DIR    资源目录（默认模型和贴图），默认为源码树的 resources
+//   --camera X,Y,Z        相机位置
+//   --target X,Y,Z        相机注视点（给了 --camera 时默认看向原点）
+//   --size WxH            渲染分辨率
+//   --frames N            无窗口模式渲染的帧数，模拟时间按 1/60 秒步进
+//   --output PATH         无窗口模式结束时把最后一帧写成 PPM
+//   --trace PATH          记录跟踪并在退出时写出
+//   --capture DIR         把每一帧异步读回并写成图像序列（无窗口模式不丢帧）
+//   --capture-format FMT  png（默认）或 ppm
+//   --shader-cache DIR    程序二进制缓存目录，默认 shader_cache，off 关闭
+//   --lights N            动态点光源数，默认 64
+//   --renderer MODE       forward（默认）或 deferred
+//   --prepass MODE        前向路径的深度预通道：off、on 或 auto（默认，按测得的重叠绘制决定）
+//   --ssao RES            环境光遮蔽的分辨率：off、half（默认）或 quarter
+//   --post on|off         HDR 后处理（泛光、自动曝光、色调映射），默认 on；off 时直接画到输出帧缓冲
+struct RenderOptions
+{
+    bool headless = false;
+    std::string model;
+    std::string shaderDir = SOURCE_DIR "/shaders";
+    std::string resourceDir = SOURCE_DIR "/resources";
+    bool hasCamera = false;
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraTarget = glm::vec3(0.0f);
+    int width = 800, height = 600;
+    int frames = 1;
+    std::string output;
+    std::string trace;
+    std::string capture;
+    std::string captureFormat = "png";
+    std::string shaderCache = "shader_cache";
+    int lights = 64; // 分簇光照的动态点光源数
+    bool deferred = false;
+    std::string prepass = "auto";
+    std::string ssao = "half";
+    bool postProcess = true;
+};
+
+// 解析失败时输出错误和用法并返回 false
+bool parseRenderOptions(int argc, char **argv, RenderOptions &options);
+
+// 无窗口的 GL 3.3 核心上下文
+// 有 EGL 时（Linux，编译时定义 HEADLESS_EGL）用 EGL_MESA_platform_surfaceless 建立不依赖 X/Wayland 的上下文，
+// 没有默认帧缓冲，所有绘制都要进 FBO；可以跑在 Mesa llvmpipe 上。
+// 没有 EGL 时（macOS）退回隐藏的 GLFW 窗口。
+class HeadlessContext
+{
+public:
+    HeadlessContext() {}
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+    bool create();
+    // 与 main 共享对象的上下文（后台编译线程用），创建后不设为当前，由使用它的线程调用 makeCurrent
+    bool createShared(const HeadlessContext &main);
+    void destroy();
+
+    void makeCurrent();
+    // 解除调用线程的当前上下文
+    static void releaseCurrent();
+
+    // 交给 gladLoadGLLoader 和 StreamBuffer::loadExtensions
+    static GLADloadproc loader();
+
+private:
+    void *display = nullptr; // EGLDisplay 或 GLFWwindow
+    void *context = nullptr; // EGLContext
+    void *config = nullptr;  // EGLConfig，共享上下文沿用
+    bool shared = false;     // 共享上下文不负责终止显示连接
+};
+
+// 读回当前绑定的读帧缓冲并写成二进制 PPM（行序翻转成从上到下）
+bool writeFramebufferPPM(const std::string &path, int width, int height);
+
+#endif
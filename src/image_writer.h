@@ -0,0 +1,11 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <string>
+
+// 8 位 RGB 图像写出，像素按行从上到下紧密排列
+// PNG 的 zlib 流只用不压缩的 stored 块：编码几乎只是拷贝，写线程能跟上渲染帧率，代价是文件和原始数据一样大
+bool writePPM(const std::string &path, int width, int height, const unsigned char *rgb);
+bool writePNG(const std::string &path, int width, int height, const unsigned char *rgb);
+
+#endif
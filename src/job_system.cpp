@@ -0,0 +1,181 @@
+#include "job_system.h"
+
+#include <chrono>
+#include "trace.h"
+
+namespace
+{
+    // 当前线程的工作队列编号，非工作线程为 -1（提交和等待时使用 0 号队列）
+    thread_local int currentWorker = -1;
+
+    int64_t nowNs()
+    {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+JobSystem::JobSystem(int numWorkers)
+{
+    if (numWorkers < 0)
+        numWorkers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1;
+    for (int i = 0; i <= numWorkers; i++)
+        queues.emplace_back(new WorkQueue());
+    for (unsigned int i = 1; i <= static_cast<unsigned int>(numWorkers); i++)
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    lastSampleNs = nowNs();
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void JobSystem::run(std::function<void()> job, Counter *counter)
+{
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    push(std::move(job), counter);
+}
+
+void JobSystem::runAfter(Counter &dependency, std::function<void()> job, Counter *counter)
+{
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // 与 complete() 在同一把锁下检查，避免依赖刚好归零时丢失后续任务
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0)
+        {
+            dependency.continuations.push_back([this, job, counter]()
+                                               { push(job, counter); });
+            return;
+        }
+    }
+    push(std::move(job), counter);
+}
+
+void JobSystem::wait(Counter &counter)
+{
+    unsigned int self = currentWorker >= 0 ? currentWorker : 0;
+    while (!counter.done())
+    {
+        if (!tryExecute(self))
+            std::this_thread::yield();
+    }
+    // 最后一次 complete() 在锁内归零，等它放开锁再返回，调用者随后销毁栈上的 Counter 才安全
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+std::vector<float> JobSystem::sampleUtilization()
+{
+    int64_t now = nowNs();
+    double elapsed = static_cast<double>(std::max<int64_t>(1, now - lastSampleNs));
+    lastSampleNs = now;
+    std::vector<float> utilization;
+    for (auto &queue : queues)
+    {
+        uint64_t busy = queue->busyNs.load(std::memory_order_relaxed);
+        utilization.push_back(static_cast<float>(std::min(1.0, (busy - queue->lastBusyNs) / elapsed)));
+        queue->lastBusyNs = busy;
+    }
+    return utilization;
+}
+
+void JobSystem::push(std::function<void()> job, Counter *counter)
+{
+    unsigned int target = currentWorker >= 0 ? currentWorker : 0;
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->jobs.emplace_back(std::move(job), counter);
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::tryExecute(unsigned int self)
+{
+    std::function<void()> job;
+    Counter *counter = nullptr;
+    bool found = false;
+
+    // 先取自己队列的尾部
+    {
+        WorkQueue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.back().first);
+            counter = own.jobs.back().second;
+            own.jobs.pop_back();
+            found = true;
+        }
+    }
+    // 再从其他队列头部窃取
+    for (size_t k = 1; !found && k < queues.size(); k++)
+    {
+        WorkQueue &victim = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.front().first);
+            counter = victim.jobs.front().second;
+            victim.jobs.pop_front();
+            found = true;
+        }
+    }
+    if (!found)
+        return false;
+
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    execute(self, job, counter);
+    return true;
+}
+
+void JobSystem::execute(unsigned int self, std::function<void()> &job, Counter *counter)
+{
+    int64_t start = nowNs();
+    TraceScope trace("Job");
+    job();
+    queues[self]->busyNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+    complete(counter);
+}
+
+void JobSystem::complete(Counter *counter)
+{
+    if (!counter)
+        return;
+    // 归零和取出后续任务在同一把锁下完成：锁放开后不再访问 counter，wait() 返回时它可能已被销毁
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        continuations.swap(counter->continuations);
+    }
+    for (auto &continuation : continuations)
+        continuation();
+}
+
+void JobSystem::workerLoop(unsigned int self)
+{
+    currentWorker = static_cast<int>(self);
+    Trace::setThreadName("worker");
+    while (running.load(std::memory_order_acquire))
+    {
+        if (tryExecute(self))
+            continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]()
+                  { return queued.load(std::memory_order_acquire) > 0 || !running.load(std::memory_order_acquire); });
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取任务调度器
+// 每个工作线程一个双端队列：自己从尾部取（后进先出，缓存友好），空闲时从其他队列头部窃取。
+// 调用 wait() 的线程（通常是主线程，编号 0）也会参与执行任务。
+class JobSystem
+{
+public:
+    // 任务计数器：提交时加一、完成时减一，归零后启动挂在它上面的后续任务
+    class Counter
+    {
+    public:
+        bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<int> pending{0};
+        std::mutex mutex;
+        std::vector<std::function<void()>> continuations;
+    };
+
+    // numWorkers 为后台线程数，负数时使用 硬件线程数 - 1
+    explicit JobSystem(int numWorkers = -1);
+    ~JobSystem();
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void run(std::function<void()> job, Counter *counter = nullptr);
+    // dependency 归零后再执行 job
+    void runAfter(Counter &dependency, std::function<void()> job, Counter *counter = nullptr);
+    // 等待计数器归零，期间执行队列中的任务
+    void wait(Counter &counter);
+
+    // 把 [0, count) 按 grain 切块并行执行 fn(begin, end)
+    template <typename Fn>
+    void parallelFor(size_t count, size_t grain, Fn fn, Counter &counter)
+    {
+        grain = std::max<size_t>(1, grain);
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            size_t end = std::min(count, begin + grain);
+            run([fn, begin, end]()
+                { fn(begin, end); },
+                &counter);
+        }
+    }
+
+    // dependency 归零后再启动 parallelFor，counter 在全部分块完成后归零
+    template <typename Fn>
+    void parallelForAfter(Counter &dependency, size_t count, size_t grain, Fn fn, Counter &counter)
+    {
+        runAfter(dependency, [this, count, grain, fn, &counter]()
+                 { parallelFor(count, grain, fn, counter); },
+                 &counter);
+    }
+
+    // 包括调用 wait 的线程在内的执行线程数
+    unsigned int threadCount() const { return static_cast<unsigned int>(queues.size()); }
+    // 各线程自上次调用以来的忙碌比例（0~1），编号 0 为主线程
+    std::vector<float> sampleUtilization();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::pair<std::function<void()>, Counter *>> jobs;
+        std::atomic<uint64_t> busyNs{0};
+        uint64_t lastBusyNs = 0;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{true};
+    std::atomic<int> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    int64_t lastSampleNs = 0;
+
+    void push(std::function<void()> job, Counter *counter);
+    bool tryExecute(unsigned int self);
+    void execute(unsigned int self, std::function<void()> &job, Counter *counter);
+    void complete(Counter *counter);
+    void workerLoop(unsigned int self);
+};
+
+#endif
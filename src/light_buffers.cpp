@@ -0,0 +1,72 @@
+#include "light_buffers.h"
+#include "shader_variants.h"
+
+namespace
+{
+    const GLenum FORMATS[] = {GL_RGBA32F, GL_RG32UI, GL_R16UI};
+}
+
+LightBuffers::~LightBuffers()
+{
+    destroy();
+}
+
+bool LightBuffers::create()
+{
+    destroy();
+    glGenBuffers(BUFFER_COUNT, buffers);
+    glGenTextures(BUFFER_COUNT, textures);
+    for (int i = 0; i < BUFFER_COUNT; i++)
+    {
+        // 缓冲纹理不能关联空存储，先放一个元素
+        const uint32_t zero[4] = {};
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(zero), zero, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, FORMATS[i], buffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+void LightBuffers::destroy()
+{
+    if (buffers[0])
+    {
+        glDeleteTextures(BUFFER_COUNT, textures);
+        glDeleteBuffers(BUFFER_COUNT, buffers);
+    }
+    for (int i = 0; i < BUFFER_COUNT; i++)
+        buffers[i] = textures[i] = 0;
+}
+
+void LightBuffers::write(int index, const void *data, size_t size)
+{
+    if (size == 0)
+        return;
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+    glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    bytes += size;
+}
+
+void LightBuffers::upload(const std::vector<LightPacket> &lights, const LightClusters &clusters)
+{
+    bytes = 0;
+    write(LIGHTS, lights.data(), lights.size() * sizeof(LightPacket));
+    write(GRID, clusters.grid().data(), clusters.grid().size() * sizeof(uint32_t));
+    write(INDICES, clusters.lightIndices().data(), clusters.lightIndices().size() * sizeof(uint16_t));
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightBuffers::bind() const
+{
+    const int units[] = {LIGHT_TEXTURE_UNIT, CLUSTER_TEXTURE_UNIT, LIGHT_INDEX_TEXTURE_UNIT};
+    for (int i = 0; i < BUFFER_COUNT; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,44 @@
+#ifndef LIGHT_BUFFERS_H
+#define LIGHT_BUFFERS_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "light_clusters.h"
+
+// 分簇光照的 GPU 数据：三个缓冲纹理（GL 3.3 没有 SSBO）
+// 光源数组（每个光源两个 RGBA32F 纹素）、簇表（RG32UI：起始位置和数量）、光源下标列表（R16UI）。
+// 每帧整块重新分配存储再写入（orphaning），不会等待上一帧的绘制读完。
+class LightBuffers
+{
+public:
+    LightBuffers() {}
+    ~LightBuffers();
+    LightBuffers(const LightBuffers &) = delete;
+    LightBuffers &operator=(const LightBuffers &) = delete;
+
+    bool create();
+    void destroy();
+
+    void upload(const std::vector<LightPacket> &lights, const LightClusters &clusters);
+    // 绑定到三个纹理单元（见 shader_variants.h），调用后活动纹理单元恢复为 0
+    void bind() const;
+
+    // 本帧上传的字节数
+    size_t uploadedBytes() const { return bytes; }
+
+private:
+    enum
+    {
+        LIGHTS,
+        GRID,
+        INDICES,
+        BUFFER_COUNT
+    };
+    GLuint buffers[BUFFER_COUNT] = {};
+    GLuint textures[BUFFER_COUNT] = {};
+    size_t bytes = 0;
+
+    void write(int index, const void *data, size_t size);
+};
+
+#endif
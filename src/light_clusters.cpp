@@ -0,0 +1,179 @@
+#include "light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+constexpr int LightClusters::TILES_X;
+constexpr int LightClusters::TILES_Y;
+constexpr int LightClusters::SLICES;
+constexpr int LightClusters::COUNT;
+constexpr size_t LightClusters::MAX_LIGHTS;
+
+namespace
+{
+    // 球心到 AABB 的距离平方
+    inline float distanceSquared(float x, float y, float z, float x0, float y0, float z0, float x1, float y1, float z1)
+    {
+        float dx = std::max(std::max(x0 - x, x - x1), 0.0f);
+        float dy = std::max(std::max(y0 - y, y - y1), 0.0f);
+        float dz = std::max(std::max(z0 - z, z - z1), 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+}
+
+void LightClusters::rebuild(const glm::mat4 &projection)
+{
+    // glm::perspective 的矩阵：[2][2] = -(f+n)/(f-n)，[3][2] = -2fn/(f-n)
+    float n = projection[3][2] / (projection[2][2] - 1.0f);
+    float f = projection[3][2] / (projection[2][2] + 1.0f);
+    float tx = 1.0f / projection[0][0];
+    float ty = 1.0f / projection[1][1];
+    if (n == nearPlane && f == farPlane && tx == tanX && ty == tanY && !minX.empty())
+        return;
+    nearPlane = n;
+    farPlane = f;
+    tanX = tx;
+    tanY = ty;
+    scale = SLICES / std::log(farPlane / nearPlane);
+    bias = -std::log(nearPlane) * scale;
+
+    for (std::vector<float> *list : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+        list->resize(COUNT);
+    for (int z = 0; z < SLICES; z++)
+    {
+        float depth0 = nearPlane * std::pow(farPlane / nearPlane, float(z) / SLICES);
+        float depth1 = nearPlane * std::pow(farPlane / nearPlane, float(z + 1) / SLICES);
+        for (int y = 0; y < TILES_Y; y++)
+        {
+            float ndcY0 = -1.0f + 2.0f * y / TILES_Y, ndcY1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+            for (int x = 0; x < TILES_X; x++)
+            {
+                float ndcX0 = -1.0f + 2.0f * x / TILES_X, ndcX1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+                // 给定 NDC 坐标时视空间 x 随深度线性变化，极值在近端或远端
+                int i = (z * TILES_Y + y) * TILES_X + x;
+                minX[i] = std::min(ndcX0 * depth0, ndcX0 * depth1) * tanX;
+                maxX[i] = std::max(ndcX1 * depth0, ndcX1 * depth1) * tanX;
+                minY[i] = std::min(ndcY0 * depth0, ndcY0 * depth1) * tanY;
+                maxY[i] = std::max(ndcY1 * depth0, ndcY1 * depth1) * tanY;
+                minZ[i] = -depth1;
+                maxZ[i] = -depth0;
+            }
+        }
+    }
+}
+
+int LightClusters::sliceOf(float depth) const
+{
+    return std::max(0, std::min(SLICES - 1, int(std::log(depth) * scale + bias)));
+}
+
+void LightClusters::assign(const glm::mat4 &view, const glm::mat4 &projection, const std::vector<LightPacket> &lights, bool simd)
+{
+    rebuild(projection);
+    counters = Stats();
+    hitClusters.clear();
+    hitLights.clear();
+    size_t count = std::min(lights.size(), MAX_LIGHTS);
+    for (size_t l = 0; l < count; l++)
+    {
+        glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(lights[l].positionRadius), 1.0f));
+        float radius = lights[l].positionRadius.w;
+        float depth = -center.z;
+        if (depth + radius < nearPlane || depth - radius > farPlane)
+            continue;
+        counters.lights++;
+
+        // 候选范围：包围球的 AABB 在近端和远端深度处投影到屏幕上的范围（矩形在透视投影下的极值在角点）
+        float nearDepth = std::max(depth - radius, nearPlane);
+        float farDepth = std::min(depth + radius, farPlane);
+        float ndc[4] = {1e30f, -1e30f, 1e30f, -1e30f};
+        for (float d : {nearDepth, farDepth})
+        {
+            for (float sx : {-radius, radius})
+            {
+                float v = (center.x + sx) / (d * tanX);
+                ndc[0] = std::min(ndc[0], v);
+                ndc[1] = std::max(ndc[1], v);
+            }
+            for (float sy : {-radius, radius})
+            {
+                float v = (center.y + sy) / (d * tanY);
+                ndc[2] = std::min(ndc[2], v);
+                ndc[3] = std::max(ndc[3], v);
+            }
+        }
+        if (ndc[1] < -1.0f || ndc[0] > 1.0f || ndc[3] < -1.0f || ndc[2] > 1.0f)
+            continue;
+        int x0 = std::max(0, int((ndc[0] + 1.0f) * 0.5f * TILES_X));
+        int x1 = std::min(TILES_X - 1, int((ndc[1] + 1.0f) * 0.5f * TILES_X));
+        int y0 = std::max(0, int((ndc[2] + 1.0f) * 0.5f * TILES_Y));
+        int y1 = std::min(TILES_Y - 1, int((ndc[3] + 1.0f) * 0.5f * TILES_Y));
+        int z0 = sliceOf(nearDepth), z1 = sliceOf(farDepth);
+        float radiusSquared = radius * radius;
+
+        for (int z = z0; z <= z1; z++)
+            for (int y = y0; y <= y1; y++)
+            {
+                int row = (z * TILES_Y + y) * TILES_X;
+#ifdef __SSE2__
+                if (simd)
+                {
+                    // 从 4 对齐的位置开始整组测试，范围外的簇若真的相交也是正确结果
+                    __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+                    __m128 r2 = _mm_set1_ps(radiusSquared), zero = _mm_setzero_ps();
+                    for (int x = x0 & ~3; x <= x1; x += 4)
+                    {
+                        int i = row + x;
+                        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minX[i]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&maxX[i]))), zero);
+                        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minY[i]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&maxY[i]))), zero);
+                        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minZ[i]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&maxZ[i]))), zero);
+                        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                        int mask = _mm_movemask_ps(_mm_cmple_ps(d2, r2));
+                        while (mask)
+                        {
+                            int bit = __builtin_ctz(mask);
+                            mask &= mask - 1;
+                            hitClusters.push_back(static_cast<uint32_t>(i + bit));
+                            hitLights.push_back(static_cast<uint16_t>(l));
+                        }
+                    }
+                    continue;
+                }
+#endif
+                for (int x = x0; x <= x1; x++)
+                {
+                    int i = row + x;
+                    if (distanceSquared(center.x, center.y, center.z, minX[i], minY[i], minZ[i], maxX[i], maxY[i], maxZ[i]) <= radiusSquared)
+                    {
+                        hitClusters.push_back(static_cast<uint32_t>(i));
+                        hitLights.push_back(static_cast<uint16_t>(l));
+                    }
+                }
+            }
+    }
+
+    // 计数排序：每个簇的光源按光源顺序连续存放
+    cells.assign(COUNT * 2, 0);
+    for (uint32_t cluster : hitClusters)
+        cells[cluster * 2 + 1]++;
+    uint32_t offset = 0;
+    for (int i = 0; i < COUNT; i++)
+    {
+        cells[i * 2] = offset;
+        offset += cells[i * 2 + 1];
+        counters.maxPerCluster = std::max(counters.maxPerCluster, cells[i * 2 + 1]);
+        counters.occupied += cells[i * 2 + 1] > 0;
+        cells[i * 2 + 1] = 0;
+    }
+    indices.resize(hitLights.size());
+    for (size_t h = 0; h < hitClusters.size(); h++)
+    {
+        uint32_t cluster = hitClusters[h];
+        indices[cells[cluster * 2] + cells[cluster * 2 + 1]++] = hitLights[h];
+    }
+    counters.references = indices.size();
+}
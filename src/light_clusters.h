@@ -0,0 +1,60 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "scene.h"
+
+// 分簇前向渲染的光源分配（CPU 部分，不涉及 GL），在模拟线程里随快照一起计算
+// 视锥在屏幕上切成 TILES_X x TILES_Y 个块，深度方向在近远平面之间按指数切成 SLICES 层，
+// 每个簇是视空间里的一个 AABB。每个光源先用包围球投影出的屏幕范围和深度范围圈出候选簇，
+// 再逐簇做球与 AABB 的精确测试（SSE 一次测一行中的 4 个簇），结果按簇排序成紧凑的下标列表。
+// 着色器用 gl_FragCoord 和视空间深度找到自己的簇，只遍历其中的光源。
+class LightClusters
+{
+public:
+    static constexpr int TILES_X = 16;
+    static constexpr int TILES_Y = 9;
+    static constexpr int SLICES = 24;
+    static constexpr int COUNT = TILES_X * TILES_Y * SLICES;
+    // 下标列表用 16 位存放
+    static constexpr size_t MAX_LIGHTS = 65535;
+
+    struct Stats
+    {
+        size_t lights = 0;     // 参与分配的光源（在视锥深度范围内）
+        size_t references = 0; // 下标列表总长度
+        size_t occupied = 0;   // 至少有一个光源的簇
+        uint32_t maxPerCluster = 0;
+    };
+
+    // projection 为透视投影，近远平面和视场角从矩阵中取出；只在投影变化时重建簇的包围盒
+    // simd 为 false 时用标量测试（用于对比），不支持 SSE 的平台总是标量
+    void assign(const glm::mat4 &view, const glm::mat4 &projection, const std::vector<LightPacket> &lights, bool simd = true);
+
+    // 每个簇两个值：下标列表中的起始位置和光源数
+    const std::vector<uint32_t> &grid() const { return cells; }
+    const std::vector<uint16_t> &lightIndices() const { return indices; }
+    const Stats &stats() const { return counters; }
+    // 着色器由视空间深度求层号：slice = log(depth) * sliceScale + sliceBias
+    float sliceScale() const { return scale; }
+    float sliceBias() const { return bias; }
+
+private:
+    // 簇的视空间 AABB，按结构数组存放，一行 TILES_X 个簇连续，便于 SIMD 读取
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    float nearPlane = 0.0f, farPlane = 0.0f, tanX = 0.0f, tanY = 0.0f;
+    float scale = 0.0f, bias = 0.0f;
+
+    std::vector<uint32_t> cells;
+    std::vector<uint16_t> indices;
+    std::vector<uint32_t> hitClusters; // 临时：每次命中的簇和光源
+    std::vector<uint16_t> hitLights;
+    Stats counters;
+
+    void rebuild(const glm::mat4 &projection);
+    int sliceOf(float depth) const;
+};
+
+#endif
@@ -5,9 +5,38 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
 #include "shader.h"
 #include "model_loader.h"
+#include "controller.h"
+#include "scene.h"
+#include "job_system.h"
+#include "frame_jobs.h"
+#include "frame_pipeline.h"
+#include "fixed_timestep.h"
+#include "stream_buffer.h"
+#include "uniform_blocks.h"
+#include "profiler.h"
+#include "framebuffer.h"
+#include "headless.h"
+#include "frame_capture.h"
+#include "shader_manager.h"
+#include "shader_variants.h"
+#include "file_watcher.h"
+#include "shadow_map.h"
+#include "light_buffers.h"
+#include "gbuffer.h"
+#include "overdraw_monitor.h"
+#include "ssao.h"
+#include "render_target_pool.h"
+#include "post_process.h"
 #include "stb_image.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -17,73 +46,48 @@
 const unsigned int WIDTH = 800;
 const unsigned int HEIGHT = 600;
 
-// 摄像机参数
-glm::vec3 cameraPos(0.0f, 3.0f, 30.0f);
-glm::vec3 cameraFront(0.0f, -0.3f, -1.0f);
-glm::vec3 cameraUp(0.0f, 1.0f, 0.0f);
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
-
-// 模型变换参数
-glm::vec3 modelPos(0.0f, -10.0f, 0.0f);
-glm::vec3 modelRotation(0.0f, 0.0f, 0.0f);
-float modelScale = 0.6f;
-
 // 鼠标参数
 bool firstMouse = true;
 float lastX = WIDTH / 2.0f, lastY = HEIGHT / 2.0f;
 
-// 光源位置
-glm::vec3 lightPos(0.0f, 10.0f, 10.0f);
-
 // 定义起始和终止姿态
 glm::quat startOrientation = glm::quat(glm::vec3(0.0f, 0.0f, 0.0f));                             // 初始姿态
 glm::quat endOrientation = glm::quat(glm::vec3(glm::radians(90.0f), glm::radians(45.0f), 0.0f)); // 终止姿态
 
-// 定义插值参数
-float interpolationFactor = 0.0f;
-bool isInterpolating = false;
-
-// 添加舞蹈状态变量
-bool isDancing = false;
-
 // 全局变量
 unsigned int texture1, texture2;
 
-// 回调函数声明
-void framebufferSizeCallback(GLFWwindow *window, int width, int height);
-void processInput(GLFWwindow *window);
-void mouseCallback(GLFWwindow *window, double xpos, double ypos);
-void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
-
-void danceMovement(float time)
-{
-    if (isDancing)
-    {
-        // 平移
-        modelPos.x = 5.0f * sin(1.5f * time);          // X轴移动
-        modelPos.y = -10.0f + 2.0f * sin(2.0f * time); // Y轴上下移动
-        modelPos.z = 5.0f * cos(1.5f * time);          // Z轴移动
-
-        // 使用元数进行旋转
-        glm::quat rotationX = glm::angleAxis(0.5f * sin(2.0f * time), glm::vec3(1.0f, 0.0f, 0.0f)); // 绕X轴旋转
-        glm::quat rotationY = glm::angleAxis(0.5f * cos(2.0f * time), glm::vec3(0.0f, 1.0f, 0.0f)); // 绕Y轴旋转
-        glm::quat rotationZ = glm::angleAxis(0.5f * sin(1.0f * time), glm::vec3(0.0f, 0.0f, 1.0f)); // 绕Z轴旋转
-
-        // 组合旋转
-        modelRotation = rotationZ * rotationY * rotationX * modelRotation; // 更新模型旋转
-
-        // 缩放变化
-        modelScale = 0.6f + 0.1f * sin(1.0f * time); // 根据时间变化缩放
-    }
-}
 // 封装四元数旋转的函数
 glm::quat createQuaternionFromEuler(const glm::vec3 &eulerAngles)
 {
     return glm::quat(glm::vec3(eulerAngles)); // 根据欧拉角创建四元数
 }
 
-void loadTextures()
+// 包围盒调试线框的顶点，每帧写入流式顶点缓冲
+struct LineVertex
+{
+    glm::vec3 position;
+    glm::vec3 color;
+};
+const unsigned int BOX_VERTICES = 24;
+
+// 包围球外接立方体的 12 条边
+void writeBoundsBox(LineVertex *out, const glm::vec3 &center, float radius, const glm::vec3 &color)
+{
+    static const int edges[12][2] = {{0, 1}, {1, 3}, {3, 2}, {2, 0}, {4, 5}, {5, 7}, {7, 6}, {6, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    for (int e = 0; e < 12; e++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            int corner = edges[e][k];
+            glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+            out[e * 2 + k].position = center + offset;
+            out[e * 2 + k].color = color;
+        }
+    }
+}
+
+void loadTextures(const std::string &path)
 {
     // 生成纹理
     glGenTextures(1, &texture1);
@@ -96,7 +100,7 @@ void loadTextures()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     // 加载图像，创建纹理并生成 mipmaps
     int width, height, nrChannels;
-    unsigned char *data = stbi_load("/Users/cp_cp/GitHub/OpenGL/resources/Skull.jpg", &width, &height, &nrChannels, 0);
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
     if (data)
     {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
@@ -109,38 +113,280 @@ void loadTextures()
     stbi_image_free(data);
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    // 初始化 GLFW
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "3D Model Viewer", nullptr, nullptr);
-    glfwMakeContextCurrent(window);
-
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    RenderOptions options;
+    if (!parseRenderOptions(argc, argv, options))
+        return 1;
+
+    // 无窗口模式：EGL surfaceless 上下文，绘制到离屏帧缓冲，不初始化 ImGui
+    GLFWwindow *window = nullptr;
+    HeadlessContext headless;
+    GLADloadproc loader = (GLADloadproc)glfwGetProcAddress;
+    if (options.headless)
+    {
+        if (!headless.create())
+            return 1;
+        loader = HeadlessContext::loader();
+    }
+    else
+    {
+        // 初始化 GLFW
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        window = glfwCreateWindow(WIDTH, HEIGHT, "3D Model Viewer", nullptr, nullptr);
+        glfwMakeContextCurrent(window);
+    }
 
-    // 设置 OpenGL 视口
-    glViewport(0, 0, WIDTH, HEIGHT);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-    glfwSetCursorPosCallback(window, mouseCallback);
-    glfwSetScrollCallback(window, scrollCallback);
+    if (!gladLoadGLLoader(loader))
+    {
+        std::cerr << "ERROR::GL::LOAD_FAILED" << std::endl;
+        return 1;
+    }
+    StreamBuffer::loadExtensions(loader);
+    ProgramCache::loadExtensions(loader);
+    ProgramCache::setDirectory(options.shaderCache);
+    ShaderManager::loadExtensions(loader);
+
+    int width = options.width, height = options.height;
+    Framebuffer offscreen;
+    if (options.headless)
+    {
+        if (!offscreen.create(width, height))
+            return 1;
+        offscreen.bind();
+    }
+    else
+    {
+        // 设置 OpenGL 视口
+        glViewport(0, 0, WIDTH, HEIGHT);
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+        glfwSetCursorPosCallback(window, mouseCallback);
+        glfwSetScrollCallback(window, scrollCallback);
 
-    // 获取当前帧缓冲区大小
-    int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
+        // 获取当前帧缓冲区大小
+        glfwGetFramebufferSize(window, &width, &height);
 
-    // 手动调用回调函数
-    framebufferSizeCallback(window, width, height);
+        // 手动调用回调函数
+        framebufferSizeCallback(window, width, height);
+    }
+    if (!options.trace.empty())
+        Trace::setEnabled(true);
 
     // 启用深度测试
     glEnable(GL_DEPTH_TEST);
 
-    // Model model("/Users/cp_cp/GitHub/OpenGL/resources/model.obj");
-    Model model("/Users/cp_cp/GitHub/OpenGL/resources/12140_Skull_v3_L2.obj");
+    // 主着色器在加载模型之前发起异步编译，编译完成前用只有漫反射的备用着色器绘制。
+    // 驱动没有 parallel_shader_compile 时在共享上下文的后台线程里编译
+    ShaderManager shaders;
+    GLFWwindow *compileWindow = nullptr;
+    HeadlessContext compileContext;
+    ShaderManager::WorkerContext compileWorker;
+    if (!ShaderManager::hasParallelCompile())
+    {
+        if (window)
+        {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            compileWindow = glfwCreateWindow(1, 1, "Shader compiler", nullptr, window);
+            if (compileWindow)
+            {
+                compileWorker.bind = [compileWindow]()
+                { glfwMakeContextCurrent(compileWindow); };
+                compileWorker.unbind = []()
+                { glfwMakeContextCurrent(nullptr); };
+            }
+        }
+        else if (compileContext.createShared(headless))
+        {
+            compileWorker.bind = [&compileContext]()
+            { compileContext.makeCurrent(); };
+            compileWorker.unbind = []()
+            { HeadlessContext::releaseCurrent(); };
+        }
+    }
+    shaders.create(compileWorker);
+    // 交互运行时监视着色器源文件（含 #include 的文件），保存后在后台重新编译并在帧间替换
+    FileWatcher shaderWatcher;
+    if (window && shaderWatcher.create())
+        shaders.setWatcher(&shaderWatcher);
+    // 程序就绪时绑定 uniform block 和纹理单元，之后绘制不再设置任何 uniform
+    auto bindBlocks = [](GLuint program)
+    {
+        Shader target(program);
+        target.bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+        target.bindUniformBlock("Object", OBJECT_BLOCK_BINDING);
+        target.bindUniformBlock("Bones", BONE_BLOCK_BINDING);
+        target.bindUniformBlock("Shadows", SHADOW_BLOCK_BINDING);
+        target.use();
+        target.setInt("texture_diffuse1", DIFFUSE_TEXTURE_UNIT);
+        target.setInt("texture_normal1", NORMAL_TEXTURE_UNIT);
+        target.setInt("shadowMap", SHADOW_TEXTURE_UNIT);
+        target.bindUniformBlock("Clusters", CLUSTER_BLOCK_BINDING);
+        target.setInt("lightData", LIGHT_TEXTURE_UNIT);
+        target.setInt("clusterCells", CLUSTER_TEXTURE_UNIT);
+        target.setInt("lightIndices", LIGHT_INDEX_TEXTURE_UNIT);
+        target.setInt("gAlbedoRoughness", GBUFFER_TEXTURE_UNIT);
+        target.setInt("gNormal", GBUFFER_TEXTURE_UNIT + 1);
+        target.setInt("gDepth", GBUFFER_TEXTURE_UNIT + 2);
+        target.setInt("overdrawCount", OVERDRAW_TEXTURE_UNIT);
+        target.bindUniformBlock("Occlusion", OCCLUSION_BLOCK_BINDING);
+        target.setInt("occlusionResult", OCCLUSION_TEXTURE_UNIT);
+        target.setInt("occlusionDepth", OCCLUSION_DEPTH_TEXTURE_UNIT);
+        target.setInt("occlusionHistory", OCCLUSION_HISTORY_TEXTURE_UNIT);
+        target.bindUniformBlock("PostProcess", POST_PROCESS_BLOCK_BINDING);
+        target.setInt("postSource", POST_SOURCE_TEXTURE_UNIT);
+        target.setInt("postBloom", POST_BLOOM_TEXTURE_UNIT);
+        target.setInt("postExposure", POST_EXPOSURE_TEXTURE_UNIT);
+        glUseProgram(0);
+    };
+    // 着色器和资源目录可由命令行指定，默认指向源码树
+    const std::string shaderDir = options.shaderDir + "/";
+    Shader fallbackShader((shaderDir + "vertex.glsl").c_str(), (shaderDir + "fallback_fragment.glsl").c_str());
+    bindBlocks(fallbackShader.ID);
+    // 主着色器按特性组合生成变体，第一次用到时编译；无特性的基础变体先发起，平面和无贴图模型都用它
+    ShaderVariants variants(shaders, shaderDir + "vertex.glsl",
+                            shaderDir + "fragment.glsl", bindBlocks, fallbackShader.ID);
+    variants.prepare(0);
+    // 阴影通道只写深度，变体只区分是否蒙皮
+    ShaderVariants depthVariants(shaders, shaderDir + "shadow_vertex.glsl",
+                                 shaderDir + "shadow_fragment.glsl", bindBlocks, 0);
+    depthVariants.prepare(0);
+    // 延迟着色：几何通道沿用主顶点着色器，只写 G-buffer；光照通道是一个全屏三角形，变体区分阴影和点光源
+    ShaderVariants gbufferVariants(shaders, shaderDir + "vertex.glsl",
+                                   shaderDir + "gbuffer_fragment.glsl", bindBlocks, 0);
+    ShaderVariants deferredVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                    shaderDir + "deferred_fragment.glsl", bindBlocks, 0);
+    // 重叠绘制热图：计数通道与深度预通道共用只有位置的顶点流
+    ShaderVariants overdrawVariants(shaders, shaderDir + "shadow_vertex.glsl",
+                                    shaderDir + "overdraw_fragment.glsl", bindBlocks, 0);
+    // SSAO 的遮蔽 + 时间累积通道，只有一个变体
+    ShaderVariants occlusionVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                     shaderDir + "ssao_fragment.glsl", bindBlocks, 0);
+    // HDR 后处理的各个通道，每个只有一个变体
+    ShaderVariants histogramVariants(shaders, shaderDir + "luminance_histogram_vertex.glsl",
+                                     shaderDir + "luminance_histogram_fragment.glsl", bindBlocks, 0);
+    ShaderVariants exposureVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                    shaderDir + "exposure_fragment.glsl", bindBlocks, 0);
+    ShaderVariants bloomPrefilterVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                          shaderDir + "bloom_prefilter_fragment.glsl", bindBlocks, 0);
+    ShaderVariants bloomDownsampleVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                           shaderDir + "bloom_downsample_fragment.glsl", bindBlocks, 0);
+    ShaderVariants bloomUpsampleVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                         shaderDir + "bloom_upsample_fragment.glsl", bindBlocks, 0);
+    ShaderVariants tonemapVariants(shaders, shaderDir + "deferred_vertex.glsl",
+                                   shaderDir + "tonemap_fragment.glsl", bindBlocks, 0);
 
-    Shader shader("/Users/cp_cp/GitHub/OpenGL/shaders/vertex.glsl", "/Users/cp_cp/GitHub/OpenGL/shaders/fragment.glsl");
+    // Model model("/Users/cp_cp/GitHub/OpenGL/resources/model.obj");
+    // 模型持有 GL 对象（glTF 的缓冲、贴图和 VAO），清理时在销毁上下文之前释放
+    std::unique_ptr<Model> ownedModel(new Model(options.model.empty() ? options.resourceDir + "/12140_Skull_v3_L2.obj" : options.model));
+    Model &model = *ownedModel;
+
+    Shader lineShader((shaderDir + "line_vertex.glsl").c_str(), (shaderDir + "line_fragment.glsl").c_str());
+    lineShader.bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+
+    // 每帧数据的流式缓冲：uniform block 内容（相机、光源、每次绘制的变换）和动态几何
+    StreamBuffer uniformStream, geometryStream;
+    uniformStream.create(GL_UNIFORM_BUFFER, 1 << 20);
+    // 几何流还要容纳 CPU 蒙皮后的顶点（每个 24 字节）
+    geometryStream.create(GL_ARRAY_BUFFER, 8 << 20);
+    bool showBounds = false;
+
+    // Bones block 的默认内容（单位矩阵），保证静态网格绘制时该 block 也绑定了缓冲
+    unsigned int boneFallbackUBO;
+    {
+        BoneUniforms identity;
+        for (glm::mat4 &bone : identity.bones)
+            bone = glm::mat4(1.0f);
+        glGenBuffers(1, &boneFallbackUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, boneFallbackUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(identity), &identity, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BONE_BLOCK_BINDING, boneFallbackUBO);
+    }
+    int skinningPath = static_cast<int>(SkinningPath::Gpu);
+
+    // 级联阴影：平行光，阴影距离以内按相机视锥切分；模拟线程计算级联并剔除投射体
+    const int SHADOW_RESOLUTION = 2048;
+    const float SHADOW_DISTANCE = 40.0f;
+    ShadowMap shadowMap;
+    bool shadowsEnabled = shadowMap.create(SHADOW_RESOLUTION, ShadowCascades::MAX_CASCADES);
+    int shadowCascadeCount = 3;
+    int shadowPcfRadius = 1;
+    float shadowNormalOffset = 1.5f;
+    const char *SHADOW_SCOPES[ShadowCascades::MAX_CASCADES] = {"Cascade 0", "Cascade 1", "Cascade 2", "Cascade 3"};
+
+    // 分簇光照：光源数据每帧上传到缓冲纹理，主着色器开启 Lights 特性
+    LightBuffers lightBuffers;
+    lightBuffers.create();
+    const int MAX_SCENE_LIGHTS = 1024;
+    int lightCount = std::min(options.lights, MAX_SCENE_LIGHTS);
+
+    // 渲染路径：前向每个片段都遍历所在簇的光源；延迟先写 G-buffer，光照只对最终可见的像素算一次
+    // G-buffer 在第一次使用和视口尺寸变化时（重新）创建
+    const char *RENDERERS[] = {"Forward", "Deferred"};
+    int renderer = options.deferred ? 1 : 0;
+    GBuffer gbuffer;
+    unsigned int fullscreenVAO; // 全屏三角形由 gl_VertexID 生成，核心模式下仍需绑定一个 VAO
+    glGenVertexArrays(1, &fullscreenVAO);
+
+    // 深度预通道（前向路径）：先只写深度，颜色通道用 GL_EQUAL，每个可见像素只着色一次
+    // Auto 按 OverdrawMonitor 测得的平均着色次数决定；热图把颜色通道换成计数，显示每像素着色了几次
+    const char *PREPASS_MODES[] = {"Off", "On", "Auto"};
+    int prepassMode = options.prepass == "off" ? 0 : options.prepass == "on" ? 1 : 2;
+    OverdrawMonitor overdrawMonitor;
+    overdrawMonitor.create();
+    bool showOverdraw = false;
+    Shader heatMapShader((shaderDir + "deferred_vertex.glsl").c_str(),
+                         (shaderDir + "overdraw_heatmap_fragment.glsl").c_str());
+    bindBlocks(heatMapShader.ID);
+
+    // 环境光遮蔽：低分辨率计算，时间累积，着色时双边上采样；两条渲染路径都用
+    const char *OCCLUSION_RESOLUTIONS[] = {"Off", "Half", "Quarter"};
+    int occlusionResolution = options.ssao == "off" ? 0 : options.ssao == "half" ? 1 : 2;
+    int occlusionSamples = 8;
+    float occlusionRadius = 0.5f;
+    bool occlusionTemporal = true;
+    SSAO ssao;
+    glm::mat4 previousViewProjection(1.0f);
+    unsigned int occlusionFrame = 0;
+
+    // HDR 后处理：场景画进浮点目标，测光、泛光、ACES 色调映射后写回输出帧缓冲
+    // 帧内的中间目标（场景、泛光金字塔、直方图、重叠绘制计数）都向 renderTargets 借，用完归还，下一帧原样复用
+    RenderTargetPool renderTargets;
+    PostProcess postProcess;
+    bool postProcessAvailable = postProcess.create();
+    bool postProcessing = options.postProcess && postProcessAvailable;
+    bool bloomEnabled = true;
+    int bloomLevels = 6;
+    float bloomThreshold = 1.0f, bloomKnee = 0.5f, bloomIntensity = 0.6f, bloomRadius = 1.0f;
+    bool autoExposure = true;
+    float exposureCompensation = 0.0f, manualExposure = 1.0f, adaptationSpeed = 1.5f;
+
+    // 帧分析器：主线程各阶段的 CPU/GPU 耗时，同时作为跟踪的事件来源
+    Trace::setThreadName("render");
+    Profiler profiler;
+    profiler.create();
+
+    // 图像序列导出：PBO 环异步读回，写线程编码；无窗口模式不丢帧
+    FrameCapture capture;
+    FrameCapture::Format captureFormat = options.captureFormat == "ppm" ? FrameCapture::Format::PPM : FrameCapture::Format::PNG;
+    std::string captureDirectory = options.capture.empty() ? "capture" : options.capture;
+    if (!options.capture.empty())
+        capture.start(width, height, captureDirectory, captureFormat, options.headless);
+
+    // 调试线框 VAO 直接指向流式顶点缓冲，绘制时用 first 选择本帧写入的位置
+    unsigned int lineVAO;
+    glGenVertexArrays(1, &lineVAO);
+    glBindVertexArray(lineVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, geometryStream.id());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void *)offsetof(LineVertex, color));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
 
     float planeVertices[] = {
         // 位置          // 法线
@@ -186,8 +432,11 @@ int main()
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO();
     (void)io;
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330");
+    if (window)
+    {
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 330");
+    }
 
     // 设置 ImGui 样式
     ImGui::StyleColorsClassic();
@@ -207,244 +456,826 @@ int main()
     style.Colors[ImGuiCol_ButtonHovered] = ImVec4(0.5f, 0.5f, 0.5f, 1.0f); // 悬停按钮背景色
     style.Colors[ImGuiCol_ButtonActive] = ImVec4(0.6f, 0.6f, 0.6f, 1.0f);  // 激活按钮背景色
 
+    // 场景：目前只有一个模型实体
+    Scene scene;
+    Entity modelEntity = scene.create();
+    Transform &modelTransform = scene.transforms.add(modelEntity);
+    modelTransform.position = DEFAULT_MODEL_POS;
+    modelTransform.scale = DEFAULT_MODEL_SCALE;
+    MeshRef &modelRef = scene.meshes.add(modelEntity);
+    modelRef.model = &model;
+    modelRef.localCenter = model.boundsCenter();
+    modelRef.localRadius = model.boundsRadius();
+    scene.materials.add(modelEntity).color = glm::vec3(1.0f, 0.9f, 0.9f);
+    scene.animations.add(modelEntity);
+    scene.bounds.add(modelEntity);
+    // 在平面上方游走的点光源，参数由编号决定，增减数量时已有的光源不变
+    std::vector<Entity> lightEntities;
+    auto setLightCount = [](Scene &scene, std::vector<Entity> &entities, int count)
+    {
+        while ((int)entities.size() > count)
+        {
+            scene.destroy(entities.back());
+            entities.pop_back();
+        }
+        while ((int)entities.size() < count)
+        {
+            std::mt19937 random(static_cast<unsigned int>(entities.size()) * 7919u + 1u);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            Entity entity = scene.create();
+            scene.transforms.add(entity);
+            PointLight &light = scene.lights.add(entity);
+            light.origin = glm::vec3(unit(random) * 80.0f - 40.0f, -8.5f + unit(random) * 2.0f, unit(random) * 80.0f - 40.0f);
+            light.orbit = 2.0f + unit(random) * 6.0f;
+            light.speed = (0.3f + unit(random)) * (unit(random) < 0.5f ? -1.0f : 1.0f);
+            light.phase = unit(random) * 6.2831853f;
+            light.radius = 6.0f + unit(random) * 6.0f;
+            light.intensity = 6.0f;
+            // 饱和的随机色相
+            float hue = unit(random) * 6.0f;
+            light.color = glm::clamp(glm::vec3(std::fabs(hue - 3.0f) - 1.0f, 2.0f - std::fabs(hue - 2.0f), 2.0f - std::fabs(hue - 4.0f)),
+                                     0.0f, 1.0f);
+            entities.push_back(entity);
+        }
+    };
+    setLightCount(scene, lightEntities, lightCount);
+    if (options.hasCamera && options.cameraTarget != options.cameraPosition)
+    {
+        scene.camera.position = options.cameraPosition;
+        scene.camera.front = glm::normalize(options.cameraTarget - options.cameraPosition);
+    }
+
+    // 任务系统
+    JobSystem jobs;
+    FrameJobs frameJobs(jobs);
+    std::vector<float> utilization;
+    float lastUtilizationSample = 0.0f;
+
+    // 输入和动画以固定 60Hz 步进，渲染在最近两步之间插值
+    FixedTimestep timestep(1.0 / 60.0);
+    Camera previousCamera = scene.camera;
+    scene.storePrevious();
+
+    // 模拟线程：输入 -> 相机 -> 场景任务图，产出只读快照；主线程只负责采集输入和 GL 绘制
+    // 无窗口模式不开流水线，第 N 帧画的就是第 N 帧的模拟结果
+    FramePipeline pipeline([&](const FrameInput &frame, FrameSnapshot &snapshot)
+                           {
+        timestep.accumulate(frame.deltaTime);
+        while (timestep.step())
+        {
+            frameJobs.update(scene, (float)timestep.time(), (float)timestep.delta(), [&]()
+                             {
+                previousCamera = scene.camera;
+                applyInput(frame.input, scene, modelEntity); });
+        }
+        float alpha = timestep.alpha();
+        Camera camera = scene.camera;
+        camera.position = glm::mix(previousCamera.position, camera.position, alpha);
+        camera.front = glm::mix(previousCamera.front, camera.front, alpha);
+        snapshot.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+        snapshot.projection = glm::perspective(glm::radians(45.0f), frame.aspect, 0.1f, 100.0f);
+        // 场景系统以任务图并行执行：插值变换 -> 包围球/剔除 -> 生成绘制包
+        // 光源按朝向原点的平行光处理
+        snapshot.shadows = ShadowCascades();
+        if (frame.shadowCascades > 0)
+            snapshot.shadows = ShadowCascades::compute(snapshot.view, snapshot.projection, -scene.lightPos, frame.shadowCascades,
+                                                       SHADOW_DISTANCE, SHADOW_RESOLUTION);
+        frameJobs.build(scene, alpha, snapshot.projection * snapshot.view, snapshot.packets,
+                        snapshot.shadows.count ? &snapshot.shadows : nullptr, &snapshot.lights);
+        auto clusterStart = std::chrono::steady_clock::now();
+        snapshot.clusters.assign(snapshot.view, snapshot.projection, snapshot.lights);
+        snapshot.clusterMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - clusterStart).count();
+        snapshot.time = (float)(timestep.time() - (1.0f - alpha) * timestep.delta());
+        snapshot.simulationSteps = timestep.steps();
+        snapshot.alpha = alpha;
+        snapshot.camera = camera;
+        snapshot.lightPos = scene.lightPos;
+        snapshot.selected = scene.transforms.get(modelEntity); }, !options.headless);
+    bool pipelined = pipeline.isThreaded();
+
     // 定义前后位置变量
     glm::vec3 newPosition(0.0f, 0.0f, 0.0f);
     glm::vec3 newRotation(0.0f, 0.0f, 0.0f);
-    glm::vec3 startPosition = modelPos;      // 初始位置
-    glm::vec3 startRotation = modelRotation; // 初始旋转
-    float interpolationFactor = 0.0f;        // 插值因子
-    bool isInterpolating = false;            // 是否正在插值
 
     // 加载纹理
-    loadTextures();
+    loadTextures(options.resourceDir + "/Skull.jpg");
+
+    // 提前请求模型用到的变体；无窗口模式的输出不能用备用着色器，等它们全部就绪
+    // 光照相关的特性（阴影、点光源、环境光遮蔽）按每一种组合准备
+    std::vector<uint32_t> lightingCombinations;
+    for (uint32_t bits = 0; bits < 8; bits++)
+        lightingCombinations.push_back((bits & 1 ? ShaderFeature::Shadows : 0) | (bits & 2 ? ShaderFeature::Lights : 0) |
+                                       (bits & 4 ? ShaderFeature::AmbientOcclusion : 0));
+    for (uint32_t features : lightingCombinations)
+    {
+        model.prepareShaders(variants, features);
+        variants.prepare(features);
+    }
+    model.prepareShaders(depthVariants, 0, true);
+    if (renderer == 1)
+    {
+        model.prepareShaders(gbufferVariants, 0);
+        gbufferVariants.prepare(0);
+        for (uint32_t features : lightingCombinations)
+            deferredVariants.prepare(features);
+    }
+    if (occlusionResolution != 0)
+        occlusionVariants.prepare(0);
+    if (postProcessing)
+    {
+        for (ShaderVariants *post : {&histogramVariants, &exposureVariants, &bloomPrefilterVariants, &bloomDownsampleVariants,
+                                     &bloomUpsampleVariants, &tonemapVariants})
+            post->prepare(0);
+    }
+    while (!window && shaders.pending() > 0)
+    {
+        shaders.poll();
+        std::this_thread::yield();
+    }
 
-    // 渲染循环
-    while (!glfwWindowShouldClose(window))
+    // 渲染循环；无窗口模式渲染固定帧数，时间按 1/60 秒推进，结果与实际帧率无关
+    int frameIndex = 0;
+    while (window ? !glfwWindowShouldClose(window) : frameIndex < options.frames)
     {
         // 每帧刷新逻辑
-        float currentFrame = glfwGetTime();
+        float currentFrame = window ? (float)glfwGetTime() : frameIndex / 60.0f;
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        profiler.beginFrame();
+        int frameScope = profiler.beginScope("Frame", true);
+        shaders.poll();
+
+        // 输入在主线程采集，交给模拟线程；拿到上一帧的快照来绘制
+        FrameInput input;
+        if (window)
+            input.input = pollInput(window);
+        input.time = currentFrame;
+        input.deltaTime = deltaTime;
+        input.aspect = window ? (float)WIDTH / HEIGHT : (float)width / height;
+        input.shadowCascades = shadowsEnabled ? shadowCascadeCount : 0;
+        int waitScope = profiler.beginScope("Simulation");
+        const FrameSnapshot &frame = pipeline.beginFrame(input);
+        profiler.endScope(waitScope);
+        {
+            ProfileScope scope(profiler, "Stream sync");
+            uniformStream.beginFrame();
+            geometryStream.beginFrame();
+        }
 
-        // 输入处理
-        processInput(window);
+        // 场景画进后处理的 HDR 目标；重叠绘制热图显示的是计数，不经过色调映射
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        bool hdr = postProcessing && !(renderer == 0 && showOverdraw) && postProcess.beginScene(renderTargets, viewport[2], viewport[3]);
 
         // 设置为灰色
         glClearColor(0.9f, 0.9f, 0.9f, 0.9f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 使用着色器
-        shader.use();
-        shader.setBool("useObjectColor", true);
+        // 设置光源属性
+        const Camera &camera = frame.camera;
+        FrameUniforms frameUniforms;
+        frameUniforms.view = frame.view;                         // 视图矩阵
+        frameUniforms.projection = frame.projection;             // 投影矩阵
+        frameUniforms.lightPos = glm::vec4(frame.lightPos, 1.0f); // 光源位置
+        frameUniforms.viewPos = glm::vec4(camera.position, 1.0f); // 观察者位置
+        frameUniforms.lightColor = glm::vec4(1.0f);               // 光源颜色
+        frameUniforms.inverseViewProjection = glm::inverse(frame.projection * frame.view);
+
+        // 界面只在有窗口时构建
+        if (window)
+        {
+            // 启动新的 ImGui 帧
+            int uiScope = profiler.beginScope("UI build");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+            // 创建一个窗口并固定位置
+            ImGui::SetNextWindowPos(ImVec2(0, height * 0.3), ImGuiCond_Always);                                                         // 固定窗口位置
+            ImGui::SetNextWindowSize(ImVec2(width, height * 0.2), ImGuiCond_Always);                                                    // 设置窗口大小
+            ImGui::Begin("Position Input", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse); // 禁用移动、调整大小和折叠
+
+            const Transform &selected = frame.selected;
+            ImGui::InputFloat3("New Position", &newPosition[0]); // 输入新的位置
+            ImGui::Text("Model Position: (%.2f, %.2f, %.2f)", selected.position.x, selected.position.y, selected.position.z);
+            ImGui::InputFloat3("New Rotation", &newRotation[0]); // 输入新的旋转
+            ImGui::Text("Model Front Direction: (%.2f, %.2f, %.2f)", selected.rotation.x, selected.rotation.y, selected.rotation.z);
+
+            // 计算按钮宽度并居中
+            float buttonWidth = 100.0f;                                           // 按钮宽度
+            ImGui::SetCursorPosX((ImGui::GetWindowWidth() - buttonWidth) * 0.2f); // 设置光标位置为窗口中心
+            if (ImGui::Button("Apply", ImVec2(buttonWidth, 0)))                   // 创建按钮
+            {
+                // 开始插值，场景归模拟线程所有，交给它在下一帧执行
+                pipeline.post([&scene, modelEntity, newPosition, newRotation]()
+                              {
+                    Transform &transform = scene.transforms.get(modelEntity);
+                    Animation &animation = scene.animations.get(modelEntity);
+                    animation.startPosition = transform.position; // 设置起始位置
+                    animation.startRotation = transform.rotation; // 设置起始旋转
+                    animation.targetPosition = newPosition;
+                    animation.targetRotation = newRotation;
+                    animation.factor = 0.0f;         // 重置插值因子
+                    animation.interpolating = true; // 开始插值
+                });
+            }
+            ImGui::End();
+
+            // 任务线程利用率，每半秒采样一次
+            if (currentFrame - lastUtilizationSample > 0.5f)
+            {
+                utilization = jobs.sampleUtilization();
+                lastUtilizationSample = currentFrame;
+            }
+            ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Jobs", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Checkbox("Pipelined simulation", &pipelined);
+            ImGui::Text("Frame %llu, render waited %.1f ms total", (unsigned long long)frame.frame, pipeline.waitMs());
+            ImGui::Text("Fixed steps this frame: %d, alpha %.2f", frame.simulationSteps, frame.alpha);
+            for (size_t i = 0; i < utilization.size(); i++)
+            {
+                char label[32];
+                snprintf(label, sizeof(label), "%s %zu: %.0f%%", i == 0 ? "sim" : "worker", i, utilization[i] * 100.0f);
+                ImGui::ProgressBar(utilization[i], ImVec2(200, 0), label);
+            }
+            ImGui::End();
+
+            // 流式缓冲统计：stall 表示 CPU 轮回到某段时 GPU 还没读完
+            ImGui::SetNextWindowPos(ImVec2(0, height * 0.55f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Streaming", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Text("Persistent mapping: %s", StreamBuffer::hasBufferStorage() ? "yes" : "no (unsynchronized map)");
+            const StreamBuffer *streams[] = {&uniformStream, &geometryStream};
+            const char *streamNames[] = {"uniforms", "geometry"};
+            for (int i = 0; i < 2; i++)
+            {
+                const StreamBuffer::Stats &stats = streams[i]->stats();
+                ImGui::Text("%-8s peak %6.1f KB  stalls %llu (%.2f ms)  overflows %llu", streamNames[i], stats.peakBytes / 1024.0,
+                            (unsigned long long)stats.stalls, stats.stallMs, (unsigned long long)stats.overflows);
+            }
+            const char *shaderModes[] = {"parallel_shader_compile", "worker thread", "synchronous"};
+            ImGui::Text("Shaders: %s, %zu pending, program cache %s", shaderModes[static_cast<int>(shaders.mode())], shaders.pending(),
+                        ProgramCache::isEnabled() ? "on" : "off");
+            ImGui::Text("Variants: %zu of %zu ready", variants.readyCount(), variants.size());
+            if (shaderWatcher.isActive())
+                ImGui::Text("Hot reload (%s): %llu reloaded, %llu failed", shaderWatcher.isNative() ? "inotify" : "polling",
+                            (unsigned long long)shaders.stats().reloaded, (unsigned long long)shaders.stats().reloadFailed);
+            ImGui::Checkbox("Show bounds", &showBounds);
+            bool capturing = capture.isActive();
+            if (ImGui::Checkbox("Capture frames", &capturing))
+            {
+                if (capturing)
+                    capture.start(width, height, captureDirectory, captureFormat);
+                else
+                    capture.stop();
+            }
+            FrameCapture::Stats captureStats = capture.stats();
+            if (captureStats.requested)
+                ImGui::Text("written %llu  dropped %llu (gpu %llu, queue %llu)  %.1f fps  %.1f MB/s",
+                            (unsigned long long)captureStats.written, (unsigned long long)captureStats.dropped(),
+                            (unsigned long long)captureStats.droppedGpu, (unsigned long long)captureStats.droppedQueue,
+                            captureStats.framesPerSecond(), captureStats.megabytesPerSecond());
+            // CPU 蒙皮写入几何流；不支持 AVX2 时该选项退回标量实现
+            if (model.isSkinned())
+            {
+                const char *paths[] = {skinningPathName(SkinningPath::Gpu), skinningPathName(SkinningPath::CpuScalar),
+                                       cpuSupportsAvx2() ? skinningPathName(SkinningPath::CpuAvx2) : "CPU AVX2 (unsupported)"};
+                if (ImGui::Combo("Skinning", &skinningPath, paths, 3))
+                    model.setSkinningPath(static_cast<SkinningPath>(skinningPath));
+            }
+            ImGui::End();
+
+            // 分析器面板显示的是两帧前 GPU 结果就绪的数据
+            ImGui::SetNextWindowPos(ImVec2(width * 0.55f, 0), ImGuiCond_FirstUseEver);
+            profiler.drawWindow();
+
+            // 阴影：各级联的投射体数量和 GPU 耗时
+            ImGui::SetNextWindowPos(ImVec2(width * 0.55f, height * 0.55f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Shadows", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            if (shadowMap.texture())
+                ImGui::Checkbox("Enabled", &shadowsEnabled);
+            else
+                ImGui::Text("Shadow map unavailable");
+            ImGui::SliderInt("Cascades", &shadowCascadeCount, 1, ShadowCascades::MAX_CASCADES);
+            ImGui::SliderInt("PCF radius", &shadowPcfRadius, 0, 3);
+            ImGui::SliderFloat("Normal offset", &shadowNormalOffset, 0.0f, 4.0f);
+            for (int c = 0; c < frame.shadows.count; c++)
+            {
+                int casters = 0;
+                for (const DrawPacket &packet : frame.packets)
+                    casters += (packet.shadowMask >> c) & 1;
+                Profiler::Stats cpuStats, gpuStats;
+                std::string path = std::string("Frame/Shadows/") + SHADOW_SCOPES[c];
+                if (profiler.stats(path, cpuStats, gpuStats))
+                    ImGui::Text("%s: split %5.1f  casters %3d  gpu %.3f ms (p99 %.3f)", SHADOW_SCOPES[c], frame.shadows.splits[c], casters,
+                                gpuStats.avg, gpuStats.p99);
+                else
+                    ImGui::Text("%s: split %5.1f  casters %3d", SHADOW_SCOPES[c], frame.shadows.splits[c], casters);
+            }
+            ImGui::End();
+
+            // 分簇光照：分配结果统计，着色耗时见分析器的 Models/Plane
+            ImGui::SetNextWindowPos(ImVec2(width * 0.55f, height * 0.8f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Lights", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            if (ImGui::SliderInt("Point lights", &lightCount, 0, MAX_SCENE_LIGHTS))
+                pipeline.post([&scene, &lightEntities, setLightCount, lightCount]()
+                              { setLightCount(scene, lightEntities, lightCount); });
+            const LightClusters::Stats &clusterStats = frame.clusters.stats();
+            ImGui::Text("Grid %dx%dx%d, %zu lights in range", LightClusters::TILES_X, LightClusters::TILES_Y, LightClusters::SLICES,
+                        clusterStats.lights);
+            ImGui::Text("%zu of %d clusters lit, %zu references, max %u per cluster", clusterStats.occupied, LightClusters::COUNT,
+                        clusterStats.references, clusterStats.maxPerCluster);
+            ImGui::Text("Assignment %.3f ms (simulation thread), upload %.1f KB", frame.clusterMs, lightBuffers.uploadedBytes() / 1024.0);
+            ImGui::Combo("Renderer", &renderer, RENDERERS, IM_ARRAYSIZE(RENDERERS));
+            if (renderer == 1 && gbuffer.width() > 0)
+                ImGui::Text("G-buffer %dx%d, %.1f MB", gbuffer.width(), gbuffer.height(),
+                            double(gbuffer.width()) * gbuffer.height() * GBuffer::BYTES_PER_PIXEL / (1024.0 * 1024.0));
+            ImGui::End();
+
+            // 深度预通道：模式、测得的重叠绘制和两个通道的 GPU 耗时
+            ImGui::SetNextWindowPos(ImVec2(width * 0.3f, height * 0.8f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Depth pre-pass", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Combo("Mode", &prepassMode, PREPASS_MODES, IM_ARRAYSIZE(PREPASS_MODES));
+            ImGui::Checkbox("Overdraw heat map", &showOverdraw);
+            ImGui::Text("Overdraw %.2fx (%s), auto %s", overdrawMonitor.overdraw(), overdrawMonitor.isExact() ? "measured" : "screen estimate",
+                        overdrawMonitor.recommendPrepass() ? "on" : "off");
+            for (const char *path : {"Frame/Depth pre-pass", "Frame/Models", "Frame/Plane"})
+            {
+                Profiler::Stats cpuStats, gpuStats;
+                if (profiler.stats(path, cpuStats, gpuStats))
+                    ImGui::Text("%-20s gpu %.3f ms (p99 %.3f)", path + 6, gpuStats.avg, gpuStats.p99);
+            }
+            if (renderer == 1)
+                ImGui::Text("Deferred renderer: lighting is already once per pixel");
+            ImGui::End();
+
+            // 环境光遮蔽：分辨率、采样数和通道耗时（深度 + 遮蔽）
+            ImGui::SetNextWindowPos(ImVec2(width * 0.3f, height * 0.6f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Ambient occlusion", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Combo("Resolution", &occlusionResolution, OCCLUSION_RESOLUTIONS, IM_ARRAYSIZE(OCCLUSION_RESOLUTIONS));
+            ImGui::SliderInt("Samples", &occlusionSamples, 1, SSAO::MAX_SAMPLES);
+            ImGui::SliderFloat("Radius", &occlusionRadius, 0.05f, 2.0f);
+            ImGui::Checkbox("Temporal accumulation", &occlusionTemporal);
+            if (ssao.width() > 0)
+                ImGui::Text("%dx%d", ssao.width(), ssao.height());
+            for (const char *path : {"Frame/SSAO", "Frame/SSAO/Depth", "Frame/SSAO/Occlusion"})
+            {
+                Profiler::Stats cpuStats, gpuStats;
+                if (profiler.stats(path, cpuStats, gpuStats))
+                    ImGui::Text("%-16s gpu %.3f ms (p99 %.3f)", path + 6, gpuStats.avg, gpuStats.p99);
+            }
+            ImGui::End();
+
+            // 后处理：泛光和曝光参数、各通道耗时、渲染目标池的占用
+            ImGui::SetNextWindowPos(ImVec2(width * 0.3f, height * 0.35f), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Post-processing", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            if (postProcessAvailable)
+                ImGui::Checkbox("HDR", &postProcessing);
+            else
+                ImGui::Text("Post-processing unavailable");
+            ImGui::Checkbox("Bloom", &bloomEnabled);
+            ImGui::SliderInt("Levels", &bloomLevels, 1, PostProcess::MAX_BLOOM_LEVELS);
+            ImGui::SliderFloat("Threshold", &bloomThreshold, 0.0f, 4.0f);
+            ImGui::SliderFloat("Knee", &bloomKnee, 0.0f, 1.0f);
+            ImGui::SliderFloat("Intensity", &bloomIntensity, 0.0f, 2.0f);
+            ImGui::SliderFloat("Filter radius", &bloomRadius, 0.5f, 2.0f);
+            if (ImGui::Checkbox("Auto exposure", &autoExposure) && autoExposure)
+                postProcess.resetExposure();
+            if (autoExposure)
+                ImGui::SliderFloat("Adaptation speed", &adaptationSpeed, 0.1f, 10.0f);
+            else
+                ImGui::SliderFloat("Exposure", &manualExposure, 0.05f, 8.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Compensation (EV)", &exposureCompensation, -4.0f, 4.0f);
+            for (const char *path : {"Frame/Post", "Frame/Post/Exposure", "Frame/Post/Bloom", "Frame/Post/Tone map"})
+            {
+                Profiler::Stats cpuStats, gpuStats;
+                if (profiler.stats(path, cpuStats, gpuStats))
+                    ImGui::Text("%-14s gpu %.3f ms (p99 %.3f)", path + 6, gpuStats.avg, gpuStats.p99);
+            }
+            RenderTargetPool::Stats poolStats = renderTargets.stats();
+            ImGui::Text("Render targets: %zu (%zu in use), %.1f MB, created %llu, reused %llu", poolStats.targets, poolStats.inUse,
+                        poolStats.bytes / (1024.0 * 1024.0), (unsigned long long)poolStats.created, (unsigned long long)poolStats.reused);
+            ImGui::End();
+            profiler.endScope(uiScope);
+        }
+
+        // 姿态每帧每个模型只采样一次，阴影和主通道共用（CPU 蒙皮结果也随之复用）
+        std::vector<Model *> animated;
+        for (const DrawPacket &packet : frame.packets)
+        {
+            if (packet.model && std::find(animated.begin(), animated.end(), packet.model) == animated.end())
+            {
+                packet.model->animate(frame.time);
+                animated.push_back(packet.model);
+            }
+        }
 
-        // 绑定纹理
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        shader.setInt("texture1", 0);
+        // 阴影通道：每个级联只画包围球与它相交的投射体，网格再按各自的包围球剔除一次
+        bool drawShadows = frame.shadows.count > 0 && shadowMap.texture();
+        if (drawShadows)
+        {
+            int shadowScope = profiler.beginScope("Shadows", true);
+            shadowMap.beginPass();
+            for (int c = 0; c < frame.shadows.count; c++)
+            {
+                int cascadeScope = profiler.beginScope(SHADOW_SCOPES[c], true);
+                shadowMap.bindCascade(c);
+                FrameUniforms lightUniforms = frameUniforms;
+                lightUniforms.view = frame.shadows.view[c];
+                lightUniforms.projection = frame.shadows.projection[c];
+                uniformStream.writeUniform(FRAME_BLOCK_BINDING, &lightUniforms, sizeof(lightUniforms));
+                Model::CasterTest casterTest = [&frame, c](const glm::vec3 &center, float radius)
+                { return frame.shadows.intersects(c, center, radius); };
+                for (const DrawPacket &packet : frame.packets)
+                {
+                    if (!packet.model || !(packet.shadowMask & (1u << c)))
+                        continue;
+                    packet.model->setTransform(packet.matrix);
+                    packet.model->drawDepth(depthVariants, &uniformStream, &geometryStream, casterTest);
+                }
+                profiler.endScope(cascadeScope);
+            }
+            shadowMap.endPass();
+            profiler.endScope(shadowScope);
 
-        // 设置光源属性
-        shader.setVec3("lightPos", lightPos.x, lightPos.y, lightPos.z);   // 光源位置
-        shader.setVec3("viewPos", cameraPos.x, cameraPos.y, cameraPos.z); // 观察者位置
-        shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);                   // 光源颜色
-        // shader.setVec3("objectColor", 1.0f, 0.9f, 0.9f);                  // 设置物体表面颜色为灰色
-
-        // 启动新的 ImGui 帧
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        // 创建一个窗口并固定位置
-        ImGui::SetNextWindowPos(ImVec2(0, height * 0.3), ImGuiCond_Always);                                                         // 固定窗口位置
-        ImGui::SetNextWindowSize(ImVec2(width, height * 0.2), ImGuiCond_Always);                                                    // 设置窗口大小
-        ImGui::Begin("Position Input", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse); // 禁用移动、调整大小和折叠
-
-        ImGui::InputFloat3("New Position", &newPosition[0]); // 输入新的位置
-        ImGui::Text("Model Position: (%.2f, %.2f, %.2f)", modelPos.x, modelPos.y, modelPos.z);
-        ImGui::InputFloat3("New Rotation", &newRotation[0]); // 输入新的旋转
-        ImGui::Text("Model Front Direction: (%.2f, %.2f, %.2f)", modelRotation.x, modelRotation.y, modelRotation.z);
-
-        // 计算按钮宽度并居中
-        float buttonWidth = 100.0f;                                           // 按钮宽度
-        ImGui::SetCursorPosX((ImGui::GetWindowWidth() - buttonWidth) * 0.2f); // 设置光标位置为窗口中心
-        if (ImGui::Button("Apply", ImVec2(buttonWidth, 0)))                   // 创建按钮
+            ShadowUniforms shadowUniforms;
+            for (int c = 0; c < ShadowCascades::MAX_CASCADES; c++)
+            {
+                bool used = c < frame.shadows.count;
+                shadowUniforms.lightViewProjection[c] = used ? frame.shadows.viewProjection(c) : glm::mat4(1.0f);
+                shadowUniforms.splits[c] = used ? frame.shadows.splits[c] : 0.0f;
+                // 正交投影宽 2r，对应 SHADOW_RESOLUTION 个纹素
+                shadowUniforms.texelSize[c] = used ? 2.0f * frame.shadows.extent[c] / SHADOW_RESOLUTION : 0.0f;
+            }
+            shadowUniforms.params = glm::vec4(frame.shadows.count, shadowNormalOffset, 1.0f / SHADOW_RESOLUTION, shadowPcfRadius);
+            uniformStream.writeUniform(SHADOW_BLOCK_BINDING, &shadowUniforms, sizeof(shadowUniforms));
+            glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap.texture());
+            glActiveTexture(GL_TEXTURE0);
+        }
+        uniformStream.writeUniform(FRAME_BLOCK_BINDING, &frameUniforms, sizeof(frameUniforms));
+        uint32_t lightingFeatures = drawShadows ? ShaderFeature::Shadows : 0;
+
+        // 环境光遮蔽：低分辨率深度 -> 遮蔽与时间累积，结果留在 OCCLUSION_TEXTURE_UNIT 供着色时上采样
+        int occlusionDivisor = occlusionResolution == 1 ? 2 : 4;
+        GLuint occlusionProgram = occlusionResolution != 0 ? occlusionVariants.program(0) : 0;
+        bool occlusion = occlusionProgram != 0;
+        if (occlusion && (ssao.fullWidth() != viewport[2] || ssao.fullHeight() != viewport[3] || ssao.divisor() != occlusionDivisor) &&
+            !ssao.create(viewport[2], viewport[3], occlusionDivisor))
+            occlusion = false, occlusionResolution = 0;
+        if (!occlusion)
+            ssao.resetHistory();
+        else
         {
-            // 开始插值
-            startPosition = modelPos;      // 设置起始位置
-            startRotation = modelRotation; // 设置起始旋转
-            interpolationFactor = 0.0f;    // 重置插值因子
-            isInterpolating = true;        // 开始插值
+            int occlusionScope = profiler.beginScope("SSAO", true);
+            int depthScope = profiler.beginScope("Depth", true);
+            ssao.beginDepth();
+            for (const DrawPacket &packet : frame.packets)
+            {
+                if (!packet.model || !packet.visible)
+                    continue;
+                packet.model->setTransform(packet.matrix);
+                packet.model->drawDepth(depthVariants, &uniformStream, &geometryStream);
+            }
+            glUseProgram(depthVariants.program(0));
+            ObjectUniforms planeDepth;
+            planeDepth.model = glm::mat4(1.0f);
+            if (uniformStream.writeUniform(OBJECT_BLOCK_BINDING, &planeDepth, sizeof(planeDepth)))
+            {
+                glBindVertexArray(planeVAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                glBindVertexArray(0);
+            }
+            ssao.endDepth();
+            profiler.endScope(depthScope);
+
+            int passScope = profiler.beginScope("Occlusion", true);
+            OcclusionUniforms occlusionUniforms;
+            occlusionUniforms.previousViewProjection = previousViewProjection;
+            // 累积权重 0.1 约等于平均最近 10 帧
+            float historyWeight = occlusionTemporal && ssao.hasHistory() ? 0.1f : 1.0f;
+            occlusionUniforms.params = glm::vec4(occlusionRadius, occlusionSamples, float(occlusionFrame++ % 64), historyWeight);
+            occlusionUniforms.target = glm::vec4(ssao.width(), ssao.height(), float(ssao.width()) / viewport[2], float(ssao.height()) / viewport[3]);
+            uniformStream.writeUniform(OCCLUSION_BLOCK_BINDING, &occlusionUniforms, sizeof(occlusionUniforms));
+            ssao.beginOcclusion();
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(occlusionProgram);
+            glBindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glEnable(GL_DEPTH_TEST);
+            ssao.endOcclusion();
+            profiler.endScope(passScope);
+            profiler.endScope(occlusionScope);
+            lightingFeatures |= ShaderFeature::AmbientOcclusion;
         }
-        ImGui::End();
+        previousViewProjection = frame.projection * frame.view;
 
-        float currentTime = glfwGetTime();
+        // 分簇光照：光源、簇表和下标列表整块上传
+        if (!frame.lights.empty())
+        {
+            ProfileScope scope(profiler, "Light upload");
+            lightBuffers.upload(frame.lights, frame.clusters);
+            lightBuffers.bind();
+            ClusterUniforms clusterUniforms;
+            clusterUniforms.grid = glm::vec4(LightClusters::TILES_X, LightClusters::TILES_Y, LightClusters::SLICES, frame.lights.size());
+            clusterUniforms.slices = glm::vec4(frame.clusters.sliceScale(), frame.clusters.sliceBias(), 0.0f, 0.0f);
+            clusterUniforms.screen = glm::vec4(float(LightClusters::TILES_X) / viewport[2], float(LightClusters::TILES_Y) / viewport[3], 0.0f, 0.0f);
+            uniformStream.writeUniform(CLUSTER_BLOCK_BINDING, &clusterUniforms, sizeof(clusterUniforms));
+            lightingFeatures |= ShaderFeature::Lights;
+        }
 
-        danceMovement(currentTime);
+        bool deferred = renderer == 1;
+        if (deferred && (gbuffer.width() != viewport[2] || gbuffer.height() != viewport[3]) && !gbuffer.create(viewport[2], viewport[3]))
+            renderer = 0, deferred = false;
 
-        if (isInterpolating)
+        ObjectUniforms planeObject;
+        planeObject.model = glm::mat4(1.0f);
+        planeObject.color = glm::vec4(1.0f, 0.9f, 0.9f, 1.0f);
+        if (deferred)
         {
-            interpolationFactor += deltaTime * 0.5f; // 控制插值速度
-            if (interpolationFactor > 1.0f)
+            // 几何通道：模型和平面只写材质与法线
+            int geometryScope = profiler.beginScope("G-buffer", true);
+            gbuffer.beginGeometry();
+            for (const DrawPacket &packet : frame.packets)
             {
-                interpolationFactor = 1.0f;
-                isInterpolating = false; // 停止插值
+                if (!packet.model || !packet.visible)
+                    continue;
+                packet.model->setColor(packet.color);
+                packet.model->setRoughness(packet.roughness);
+                packet.model->setTransform(packet.matrix);
+                packet.model->draw(gbufferVariants, &uniformStream, &geometryStream);
             }
-            modelPos = glm::mix(startPosition, newPosition, interpolationFactor);      // 使用线性插值
-            modelRotation = glm::mix(startRotation, newRotation, interpolationFactor); // 同时对旋转进行线性插值
+            glUseProgram(gbufferVariants.program(0));
+            if (uniformStream.writeUniform(OBJECT_BLOCK_BINDING, &planeObject, sizeof(planeObject)))
+            {
+                glBindVertexArray(planeVAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                glBindVertexArray(0);
+            }
+            gbuffer.endGeometry();
+            profiler.endScope(geometryScope);
+
+            // 光照通道：每个像素着色一次，深度原样写回默认帧缓冲
+            int lightingScope = profiler.beginScope("Lighting", true);
+            gbuffer.bindTextures();
+            glDepthFunc(GL_ALWAYS);
+            glUseProgram(deferredVariants.program(lightingFeatures));
+            glBindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glDepthFunc(GL_LESS);
+            profiler.endScope(lightingScope);
         }
+        else
+        {
+            overdrawMonitor.beginFrame((long long)viewport[2] * viewport[3]);
+            bool prepass = prepassMode == 1 || (prepassMode == 2 && overdrawMonitor.recommendPrepass());
+            // 热图：同样的通道画进单通道计数目标，颜色通道的每个片段加 1
+            GLint sceneFramebuffer = 0;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &sceneFramebuffer);
+            bool heatMap = showOverdraw;
+            const RenderTarget *overdrawTarget = heatMap ? renderTargets.acquire(viewport[2], viewport[3], GL_R8, true) : nullptr;
+            if (heatMap && !overdrawTarget)
+                heatMap = showOverdraw = false;
+            if (heatMap)
+            {
+                overdrawTarget->bind();
+                glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
 
-        // 更新模型矩阵
-        glm::mat4 modelMat = glm::mat4(1.0f);
-        modelMat = glm::translate(modelMat, modelPos);                                   // 应用平移
-        modelMat = glm::rotate(modelMat, modelRotation.x, glm::vec3(0.01f, 0.0f, 0.0f)); // 应用旋转
-        modelMat = glm::rotate(modelMat, modelRotation.y, glm::vec3(0.0f, 0.01f, 0.0f)); // 应用旋转
-        modelMat = glm::rotate(modelMat, modelRotation.z, glm::vec3(0.0f, 0.0f, 0.01f)); // 应用旋转
-        modelMat = glm::scale(modelMat, glm::vec3(modelScale));                          // 应用缩放
-
-        shader.setMat4("model", modelMat);
-
-        // 视图和投影矩阵
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-        shader.setMat4("view", view);
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / HEIGHT, 0.1f, 100.0f);
-        shader.setMat4("projection", projection);
-
-        // 在渲染循环中设置模型颜色
-        shader.setVec3("objectColor", 1.0f, 0.9f, 0.9f);
-        // 绘制模型
-        model.draw(shader);
-
-        // 绘制平面
-        shader.use();
-        // shader.setVec3("objectColor", 0.7f, 0.8f, 0.9f); 
-        shader.setBool("useObjectColor", false);
-        glm::mat4 planeModel = glm::mat4(1.0f);
-        shader.setMat4("model", planeModel);
-        glBindVertexArray(planeVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+            if (prepass)
+            {
+                int prepassScope = profiler.beginScope("Depth pre-pass", true);
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                overdrawMonitor.beginPass(OverdrawMonitor::Pass::Depth);
+                for (const DrawPacket &packet : frame.packets)
+                {
+                    if (!packet.model || !packet.visible)
+                        continue;
+                    packet.model->setTransform(packet.matrix);
+                    packet.model->drawDepth(depthVariants, &uniformStream, &geometryStream);
+                }
+                glUseProgram(depthVariants.program(0));
+                if (uniformStream.writeUniform(OBJECT_BLOCK_BINDING, &planeObject, sizeof(planeObject)))
+                {
+                    glBindVertexArray(planeVAO);
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                    glBindVertexArray(0);
+                }
+                overdrawMonitor.endPass();
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                // 深度已经完整，颜色通道只让最近的表面通过，也不必再写深度
+                glDepthFunc(GL_EQUAL);
+                glDepthMask(GL_FALSE);
+                profiler.endScope(prepassScope);
+            }
+            if (heatMap)
+            {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
+            }
+            overdrawMonitor.beginPass(OverdrawMonitor::Pass::Color);
 
-        // 渲染 ImGui
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            // 绘制模型
+            int modelsScope = profiler.beginScope("Models", true);
+            for (const DrawPacket &packet : frame.packets)
+            {
+                if (!packet.model || !packet.visible)
+                    continue;
+                packet.model->setColor(packet.color);
+                packet.model->setRoughness(packet.roughness);
+                packet.model->setTransform(packet.matrix);
+                if (heatMap)
+                    packet.model->drawDepth(overdrawVariants, &uniformStream, &geometryStream);
+                else
+                    packet.model->draw(variants, &uniformStream, &geometryStream, lightingFeatures);
+            }
+            profiler.endScope(modelsScope);
 
-        // 交换缓冲
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+            // 绘制平面
+            int planeScope = profiler.beginScope("Plane", true);
+            glUseProgram(heatMap ? overdrawVariants.program(0) : variants.program(lightingFeatures));
+            if (uniformStream.writeUniform(OBJECT_BLOCK_BINDING, &planeObject, sizeof(planeObject)))
+            {
+                glBindVertexArray(planeVAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                glBindVertexArray(0);
+            }
+            profiler.endScope(planeScope);
 
-    // 清理
-    glDeleteVertexArrays(1, &planeVAO);
-    glDeleteBuffers(1, &planeVBO);
-    glDeleteBuffers(1, &planeEBO);
+            overdrawMonitor.endPass();
+            if (prepass)
+            {
+                glDepthFunc(GL_LESS);
+                glDepthMask(GL_TRUE);
+            }
+            if (heatMap)
+            {
+                // 计数映射成颜色画满画面；场景深度不保留，之后的线框不做遮挡
+                glDisable(GL_BLEND);
+                glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+                glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+                glActiveTexture(GL_TEXTURE0 + OVERDRAW_TEXTURE_UNIT);
+                glBindTexture(GL_TEXTURE_2D, overdrawTarget->color);
+                glActiveTexture(GL_TEXTURE0);
+                glDisable(GL_DEPTH_TEST);
+                heatMapShader.use();
+                glBindVertexArray(fullscreenVAO);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glBindVertexArray(0);
+                glEnable(GL_DEPTH_TEST);
+                renderTargets.release(overdrawTarget);
+            }
+        }
 
-    // 清理 ImGui
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+        // 可见物体的包围盒线框，顶点每帧重新生成
+        int boundsScope = profiler.beginScope("Bounds", true);
+        GLintptr lineOffset;
+        LineVertex *lines = nullptr;
+        // 只为阴影提交的绘制包不画线框
+        size_t visibleCount = 0;
+        for (const DrawPacket &packet : frame.packets)
+            visibleCount += packet.visible;
+        if (showBounds && visibleCount > 0)
+            lines = static_cast<LineVertex *>(geometryStream.allocate(visibleCount * BOX_VERTICES * sizeof(LineVertex), lineOffset, sizeof(LineVertex)));
+        if (lines)
+        {
+            size_t box = 0;
+            for (const DrawPacket &packet : frame.packets)
+            {
+                if (!packet.visible)
+                    continue;
+                glm::vec3 center(packet.matrix * glm::vec4(packet.model ? packet.model->boundsCenter() : glm::vec3(0.0f), 1.0f));
+                float radius = (packet.model ? packet.model->boundsRadius() : 0.0f) * glm::length(glm::vec3(packet.matrix[0]));
+                writeBoundsBox(lines + box++ * BOX_VERTICES, center, radius, glm::vec3(0.1f, 0.8f, 0.2f));
+            }
+            geometryStream.commit();
+            lineShader.use();
+            glBindVertexArray(lineVAO);
+            glDrawArrays(GL_LINES, static_cast<GLint>(lineOffset / sizeof(LineVertex)), static_cast<GLsizei>(visibleCount * BOX_VERTICES));
+            glBindVertexArray(0);
+        }
+        profiler.endScope(boundsScope);
 
-    glfwTerminate();
-    return 0;
-}
+        // 后处理：测光 -> 泛光（预滤波用本帧的曝光）-> 合成到输出帧缓冲；线框在此之前画进场景，随场景一起色调映射
+        if (hdr)
+        {
+            int postScope = profiler.beginScope("Post", true);
+            PostProcessUniforms postUniforms;
+            int levels = bloomEnabled ? PostProcess::bloomLevelCount(viewport[2], viewport[3], bloomLevels) : 0;
+            // 指数适应：每秒向目标靠拢 1 - e^-speed，与帧率无关
+            float adaptation = postProcess.hasExposure() ? 1.0f - std::exp(-deltaTime * adaptationSpeed) : 1.0f;
+            postUniforms.bloom = glm::vec4(bloomThreshold, bloomKnee, bloomIntensity, bloomRadius);
+            postUniforms.exposure = glm::vec4(exposureCompensation, adaptation, autoExposure ? 0.0f : manualExposure, float(levels));
+            // 直方图覆盖 2^-10 到 2^8；去掉最暗的一半和最亮的 5%
+            postUniforms.histogram = glm::vec4(-10.0f, 18.0f, 0.5f, 0.95f);
+            uniformStream.writeUniform(POST_PROCESS_BLOCK_BINDING, &postUniforms, sizeof(postUniforms));
+            if (autoExposure)
+            {
+                ProfileScope scope(profiler, "Exposure", true);
+                postProcess.measureExposure(histogramVariants.program(0), exposureVariants.program(0));
+            }
+            if (levels > 0)
+            {
+                ProfileScope scope(profiler, "Bloom", true);
+                postProcess.bloom(bloomPrefilterVariants.program(0), bloomDownsampleVariants.program(0), bloomUpsampleVariants.program(0),
+                                  levels);
+            }
+            {
+                ProfileScope scope(profiler, "Tone map", true);
+                postProcess.composite(tonemapVariants.program(0));
+            }
+            profiler.endScope(postScope);
+        }
+        renderTargets.endFrame();
+        uniformStream.endFrame();
+        geometryStream.endFrame();
 
-void framebufferSizeCallback(GLFWwindow *window, int width, int height)
-{
-    glViewport(0, 0, width, height);
-}
+        // 读回场景画面（不含界面）
+        if (capture.isActive())
+        {
+            ProfileScope scope(profiler, "Capture");
+            capture.capture();
+        }
 
-void processInput(GLFWwindow *window)
-{
-    float cameraSpeed = 2.5f * deltaTime;
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-    float modelMoveSpeed = 0.1;
-    float rotateSpeed = 0.2;
-    // 添加模型复位逻辑
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
-    {                                                // 按下 R 键复位模型
-        modelPos = glm::vec3(0.0f, -10.0f, 0.0f);    // 复位模型位置
-        modelRotation = glm::vec3(0.0f, 0.0f, 0.0f); // 复位模型旋转
-        modelScale = 0.6f;                           // 复位模型缩放
-    }
-    // 添加相机复位逻辑
-    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
-    {                                                // 按下 T 键复位相机
-        cameraPos = glm::vec3(0.0f, 3.0f, 30.0f);    // 复位相机位置
-        cameraFront = glm::vec3(0.0f, -0.3f, -1.0f); // 复位相机朝向
-    }
-    if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)           // 向上移动
-        cameraPos += modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向上移动
-    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)           // 向下移动
-        cameraPos -= modelMoveSpeed * glm::vec3(0.0, 0.1, 0.0); // 添加向下移动
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-    {
+        // 渲染 ImGui
+        if (window)
+        {
+            ProfileScope scope(profiler, "UI render", true);
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        profiler.endScope(frameScope);
+
+        // 交换缓冲（垂直同步的等待不计入 Frame）
+        if (window)
+        {
+            ProfileScope scope(profiler, "Swap");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        profiler.endFrame();
+        frameIndex++;
 
-        // 控制相机旋转
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // 向上旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), glm::normalize(glm::cross(cameraUp, cameraFront)))) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // 向下旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), glm::normalize(glm::cross(cameraUp, cameraFront)))) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // 向左旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(-rotateSpeed), cameraUp)) * cameraFront;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // 向右旋转
-            cameraFront = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(rotateSpeed), cameraUp)) * cameraFront;
-        // 控制模型旋转
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) // 向上旋转
-            modelRotation.x += rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) // 向下旋转
-            modelRotation.x -= rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) // 向左旋转
-            modelRotation.y -= rotateSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) // 向右旋转
-            modelRotation.y += rotateSpeed;
+        // 切换单/多线程放在帧末，此时本帧快照已不再使用
+        pipeline.setThreaded(pipelined);
     }
-    else
+
+    // 无窗口模式输出最后一帧
+    if (!window)
     {
-        // 控制相机移动
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // 向前移动
-            cameraPos += modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // 向后移动
-            cameraPos -= modelMoveSpeed * glm::vec3(0.0, 0.0, -0.5);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // 向左移动
-            cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // 向右移动
-            cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * modelMoveSpeed;
-
-        // 控制模型平移
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) // 向上平移
-            modelPos.y += modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) // 向下平移
-            modelPos.y -= modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) // 向左平移
-            modelPos.x -= modelMoveSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) // 向右平移
-            modelPos.x += modelMoveSpeed;
+        if (!options.output.empty() && writeFramebufferPPM(options.output, width, height))
+            std::cout << "Wrote " << options.output << " (" << width << "x" << height << ", " << frameIndex << " frames)" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) // 放大模型
-        modelScale += 0.01;
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) // 缩小模型
-        modelScale -= 0.01;
-
-    // 开始插值
-    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
+    if (capture.isActive())
     {
-        isInterpolating = true;
-        interpolationFactor = 0.0f;
+        capture.stop();
+        FrameCapture::Stats stats = capture.stats();
+        std::cout << "Captured " << stats.written << "/" << stats.requested << " frames to " << captureDirectory << ", dropped "
+                  << stats.dropped() << " (gpu " << stats.droppedGpu << ", queue " << stats.droppedQueue << "), "
+                  << stats.framesPerSecond() << " fps, " << stats.megabytesPerSecond() << " MB/s" << std::endl;
     }
+    if (!options.trace.empty())
+        Trace::write(options.trace);
 
-    // 按下 O 键触发舞蹈
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+    // 清理
+    glDeleteVertexArrays(1, &planeVAO);
+    glDeleteVertexArrays(1, &fullscreenVAO);
+    glDeleteBuffers(1, &planeVBO);
+    glDeleteBuffers(1, &planeEBO);
+    glDeleteBuffers(1, &boneFallbackUBO);
+    glDeleteVertexArrays(1, &lineVAO);
+    uniformStream.destroy();
+    geometryStream.destroy();
+    profiler.destroy();
+    renderTargets.destroy();
+    postProcess.destroy();
+    shadowMap.destroy();
+    lightBuffers.destroy();
+    gbuffer.destroy();
+    overdrawMonitor.destroy();
+    ssao.destroy();
+    offscreen.destroy();
+    ownedModel.reset();
+    shaders.destroy();
+    glDeleteProgram(fallbackShader.ID);
+    if (compileWindow)
+        glfwDestroyWindow(compileWindow);
+    compileContext.destroy();
+
+    // 清理 ImGui
+    if (window)
     {
-        isDancing = !isDancing; // 切换舞蹈状态
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
     }
-}
-
-void mouseCallback(GLFWwindow *window, double xpos, double ypos)
-{
-}
+    ImGui::DestroyContext();
 
-void scrollCallback(GLFWwindow *window, double xoffset, double yoffset)
-{
-    // modelScale += yoffset * 0.1f; // 根据滚轮滚动调整缩放
-    // if (modelScale < 0.1f)
-    //     modelScale = 0.1f; // 限制最小缩放值
+    if (window)
+        glfwTerminate();
+    else
+        headless.destroy();
+    return 0;
 }
@@ -0,0 +1,62 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 只读内存映射文件，析构时自动解除映射
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // 映射建立后即可关闭文件描述符
+        if (ptr == MAP_FAILED)
+            return false;
+        // 顺序读取为主，提示内核预读
+        madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+        mapped = static_cast<const char *>(ptr);
+        length = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    void close()
+    {
+        if (mapped)
+            munmap(const_cast<char *>(mapped), length);
+        mapped = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const { return mapped != nullptr; }
+    const char *data() const { return mapped; }
+    size_t size() const { return length; }
+
+private:
+    const char *mapped = nullptr;
+    size_t length = 0;
+};
+
+#endif
@@ -2,11 +2,14 @@
 // #include "stb_image.h"
 
 #include "model_loader.h"
+#include <cctype>
+#include <unordered_map>
 
 Model::Model(const std::string &filepath)
 {
 
     loadModel(filepath);
+    computeBounds();
 }
 
 bool Model::isLoaded() const
@@ -14,45 +17,291 @@ bool Model::isLoaded() const
     return !meshes.empty();
 }
 
-void Model::draw(const Shader &shader)
+void Model::draw(ShaderVariants &shaders, StreamBuffer *objects, StreamBuffer *vertices, uint32_t features)
 {
+    TraceScope trace("Model::draw");
+    drawMeshes(shaders, objects, vertices, features, false, nullptr);
+}
+
+void Model::drawDepth(ShaderVariants &shaders, StreamBuffer *objects, StreamBuffer *vertices, const CasterTest &visible)
+{
+    TraceScope trace("Model::drawDepth");
+    drawMeshes(shaders, objects, vertices, 0, true, visible ? &visible : nullptr);
+}
+
+void Model::drawMeshes(ShaderVariants &shaders, StreamBuffer *objects, StreamBuffer *vertices, uint32_t extraFeatures, bool depthOnly,
+                       const CasterTest *visible)
+{
+    // glTF 贴图在后台解码，完成后再上传
+    if (gltf)
+        gltf->uploadPendingImages();
+
+    graph.update();
+    bool gpuSkinning = !bones.empty() && skinningPath == SkinningPath::Gpu && objects;
+    bool cpuSkinning = !bones.empty() && skinningPath != SkinningPath::Gpu && vertices;
+    if (gpuSkinning || cpuSkinning)
+        updatePalette();
+    // 整个模型共用一份骨骼矩阵
+    if (gpuSkinning && !objects->writeUniform(BONE_BLOCK_BINDING, palette.data(), MAX_BONES * sizeof(glm::mat4)))
+        gpuSkinning = false;
+
+    // CPU 蒙皮结果在同一帧、同一姿态下复用（阴影级联和主通道只蒙皮一次）
+    if (cpuSkinning && (skinnedBuffer != vertices || skinnedFrame != vertices->stats().frames || skinnedVersion != poseVersion))
+    {
+        skinOffsets.assign(meshes.size(), -1);
+        skinnedBuffer = vertices;
+        skinnedFrame = vertices->stats().frames;
+        skinnedVersion = poseVersion;
+    }
+
     for (unsigned int i = 0; i < meshes.size(); i++)
     {
-        meshes[i].draw(shader);
+        Mesh &mesh = meshes[i];
+        // 蒙皮后的顶点在模型根空间，不再叠加网格所在节点的变换
+        bool skinned = !mesh.weights.empty() && (gpuSkinning || cpuSkinning);
+        const glm::mat4 &world = graph.world(skinned ? 0 : mesh.node);
+        if (visible)
+        {
+            // 蒙皮网格的绑定姿态包围盒不一定包住动画姿态，用整个模型的包围球
+            glm::vec3 localCenter = skinned ? center : (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+            float localRadius = skinned ? radius : glm::length(mesh.boundsMax - mesh.boundsMin) * 0.5f;
+            float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+            if (!(*visible)(glm::vec3(world * glm::vec4(localCenter, 1.0f)), localRadius * scale))
+                continue;
+        }
+        uint32_t features = (depthOnly ? 0 : mesh.features() | extraFeatures) | (skinned && gpuSkinning ? ShaderFeature::Skinning : 0);
+        Shader shader(shaders.program(features));
+        if (!shader.ID)
+            continue;
+        shader.use();
+        if (objects)
+        {
+            ObjectUniforms object;
+            object.model = world;
+            object.color = glm::vec4(color, 1.0f);
+            object.material.x = roughness;
+            if (!objects->writeUniform(OBJECT_BLOCK_BINDING, &object, sizeof(object)))
+                continue;
+        }
+        else
+            shader.setMat4("model", world);
+
+        GLuint skinBuffer = 0;
+        GLintptr skinOffset = 0;
+        if (skinned && cpuSkinning)
+        {
+            if (skinOffsets[i] < 0)
+            {
+                size_t count = mesh.vertices.size();
+                void *target = vertices->allocate(count * sizeof(SkinnedVertex), skinOffset, sizeof(SkinnedVertex));
+                if (!target)
+                    continue;
+                skinVertices(skinningPath, mesh.vertices.data(), mesh.weights.data(), count, cpuPalette.data(),
+                             static_cast<SkinnedVertex *>(target));
+                vertices->commit();
+                skinOffsets[i] = skinOffset;
+            }
+            skinOffset = skinOffsets[i];
+            skinBuffer = vertices->id();
+        }
+        mesh.draw(skinBuffer, skinOffset, depthOnly);
+    }
+}
+
+void Model::prepareShaders(ShaderVariants &shaders, uint32_t features, bool depthOnly) const
+{
+    for (const Mesh &mesh : meshes)
+    {
+        bool gpuSkinned = !mesh.weights.empty() && skinningPath == SkinningPath::Gpu;
+        shaders.prepare((depthOnly ? 0 : mesh.features() | features) | (gpuSkinned ? ShaderFeature::Skinning : 0));
     }
 }
 
+int Model::addBone(const std::string &name, const glm::mat4 &offset)
+{
+    auto it = boneIndex.find(name);
+    if (it != boneIndex.end())
+        return it->second;
+    if (bones.size() >= MAX_BONES)
+    {
+        if (bones.size() == MAX_BONES)
+            std::cerr << "ERROR::MODEL::TOO_MANY_BONES " << MAX_BONES << std::endl;
+        return -1;
+    }
+    Bone bone;
+    bone.name = name;
+    bone.offset = offset;
+    bones.push_back(bone);
+    return boneIndex[name] = static_cast<int>(bones.size() - 1);
+}
+
+void Model::updatePalette()
+{
+    // 骨骼矩阵 = 根节点的逆 * 骨骼节点世界矩阵 * 偏移矩阵，结果在模型根空间
+    glm::mat4 rootInverse = glm::inverse(graph.world(0));
+    palette.resize(MAX_BONES, glm::mat4(1.0f));
+    cpuPalette.resize(bones.size());
+    for (size_t i = 0; i < bones.size(); i++)
+    {
+        const Bone &bone = bones[i];
+        glm::mat4 world = bone.node >= 0 ? graph.world(bone.node) : graph.world(0);
+        palette[i] = rootInverse * world * bone.offset;
+        cpuPalette[i] = toPaletteMatrix(palette[i]);
+    }
+}
+
+void Model::animate(float time, size_t clip)
+{
+    if (clip >= clips.size())
+        return;
+    if (channelNodes.empty() || clip != sampledClip)
+    {
+        sampledClip = clip;
+        sampler.bind(&clips[clip]);
+        channelNodes.clear();
+        for (const std::string &node : clips[clip].nodes)
+        {
+            auto it = nodeIndex.find(node);
+            channelNodes.push_back(it == nodeIndex.end() ? -1 : it->second);
+        }
+    }
+    sampler.sample(time);
+    ++poseVersion;
+    for (size_t i = 0; i < channelNodes.size(); i++)
+        if (channelNodes[i] >= 0)
+            graph.setLocal(channelNodes[i], sampler.pose(i).matrix());
+}
+
+void Model::computeBounds()
+{
+    // 各网格的 AABB 角点变换到模型根空间后取整体 AABB
+    graph.update();
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (const Mesh &mesh : meshes)
+    {
+        const glm::mat4 &world = graph.world(mesh.node);
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec3 p((corner & 1) ? mesh.boundsMax.x : mesh.boundsMin.x,
+                        (corner & 2) ? mesh.boundsMax.y : mesh.boundsMin.y,
+                        (corner & 4) ? mesh.boundsMax.z : mesh.boundsMin.z);
+            p = glm::vec3(world * glm::vec4(p, 1.0f));
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+    }
+    if (meshes.empty())
+        return;
+    center = (lo + hi) * 0.5f;
+    radius = glm::length(hi - center);
+}
+
+void Model::setTransform(const glm::mat4 &transform)
+{
+    if (graph.size() > 0)
+        graph.setLocal(0, transform);
+}
+
 void Model::loadModel(const std::string &path)
 {
+    TraceScope trace("Model::loadModel");
+    directory = path.substr(0, path.find_last_of('/'));
+    graph.addNode(-1, glm::mat4(1.0f));
+
+    // OBJ 走自带的并行解析器，失败时回退到 Assimp
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    for (char &c : extension)
+        c = std::tolower(static_cast<unsigned char>(c));
+    if (extension == "obj" && loadObjModel(path))
+        return;
+    // GLB 直接上传 bufferView，不经过 Assimp 的通用转换
+    if (extension == "glb" && loadGltfModel(path))
+        return;
+
     Assimp::Importer importer;
 
     // const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
-    const aiScene *scene = importer.ReadFile(path,
-                                             aiProcess_Triangulate |
-                                                 aiProcess_FlipUVs |
-                                                 aiProcess_GenNormals |
-                                                 aiProcess_OptimizeMeshes |
-                                                 aiProcess_JoinIdenticalVertices);
+    const aiScene *scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
         return;
     }
-    directory = path.substr(0, path.find_last_of('/'));
-    processNode(scene->mRootNode, scene);
+    processNode(scene->mRootNode, scene, 0);
+    for (Bone &bone : bones)
+    {
+        auto it = nodeIndex.find(bone.name);
+        if (it != nodeIndex.end())
+            bone.node = it->second;
+    }
+    std::vector<AnimationClip> rawClips;
+    loadAnimationClips(scene, rawClips);
+    for (const AnimationClip &clip : rawClips)
+        clips.push_back(compressClip(clip));
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene)
+bool Model::loadObjModel(const std::string &path)
 {
-    // std::cout << "111";
+    ObjScene scene;
+    if (!loadObj(path, scene))
+        return false;
+
+    // 多个网格共用同一张贴图时只加载一次
+    std::unordered_map<std::string, Texture> loadedTextures;
+    auto loadTexture = [&](const std::string &file, const char *type)
+    {
+        auto it = loadedTextures.find(file);
+        if (it == loadedTextures.end())
+        {
+            Texture texture;
+            texture.id = TextureFromFile(file.c_str(), directory);
+            texture.type = type;
+            texture.path = file;
+            it = loadedTextures.emplace(file, texture).first;
+        }
+        return it->second;
+    };
+    for (ObjMesh &objMesh : scene.meshes)
+    {
+        std::vector<Texture> textures;
+        for (const ObjMaterial &material : scene.materials)
+        {
+            if (material.name != objMesh.material)
+                continue;
+            if (!material.diffuseMap.empty())
+                textures.push_back(loadTexture(material.diffuseMap, "texture_diffuse"));
+            if (!material.normalMap.empty())
+                textures.push_back(loadTexture(material.normalMap, "texture_normal"));
+            break;
+        }
+        meshes.push_back(Mesh(std::move(objMesh.vertices), std::move(objMesh.indices), textures));
+    }
+    return true;
+}
+
+// Assimp 矩阵为行主序，glm 为列主序
+static glm::mat4 toGlm(const aiMatrix4x4 &m)
+{
+    return glm::mat4(m.a1, m.b1, m.c1, m.d1,
+                     m.a2, m.b2, m.c2, m.d2,
+                     m.a3, m.b3, m.c3, m.d3,
+                     m.a4, m.b4, m.c4, m.d4);
+}
+
+void Model::processNode(aiNode *node, const aiScene *scene, int parent)
+{
+    // 先序遍历，保证场景图中子树连续
+    int index = graph.addNode(parent, toGlm(node->mTransformation));
+    nodeIndex[node->mName.C_Str()] = index;
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
         meshes.push_back(processMesh(mesh, scene));
+        meshes.back().node = index;
     }
     for (unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, index);
     }
 }
 
@@ -100,44 +349,149 @@ Model::Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
         std::vector<Texture> diffuseMaps = loadMaterialTextures(material, 
             aiTextureType_DIFFUSE, "texture_diffuse");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        // OBJ 的 map_Bump 被 Assimp 归为高度图，没有法线贴图时用它
+        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_NORMALS, "texture_normal");
+        if (normalMaps.empty())
+            normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+    }
+
+    // 每个顶点保留权重最大的 4 根骨骼
+    std::vector<VertexWeights> weights;
+    if (mesh->HasBones())
+    {
+        weights.resize(mesh->mNumVertices);
+        for (unsigned int i = 0; i < mesh->mNumBones; i++)
+        {
+            const aiBone *bone = mesh->mBones[i];
+            int id = addBone(bone->mName.C_Str(), toGlm(bone->mOffsetMatrix));
+            if (id < 0)
+                continue;
+            for (unsigned int j = 0; j < bone->mNumWeights; j++)
+                if (bone->mWeights[j].mVertexId < mesh->mNumVertices)
+                    weights[bone->mWeights[j].mVertexId].add(id, bone->mWeights[j].mWeight);
+        }
+        for (VertexWeights &vertexWeights : weights)
+            vertexWeights.normalize();
     }
 
-    return Mesh(vertices, indices, textures);
+    return Mesh(vertices, indices, textures, std::move(weights));
 }
 
-Model::Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
-    : vertices(vertices), indices(indices), textures(textures)
+bool Model::loadGltfModel(const std::string &path)
 {
-    setupMesh();
+    std::unique_ptr<GltfAsset> asset(new GltfAsset());
+    if (!asset->load(path))
+        return false;
+
+    auto addPrimitive = [&](const GltfPrimitive &primitive, int node)
+    {
+        std::vector<Texture> textures;
+        if (primitive.baseColorTexture)
+        {
+            Texture texture;
+            texture.id = primitive.baseColorTexture;
+            texture.type = "texture_diffuse";
+            textures.push_back(texture);
+        }
+        meshes.push_back(Mesh(primitive, textures));
+        meshes.back().node = node;
+    };
+
+    // glTF 节点已是先序，整体挂到模型根（节点 0）下
+    int base = static_cast<int>(graph.size());
+    for (const GltfNode &node : asset->nodes)
+    {
+        int index = graph.addNode(node.parent < 0 ? 0 : base + node.parent, node.local);
+        if (node.mesh < 0)
+            continue;
+        for (const GltfPrimitive &primitive : asset->primitives)
+            if (primitive.mesh == node.mesh)
+                addPrimitive(primitive, index);
+    }
+    // 没有场景信息时按原点放置所有网格
+    if (asset->nodes.empty())
+        for (const GltfPrimitive &primitive : asset->primitives)
+            addPrimitive(primitive, 0);
+    gltf = std::move(asset);
+    return true;
 }
 
-void Model::Mesh::draw(const Shader &shader)
+Model::Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+                  std::vector<VertexWeights> weights)
+    : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)), weights(std::move(weights))
 {
-    // 绑定适当的纹理
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-    for(unsigned int i = 0; i < textures.size(); i++)
+    indexCount = static_cast<GLsizei>(this->indices.size());
+    if (!this->vertices.empty())
     {
-        glActiveTexture(GL_TEXTURE0 + i); // 激活纹理单元
-        std::string number;
-        std::string name = textures[i].type;
-        if(name == "texture_diffuse")
-            number = std::to_string(diffuseNr++); // diffuse_texture1, diffuse_texture2, ...
-        else if(name == "texture_specular")
-            number = std::to_string(specularNr++); // specular_texture1, specular_texture2, ...
+        boundsMin = boundsMax = this->vertices[0].Position;
+        for (const Vertex &vertex : this->vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+    }
+    setupMesh();
+}
+
+Model::Mesh::Mesh(const GltfPrimitive &primitive, std::vector<Texture> textures)
+    : textures(std::move(textures)), VAO(primitive.VAO), VBO(0), EBO(0), mode(primitive.mode),
+      indexCount(primitive.count), indexType(primitive.indexType), indexOffset(primitive.indexOffset),
+      boundsMin(primitive.boundsMin), boundsMax(primitive.boundsMax)
+{
+}
 
-        // 设置着色器中的Uniform变量
-        shader.setInt((name + number).c_str(), i);
-        // 绑定纹理
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+uint32_t Model::Mesh::features() const
+{
+    uint32_t features = 0;
+    for (const Texture &texture : textures)
+    {
+        if (texture.type == "texture_diffuse")
+            features |= ShaderFeature::Texture;
+        else if (texture.type == "texture_normal")
+            features |= ShaderFeature::NormalMap;
     }
+    return features;
+}
 
-    // 设置是否使用纹理
-    shader.setBool("useTexture", textures.size() > 0);
+void Model::Mesh::draw(GLuint skinBuffer, GLintptr skinOffset, bool depthOnly)
+{
+    // 每种贴图只用第一张，单元与着色器变体里的 sampler 对应，不需要逐次设置 uniform
+    bool diffuseBound = false, normalBound = false;
+    for (const Texture &texture : textures)
+    {
+        if (depthOnly)
+            break;
+        int unit;
+        if (texture.type == "texture_diffuse" && !diffuseBound)
+            unit = DIFFUSE_TEXTURE_UNIT, diffuseBound = true;
+        else if (texture.type == "texture_normal" && !normalBound)
+            unit = NORMAL_TEXTURE_UNIT, normalBound = true;
+        else
+            continue;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+    }
+    glActiveTexture(GL_TEXTURE0);
 
     // 绘制网格
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    if (skinBuffer)
+    {
+        // 流式缓冲每帧的写入位置不同，重新指定位置和法线的来源
+        glBindVertexArray(skinVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, skinBuffer);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void *)skinOffset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void *)(skinOffset + offsetof(SkinnedVertex, Normal)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else if (depthOnly && depthVAO)
+        glBindVertexArray(depthVAO);
+    else
+        glBindVertexArray(VAO);
+    if (indexType)
+        glDrawElements(mode, indexCount, indexType, (void *)indexOffset);
+    else
+        glDrawArrays(mode, 0, indexCount);
     glBindVertexArray(0);
     
     // 重置激活的纹理单元
@@ -164,11 +518,49 @@ void Model::Mesh::setupMesh()
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
 
+    if (weights.empty())
+    {
+        // 只有位置的紧凑顶点流，深度通道每个顶点只取 12 字节
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+            positions[i] = vertices[i].Position;
+        glGenBuffers(1, &PBO);
+        glGenVertexArrays(1, &depthVAO);
+        glBindVertexArray(depthVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, PBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+        glBindVertexArray(0);
+        return;
+    }
+
+    // 骨骼下标是整数属性，要用 glVertexAttribIPointer
+    glGenBuffers(1, &WBO);
+    glBindBuffer(GL_ARRAY_BUFFER, WBO);
+    glBufferData(GL_ARRAY_BUFFER, weights.size() * sizeof(VertexWeights), &weights[0], GL_STATIC_DRAW);
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 4, GL_INT, sizeof(VertexWeights), (void *)0);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VertexWeights), (void *)offsetof(VertexWeights, weights));
+
+    // CPU 蒙皮用的 VAO，属性 0/1 在绘制时指向流式缓冲
+    glGenVertexArrays(1, &skinVAO);
+    glBindVertexArray(skinVAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+
     glBindVertexArray(0);
 }
 
 unsigned int Model::TextureFromFile(const char *path, const std::string &directory)
 {
+    TraceScope trace("Texture decode");
     std::string filename = std::string(path);
     filename = directory + '/' + filename;
 
@@ -6,27 +6,69 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "shader.h"
+#include "shader_variants.h"
 #include "stb_image.h"
+#include "vertex.h"
+#include "obj_loader.h"
+#include "gltf_loader.h"
+#include "scene_graph.h"
+#include "animation.h"
+#include "animation_compression.h"
+#include "stream_buffer.h"
+#include "uniform_blocks.h"
+#include "skinning.h"
+
+// Assimp 导入选项，基准测试与 Model 共用
+const unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate |
+                                        aiProcess_FlipUVs |
+                                        aiProcess_GenNormals |
+                                        aiProcess_OptimizeMeshes |
+                                        aiProcess_JoinIdenticalVertices;
 
 class Model
 {
 public:
     Model(const std::string &path);
     bool isLoaded() const;
-    void draw(const Shader &shader);
-
-private:
-    struct Vertex
+    // 设置模型整体变换（场景图根节点）
+    void setTransform(const glm::mat4 &transform);
+    // 没有漫反射贴图的网格使用的表面颜色
+    void setColor(const glm::vec3 &color) { this->color = color; }
+    // 所有网格共用的粗糙度，0.5 对应原来固定的高光指数 32
+    void setRoughness(float roughness) { this->roughness = roughness; }
+    // 模型根空间的包围球
+    glm::vec3 boundsCenter() const { return center; }
+    float boundsRadius() const { return radius; }
+    // 导入的关键帧动画（导入时压缩，不保留原始关键帧）；animate 把第 clip 个片段在 time 秒的姿态写入场景图
+    const std::vector<CompressedClip> &animations() const { return clips; }
+    void animate(float time, size_t clip = 0);
+    // 蒙皮路径：GPU 在着色器中混合骨骼矩阵（需要 objects），CPU 把蒙皮后的顶点写入 vertices
+    void setSkinningPath(SkinningPath path)
     {
-        glm::vec3 Position;
-        glm::vec3 Normal;
-        glm::vec2 TexCoords;
-    };
+        skinningPath = path;
+        ++poseVersion;
+    }
+    SkinningPath getSkinningPath() const { return skinningPath; }
+    bool isSkinned() const { return !bones.empty(); }
+    // 每个网格按贴图和蒙皮方式选择着色器变体（见 ShaderFeature），features 为额外开启的特性（例如阴影）
+    // objects 不为空时每个网格的变换（以及骨骼矩阵）写入流式缓冲并绑定到 uniform block，否则设置 "model" uniform
+    void draw(ShaderVariants &shaders, StreamBuffer *objects = nullptr, StreamBuffer *vertices = nullptr, uint32_t features = 0);
+    // 只写深度（阴影、深度预通道）：不绑定贴图，静态网格使用只有位置的顶点流，变体只区分蒙皮
+    // visible 按网格的世界空间包围球剔除，为空时全部绘制
+    typedef std::function<bool(const glm::vec3 &center, float radius)> CasterTest;
+    void drawDepth(ShaderVariants &shaders, StreamBuffer *objects = nullptr, StreamBuffer *vertices = nullptr,
+                   const CasterTest &visible = nullptr);
+    // 按当前蒙皮路径预先请求各网格会用到的变体
+    void prepareShaders(ShaderVariants &shaders, uint32_t features = 0, bool depthOnly = false) const;
 
+private:
     struct Texture
     {
         unsigned int id;
@@ -39,18 +81,72 @@ private:
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         std::vector<Texture> textures;
+        std::vector<VertexWeights> weights; // 为空表示不是蒙皮网格
         unsigned int VAO, VBO, EBO;
+        unsigned int WBO = 0;     // 骨骼下标与权重
+        unsigned int skinVAO = 0; // CPU 蒙皮：位置和法线来自流式缓冲，纹理坐标来自 VBO
+        unsigned int PBO = 0, depthVAO = 0; // 静态网格只有位置的顶点流（glTF 和蒙皮网格没有）
+        GLenum mode = GL_TRIANGLES;
+        GLsizei indexCount = 0;
+        GLenum indexType = GL_UNSIGNED_INT; // 0 表示无索引
+        size_t indexOffset = 0;
+        int node = 0; // 所在的场景图节点
+        glm::vec3 boundsMin = glm::vec3(0.0f), boundsMax = glm::vec3(0.0f);
 
-        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
-        void draw(const Shader &shader);
+        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+             std::vector<VertexWeights> weights = std::vector<VertexWeights>());
+        // 使用已经建好的 VAO（glTF 路径），不保留 CPU 端顶点
+        Mesh(const GltfPrimitive &primitive, std::vector<Texture> textures);
+        // 材质决定的特性位（贴图、法线贴图），蒙皮位由 Model::draw 按路径补上
+        uint32_t features() const;
+        // 贴图按类型绑定到固定纹理单元；skinBuffer 不为 0 时从该缓冲的 skinOffset 处读取 CPU 蒙皮结果
+        // depthOnly 时不绑定贴图，有 depthVAO 时改用它
+        void draw(GLuint skinBuffer = 0, GLintptr skinOffset = 0, bool depthOnly = false);
         void setupMesh();
     };
 
     std::vector<Mesh> meshes;
+    SceneGraph graph; // 节点 0 为模型根，其下是导入的节点层级
     std::string directory;
+    std::unique_ptr<GltfAsset> gltf; // 持有 glTF 网格的 GL 对象，随模型一起销毁
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float roughness = 0.5f;
+    std::unordered_map<std::string, int> nodeIndex; // 节点名到场景图节点
+    std::vector<CompressedClip> clips;
+    AnimationSampler sampler;
+    size_t sampledClip = 0;
+    std::vector<int> channelNodes; // 当前片段各通道对应的场景图节点，-1 表示找不到
+
+    // 骨骼与节点同名，导入完成后再解析到场景图节点
+    struct Bone
+    {
+        std::string name;
+        int node = -1;
+        glm::mat4 offset; // 网格空间到骨骼空间（绑定姿态的逆）
+    };
+    std::vector<Bone> bones;
+    std::unordered_map<std::string, int> boneIndex;
+    std::vector<glm::mat4> palette;        // MAX_BONES 个，模型根空间
+    std::vector<PaletteMatrix> cpuPalette; // 与 bones 等长
+    SkinningPath skinningPath = SkinningPath::Gpu;
+    // CPU 蒙皮结果的缓存：同一流式缓冲、同一帧、同一姿态时复用，-1 表示该网格还没蒙皮
+    std::vector<GLintptr> skinOffsets;
+    const StreamBuffer *skinnedBuffer = nullptr;
+    uint64_t skinnedFrame = 0, skinnedVersion = 0;
+    uint64_t poseVersion = 1; // animate 或切换蒙皮路径时递增
+
+    void drawMeshes(ShaderVariants &shaders, StreamBuffer *objects, StreamBuffer *vertices, uint32_t extraFeatures, bool depthOnly,
+                    const CasterTest *visible);
+    int addBone(const std::string &name, const glm::mat4 &offset);
+    void updatePalette();
+    void computeBounds();
 
     void loadModel(const std::string &path);
-    void processNode(aiNode *node, const aiScene *scene);
+    bool loadObjModel(const std::string &path);
+    bool loadGltfModel(const std::string &path);
+    void processNode(aiNode *node, const aiScene *scene, int parent);
     Mesh processMesh(aiMesh *mesh, const aiScene *scene);
     std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
     unsigned int TextureFromFile(const char *path, const std::string &directory);
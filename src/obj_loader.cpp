@@ -0,0 +1,568 @@
+#include "obj_loader.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    // 原始 OBJ 索引：1 基，负数为相对索引，0 表示缺省
+    struct FaceCorner
+    {
+        int v, vt, vn;
+    };
+
+    struct Face
+    {
+        uint32_t firstCorner;
+        uint32_t numCorners;
+        int32_t relative; // 含负索引时指向 Chunk::relativeBase 中的一组计数，否则为 -1
+    };
+
+    struct MaterialSwitch
+    {
+        uint32_t face; // 从块内第几个面开始生效
+        std::string name;
+    };
+
+    // 单个块的解析结果，索引在所有块完成后再统一解析
+    struct Chunk
+    {
+        std::vector<float> positions; // xyz
+        std::vector<float> normals;   // xyz
+        std::vector<float> texCoords; // uv（已翻转 V）
+        std::vector<FaceCorner> corners;
+        std::vector<Face> faces;
+        std::vector<uint32_t> relativeBase; // 相对索引面解析时的块内 v/vt/vn 计数
+        std::vector<MaterialSwitch> materials;
+        std::vector<std::string> mtllibs;
+    };
+
+    const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    inline bool isDigit(char c) { return static_cast<unsigned>(c - '0') < 10; }
+    inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+    inline const char *skipBlanks(const char *p, const char *end)
+    {
+        while (p < end && isBlank(*p))
+            ++p;
+        return p;
+    }
+
+    inline const char *nextLine(const char *p, const char *end)
+    {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        return nl ? nl + 1 : end;
+    }
+
+    inline bool startsWith(const char *p, const char *end, const char *keyword, size_t len)
+    {
+        return static_cast<size_t>(end - p) > len && std::memcmp(p, keyword, len) == 0 && isBlank(p[len]);
+    }
+
+    // 快速浮点解析，不依赖 iostream/locale；不处理 inf/nan
+    const char *parseFloat(const char *p, const char *end, float &out)
+    {
+        p = skipBlanks(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; p < end && isDigit(*p); ++p)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+            }
+            else
+                ++exponent;
+        }
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && isDigit(*p); ++p)
+            {
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    digits += mantissa != 0;
+                    --exponent;
+                }
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            bool expNegative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                expNegative = *p++ == '-';
+            int e = 0;
+            for (; p < end && isDigit(*p); ++p)
+                if (e < 1000)
+                    e = e * 10 + (*p - '0');
+            exponent += expNegative ? -e : e;
+        }
+
+        double value = static_cast<double>(mantissa);
+        if (exponent < 0)
+            value = exponent >= -22 ? value / kPow10[-exponent] : value * std::pow(10.0, exponent);
+        else if (exponent > 0)
+            value = exponent <= 22 ? value * kPow10[exponent] : value * std::pow(10.0, exponent);
+        out = static_cast<float>(negative ? -value : value);
+        return p;
+    }
+
+    inline const char *parseInt(const char *p, const char *end, int &out)
+    {
+        bool negative = false;
+        if (p < end && *p == '-')
+        {
+            negative = true;
+            ++p;
+        }
+        int value = 0;
+        for (; p < end && isDigit(*p); ++p)
+            value = value * 10 + (*p - '0');
+        out = negative ? -value : value;
+        return p;
+    }
+
+    // 读取行尾的名称（usemtl/mtllib），去掉首尾空白
+    std::string readName(const char *p, const char *end)
+    {
+        p = skipBlanks(p, end);
+        const char *e = p;
+        while (e < end && *e != '\n' && *e != '\r')
+            ++e;
+        while (e > p && isBlank(e[-1]))
+            --e;
+        return std::string(p, e);
+    }
+
+    void parseChunk(const char *p, const char *end, Chunk &chunk)
+    {
+        while (p < end)
+        {
+            p = skipBlanks(p, end);
+            if (p >= end)
+                break;
+
+            if (p[0] == 'v' && p + 1 < end)
+            {
+                if (isBlank(p[1]))
+                {
+                    float x, y, z;
+                    p = parseFloat(p + 2, end, x);
+                    p = parseFloat(p, end, y);
+                    p = parseFloat(p, end, z);
+                    chunk.positions.insert(chunk.positions.end(), {x, y, z});
+                }
+                else if (p[1] == 'n')
+                {
+                    float x, y, z;
+                    p = parseFloat(p + 2, end, x);
+                    p = parseFloat(p, end, y);
+                    p = parseFloat(p, end, z);
+                    chunk.normals.insert(chunk.normals.end(), {x, y, z});
+                }
+                else if (p[1] == 't')
+                {
+                    float u, v = 0.0f;
+                    p = parseFloat(p + 2, end, u);
+                    p = skipBlanks(p, end);
+                    if (p < end && (isDigit(*p) || *p == '-' || *p == '+' || *p == '.'))
+                        p = parseFloat(p, end, v);
+                    // 与 aiProcess_FlipUVs 一致
+                    chunk.texCoords.insert(chunk.texCoords.end(), {u, 1.0f - v});
+                }
+            }
+            else if (p[0] == 'f' && p + 1 < end && isBlank(p[1]))
+            {
+                Face face;
+                face.firstCorner = static_cast<uint32_t>(chunk.corners.size());
+                face.relative = -1;
+                bool relative = false;
+                p += 2;
+                for (;;)
+                {
+                    p = skipBlanks(p, end);
+                    if (p >= end || *p == '\n' || *p == '\r' || *p == '#')
+                        break;
+                    FaceCorner corner = {0, 0, 0};
+                    p = parseInt(p, end, corner.v);
+                    if (p < end && *p == '/')
+                    {
+                        ++p;
+                        if (p < end && *p != '/')
+                            p = parseInt(p, end, corner.vt);
+                        if (p < end && *p == '/')
+                            p = parseInt(p + 1, end, corner.vn);
+                    }
+                    if (corner.v == 0)
+                    {
+                        // 无法识别的 token，跳过
+                        while (p < end && !isBlank(*p) && *p != '\n' && *p != '\r')
+                            ++p;
+                        continue;
+                    }
+                    relative |= corner.v < 0 || corner.vt < 0 || corner.vn < 0;
+                    chunk.corners.push_back(corner);
+                }
+                face.numCorners = static_cast<uint32_t>(chunk.corners.size()) - face.firstCorner;
+                if (face.numCorners < 3)
+                    chunk.corners.resize(face.firstCorner);
+                else
+                {
+                    if (relative)
+                    {
+                        face.relative = static_cast<int32_t>(chunk.relativeBase.size() / 3);
+                        chunk.relativeBase.insert(chunk.relativeBase.end(),
+                                                  {static_cast<uint32_t>(chunk.positions.size() / 3),
+                                                   static_cast<uint32_t>(chunk.texCoords.size() / 2),
+                                                   static_cast<uint32_t>(chunk.normals.size() / 3)});
+                    }
+                    chunk.faces.push_back(face);
+                }
+            }
+            else if (startsWith(p, end, "usemtl", 6))
+                chunk.materials.push_back({static_cast<uint32_t>(chunk.faces.size()), readName(p + 6, end)});
+            else if (startsWith(p, end, "mtllib", 6))
+                chunk.mtllibs.push_back(readName(p + 6, end));
+
+            p = nextLine(p, end);
+        }
+    }
+
+    // 在 numThreads 个线程上并行执行 fn(0..count-1)
+    template <typename Fn>
+    void runParallel(size_t count, unsigned int numThreads, Fn fn)
+    {
+        numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, count));
+        if (numThreads <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                fn(i);
+            return;
+        }
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++)
+            workers.emplace_back([&]()
+                                 {
+                for (size_t i = next++; i < count; i = next++)
+                    fn(i); });
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // (v, vt, vn) -> 输出顶点下标的开放寻址哈希表
+    class VertexCache
+    {
+    public:
+        explicit VertexCache(size_t expected)
+        {
+            size_t capacity = 1024;
+            while (capacity < expected * 2)
+                capacity <<= 1;
+            slots.assign(capacity, Slot{-1, 0, 0, 0});
+        }
+
+        // 返回已有下标，不存在时插入 candidate 并返回 candidate
+        uint32_t findOrInsert(int v, int vt, int vn, uint32_t candidate)
+        {
+            if ((count + 1) * 10 > slots.size() * 7)
+                grow();
+            size_t mask = slots.size() - 1;
+            for (size_t i = hash(v, vt, vn) & mask;; i = (i + 1) & mask)
+            {
+                Slot &slot = slots[i];
+                if (slot.v < 0)
+                {
+                    slot = Slot{v, vt, vn, candidate};
+                    ++count;
+                    return candidate;
+                }
+                if (slot.v == v && slot.vt == vt && slot.vn == vn)
+                    return slot.index;
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            int v, vt, vn;
+            uint32_t index;
+        };
+        std::vector<Slot> slots;
+        size_t count = 0;
+
+        static size_t hash(int v, int vt, int vn)
+        {
+            uint64_t h = static_cast<uint32_t>(v) * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<uint32_t>(vt) + 0x7F4A7C15ull + (h << 6) + (h >> 2)) * 0xBF58476D1CE4E5B9ull;
+            h ^= (static_cast<uint32_t>(vn) + 0x94D049BBull + (h << 6) + (h >> 2)) * 0x94D049BB133111EBull;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+
+        void grow()
+        {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(old.size() * 2, Slot{-1, 0, 0, 0});
+            size_t mask = slots.size() - 1;
+            for (const Slot &slot : old)
+            {
+                if (slot.v < 0)
+                    continue;
+                size_t i = hash(slot.v, slot.vt, slot.vn) & mask;
+                while (slots[i].v >= 0)
+                    i = (i + 1) & mask;
+                slots[i] = slot;
+            }
+        }
+    };
+
+    // 同一材质在某个块内的一段连续面
+    struct FaceRange
+    {
+        uint32_t chunk;
+        uint32_t begin, end;
+    };
+
+    void loadMtl(const std::string &path, std::vector<ObjMaterial> &materials)
+    {
+        MappedFile file(path);
+        if (!file.isOpen())
+        {
+            std::cerr << "ERROR::OBJ::MTL_NOT_FOUND " << path << std::endl;
+            return;
+        }
+        const char *p = file.data();
+        const char *end = p + file.size();
+        while (p < end)
+        {
+            p = skipBlanks(p, end);
+            if (startsWith(p, end, "newmtl", 6))
+                materials.push_back({readName(p + 6, end), std::string(), std::string()});
+            else if (!materials.empty() && startsWith(p, end, "map_Kd", 6))
+                materials.back().diffuseMap = readName(p + 6, end);
+            else if (!materials.empty() && (startsWith(p, end, "map_Bump", 8) || startsWith(p, end, "map_bump", 8)))
+                materials.back().normalMap = readName(p + 8, end);
+            else if (!materials.empty() && startsWith(p, end, "bump", 4))
+                materials.back().normalMap = readName(p + 4, end);
+            p = nextLine(p, end);
+        }
+    }
+}
+
+bool loadObj(const std::string &path, ObjScene &scene, unsigned int numThreads)
+{
+    MappedFile file(path);
+    if (!file.isOpen())
+    {
+        std::cerr << "ERROR::OBJ::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // 按行边界切块，每块至少 1MB，避免小文件线程开销
+    const char *data = file.data();
+    const size_t size = file.size();
+    const size_t minChunkSize = 1 << 20;
+    size_t numChunks = std::max<size_t>(1, std::min<size_t>(numThreads * 4, size / minChunkSize));
+    std::vector<const char *> bounds(1, data);
+    for (size_t i = 1; i < numChunks; i++)
+    {
+        const char *split = std::max(data + size * i / numChunks, bounds.back());
+        split = nextLine(split, data + size);
+        if (split > bounds.back() && split < data + size)
+            bounds.push_back(split);
+    }
+    bounds.push_back(data + size);
+    numChunks = bounds.size() - 1;
+
+    std::vector<Chunk> chunks(numChunks);
+    runParallel(numChunks, numThreads, [&](size_t i)
+                { parseChunk(bounds[i], bounds[i + 1], chunks[i]); });
+
+    // 每块的全局起始下标
+    std::vector<uint32_t> vBase(numChunks), vtBase(numChunks), vnBase(numChunks);
+    size_t numPositions = 0, numTexCoords = 0, numNormals = 0;
+    for (size_t i = 0; i < numChunks; i++)
+    {
+        vBase[i] = static_cast<uint32_t>(numPositions);
+        vtBase[i] = static_cast<uint32_t>(numTexCoords);
+        vnBase[i] = static_cast<uint32_t>(numNormals);
+        numPositions += chunks[i].positions.size() / 3;
+        numTexCoords += chunks[i].texCoords.size() / 2;
+        numNormals += chunks[i].normals.size() / 3;
+    }
+
+    // 按 usemtl 把面分组，材质状态跨块延续
+    std::unordered_map<std::string, uint32_t> materialIds;
+    std::vector<std::string> materialNames;
+    std::vector<std::vector<FaceRange>> ranges;
+    uint32_t currentMaterial = 0;
+    materialNames.push_back(std::string());
+    ranges.emplace_back();
+    materialIds[std::string()] = 0;
+    for (uint32_t c = 0; c < numChunks; c++)
+    {
+        const Chunk &chunk = chunks[c];
+        uint32_t begin = 0;
+        for (size_t s = 0; s <= chunk.materials.size(); s++)
+        {
+            uint32_t end = s < chunk.materials.size() ? chunk.materials[s].face : static_cast<uint32_t>(chunk.faces.size());
+            if (end > begin)
+                ranges[currentMaterial].push_back({c, begin, end});
+            begin = end;
+            if (s < chunk.materials.size())
+            {
+                auto inserted = materialIds.emplace(chunk.materials[s].name, static_cast<uint32_t>(materialNames.size()));
+                if (inserted.second)
+                {
+                    materialNames.push_back(chunk.materials[s].name);
+                    ranges.emplace_back();
+                }
+                currentMaterial = inserted.first->second;
+            }
+        }
+    }
+
+    // 每个材质一个网格，网格之间并行去重顶点
+    scene.meshes.assign(materialNames.size(), ObjMesh());
+    runParallel(materialNames.size(), numThreads, [&](size_t m)
+                {
+        ObjMesh &mesh = scene.meshes[m];
+        mesh.material = materialNames[m];
+        size_t numCorners = 0;
+        for (const FaceRange &range : ranges[m])
+            for (uint32_t f = range.begin; f < range.end; f++)
+                numCorners += chunks[range.chunk].faces[f].numCorners;
+        if (numCorners == 0)
+            return;
+
+        VertexCache cache(std::min(numCorners, numPositions + numPositions / 2));
+        std::vector<bool> missingNormal;
+        bool anyMissingNormal = false;
+        mesh.indices.reserve(numCorners * 3 / 2);
+
+        uint32_t corner[3];
+        for (const FaceRange &range : ranges[m])
+        {
+            const Chunk &chunk = chunks[range.chunk];
+            for (uint32_t f = range.begin; f < range.end; f++)
+            {
+                const Face &face = chunk.faces[f];
+                const uint32_t *local = face.relative >= 0 ? &chunk.relativeBase[face.relative * 3] : nullptr;
+                uint32_t fanFirst = 0, fanPrev = 0;
+                bool valid = true;
+                for (uint32_t k = 0; k < face.numCorners && valid; k++)
+                {
+                    const FaceCorner &fc = chunk.corners[face.firstCorner + k];
+                    // 正索引为 1 基全局下标，负索引相对于该面之前已出现的数量
+                    int64_t v = fc.v > 0 ? fc.v - 1 : int64_t(vBase[range.chunk]) + local[0] + fc.v;
+                    int64_t vt = fc.vt > 0 ? fc.vt - 1 : fc.vt < 0 ? int64_t(vtBase[range.chunk]) + local[1] + fc.vt : -1;
+                    int64_t vn = fc.vn > 0 ? fc.vn - 1 : fc.vn < 0 ? int64_t(vnBase[range.chunk]) + local[2] + fc.vn : -1;
+                    if (v < 0 || v >= int64_t(numPositions))
+                    {
+                        valid = false;
+                        break;
+                    }
+                    if (vt >= int64_t(numTexCoords))
+                        vt = -1;
+                    if (vn >= int64_t(numNormals))
+                        vn = -1;
+
+                    uint32_t candidate = static_cast<uint32_t>(mesh.vertices.size());
+                    uint32_t index = cache.findOrInsert(int(v), int(vt), int(vn), candidate);
+                    if (index == candidate)
+                    {
+                        Vertex vertex;
+                        auto fetch = [&](const std::vector<uint32_t> &base, size_t stride, int64_t global,
+                                         std::vector<float> Chunk::*array) -> const float *
+                        {
+                            // 在块起始下标中二分查找所属块
+                            size_t c = std::upper_bound(base.begin(), base.end(), uint32_t(global)) - base.begin() - 1;
+                            return &(chunks[c].*array)[(global - base[c]) * stride];
+                        };
+                        const float *pos = fetch(vBase, 3, v, &Chunk::positions);
+                        vertex.Position = glm::vec3(pos[0], pos[1], pos[2]);
+                        if (vn >= 0)
+                        {
+                            const float *n = fetch(vnBase, 3, vn, &Chunk::normals);
+                            vertex.Normal = glm::vec3(n[0], n[1], n[2]);
+                        }
+                        else
+                            vertex.Normal = glm::vec3(0.0f);
+                        if (vt >= 0)
+                        {
+                            const float *t = fetch(vtBase, 2, vt, &Chunk::texCoords);
+                            vertex.TexCoords = glm::vec2(t[0], t[1]);
+                        }
+                        else
+                            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+                        mesh.vertices.push_back(vertex);
+                        missingNormal.push_back(vn < 0);
+                        anyMissingNormal |= vn < 0;
+                    }
+
+                    // 扇形三角化，与 aiProcess_Triangulate 对凸多边形的结果一致
+                    if (k == 0)
+                        fanFirst = index;
+                    else if (k >= 2)
+                    {
+                        corner[0] = fanFirst;
+                        corner[1] = fanPrev;
+                        corner[2] = index;
+                        mesh.indices.insert(mesh.indices.end(), corner, corner + 3);
+                    }
+                    fanPrev = index;
+                }
+            }
+        }
+
+        // 缺少 vn 的顶点用相邻三角形的面积加权法线补齐
+        if (anyMissingNormal)
+        {
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+            {
+                Vertex &a = mesh.vertices[mesh.indices[i]];
+                Vertex &b = mesh.vertices[mesh.indices[i + 1]];
+                Vertex &c = mesh.vertices[mesh.indices[i + 2]];
+                glm::vec3 n = glm::cross(b.Position - a.Position, c.Position - a.Position);
+                if (missingNormal[mesh.indices[i]])
+                    a.Normal += n;
+                if (missingNormal[mesh.indices[i + 1]])
+                    b.Normal += n;
+                if (missingNormal[mesh.indices[i + 2]])
+                    c.Normal += n;
+            }
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+                if (missingNormal[i] && glm::dot(mesh.vertices[i].Normal, mesh.vertices[i].Normal) > 0.0f)
+                    mesh.vertices[i].Normal = glm::normalize(mesh.vertices[i].Normal);
+        } });
+
+    scene.meshes.erase(std::remove_if(scene.meshes.begin(), scene.meshes.end(), [](const ObjMesh &mesh)
+                                      { return mesh.indices.empty(); }),
+                       scene.meshes.end());
+
+    std::string directory = path.substr(0, path.find_last_of('/'));
+    for (const Chunk &chunk : chunks)
+        for (const std::string &lib : chunk.mtllibs)
+            loadMtl(directory + '/' + lib, scene.materials);
+
+    return !scene.meshes.empty();
+}
@@ -0,0 +1,35 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <string>
+#include <vector>
+#include "vertex.h"
+
+// 不经过 Assimp 的 OBJ/MTL 解析器
+// 文件通过内存映射读入，按行边界切块后多线程并行解析，
+// 输出与 Model::processMesh 相同的顶点/索引格式（三角化、翻转 V、去重顶点）
+
+struct ObjMaterial
+{
+    std::string name;
+    std::string diffuseMap; // map_Kd，相对于 OBJ 所在目录
+    std::string normalMap;  // map_Bump / bump，按切线空间法线贴图使用
+};
+
+struct ObjMesh
+{
+    std::string material; // usemtl 名称
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+struct ObjScene
+{
+    std::vector<ObjMesh> meshes;
+    std::vector<ObjMaterial> materials;
+};
+
+// numThreads 为 0 时使用硬件线程数
+bool loadObj(const std::string &path, ObjScene &scene, unsigned int numThreads = 0);
+
+#endif
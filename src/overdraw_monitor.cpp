@@ -0,0 +1,96 @@
+#include "overdraw_monitor.h"
+
+#include <algorithm>
+
+constexpr float OverdrawMonitor::ENABLE_RATIO;
+constexpr float OverdrawMonitor::DISABLE_RATIO;
+
+OverdrawMonitor::~OverdrawMonitor()
+{
+    destroy();
+}
+
+void OverdrawMonitor::create()
+{
+    destroy();
+    for (Frame &frame : frames)
+        glGenQueries(2, frame.queries);
+}
+
+void OverdrawMonitor::destroy()
+{
+    for (Frame &frame : frames)
+    {
+        if (frame.queries[0])
+            glDeleteQueries(2, frame.queries);
+        frame = Frame();
+    }
+    active = -1;
+    smoothed = 0.0f;
+    measured = exact = recommended = false;
+    hold = 0;
+}
+
+void OverdrawMonitor::beginFrame(long long pixels)
+{
+    frameIndex = (frameIndex + 1) % FRAMES;
+    Frame &frame = frames[frameIndex];
+    if (!frame.queries[0])
+        return;
+    // 这组查询是两帧前发出的，复用之前先取结果
+    resolve(frame);
+    frame.issued[0] = frame.issued[1] = false;
+    frame.pixels = pixels;
+
+    if (hold > 0)
+        hold--;
+    else if (measured && !recommended && smoothed > ENABLE_RATIO)
+        recommended = true, hold = HOLD_FRAMES;
+    else if (measured && recommended && smoothed < DISABLE_RATIO)
+        recommended = false, hold = HOLD_FRAMES;
+}
+
+void OverdrawMonitor::beginPass(Pass pass)
+{
+    Frame &frame = frames[frameIndex];
+    if (!frame.queries[0] || active >= 0)
+        return;
+    active = static_cast<int>(pass);
+    glBeginQuery(GL_SAMPLES_PASSED, frame.queries[active]);
+    frame.issued[active] = true;
+}
+
+void OverdrawMonitor::endPass()
+{
+    if (active < 0)
+        return;
+    glEndQuery(GL_SAMPLES_PASSED);
+    active = -1;
+}
+
+void OverdrawMonitor::resolve(Frame &frame)
+{
+    const int depth = static_cast<int>(Pass::Depth), color = static_cast<int>(Pass::Color);
+    if (!frame.issued[color] || frame.pixels <= 0)
+        return;
+    GLuint results[2] = {0, 0};
+    for (int i = 0; i < 2; i++)
+    {
+        if (!frame.issued[i])
+            continue;
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+        glGetQueryObjectuiv(frame.queries[i], GL_QUERY_RESULT, &results[i]);
+    }
+    bool withPrepass = frame.issued[depth];
+    float sample = withPrepass ? float(results[depth]) / std::max(results[color], 1u) : float(results[color]) / frame.pixels;
+    // 两种估计的含义不同，切换时重新开始平滑
+    if (!measured || withPrepass != exact)
+        smoothed = sample;
+    else
+        smoothed += (sample - smoothed) * 0.1f;
+    measured = true;
+    exact = withPrepass;
+}
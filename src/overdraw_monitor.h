@@ -0,0 +1,65 @@
+#ifndef OVERDRAW_MONITOR_H
+#define OVERDRAW_MONITOR_H
+
+#include <glad/glad.h>
+
+// 重叠绘制（overdraw）统计与深度预通道的自动开关（只在渲染线程使用）
+// 深度预通道和颜色通道各用一个 GL_SAMPLES_PASSED 查询统计通过深度测试的片段数，
+// 查询与 Profiler 一样按帧双缓冲：第 N 帧开始时读取第 N-2 帧的结果，未就绪时丢弃而不是等待。
+//   有预通道的帧：预通道按绘制顺序做 GL_LESS，通过数就是没有预通道时颜色通道要着色的片段数，
+//                颜色通道（GL_EQUAL）只着色可见像素，两者之比是准确的 overdraw
+//   没有预通道的帧：只知道着色片段数，按整个视口估计（未覆盖的像素算作 0 层，结果偏低）
+// 估计值平滑后带滞回地决定是否建议开启预通道，切换后保持 HOLD_FRAMES 帧不再改变。
+class OverdrawMonitor
+{
+public:
+    static const unsigned int FRAMES = 2;
+    static const unsigned int HOLD_FRAMES = 60;
+    static constexpr float ENABLE_RATIO = 1.5f;  // 平均每像素着色超过 1.5 次时开启
+    static constexpr float DISABLE_RATIO = 1.2f; // 低于 1.2 次时预通道多画一遍几何不划算，关闭
+
+    enum class Pass
+    {
+        Depth,
+        Color
+    };
+
+    OverdrawMonitor() {}
+    ~OverdrawMonitor();
+    OverdrawMonitor(const OverdrawMonitor &) = delete;
+    OverdrawMonitor &operator=(const OverdrawMonitor &) = delete;
+
+    void create();
+    void destroy();
+
+    // pixels 为本帧视口像素数
+    void beginFrame(long long pixels);
+    // 每帧每种通道最多一次，不能嵌套
+    void beginPass(Pass pass);
+    void endPass();
+
+    // 平滑后的平均每个可见像素的着色次数，还没有结果时为 0
+    float overdraw() const { return smoothed; }
+    // 最近一次取回的结果是否来自有预通道的帧（即 overdraw 是否为准确值）
+    bool isExact() const { return exact; }
+    bool recommendPrepass() const { return recommended; }
+
+private:
+    struct Frame
+    {
+        GLuint queries[2] = {0, 0};
+        bool issued[2] = {false, false};
+        long long pixels = 0;
+    };
+
+    void resolve(Frame &frame);
+
+    Frame frames[FRAMES];
+    unsigned int frameIndex = 0;
+    int active = -1;
+    float smoothed = 0.0f;
+    bool measured = false, exact = false, recommended = false;
+    unsigned int hold = 0;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "post_process.h"
+#include "shader_variants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+PostProcess::~PostProcess()
+{
+    destroy();
+}
+
+bool PostProcess::create()
+{
+    destroy();
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    // 还没有测光时按平均亮度 0.18 处理，即曝光为 1
+    const float initial = std::log2(0.18f);
+    bool complete = true;
+    glGenTextures(2, exposureTargets);
+    glGenFramebuffers(2, exposureFbos);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, exposureTargets[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, 1, 1, 0, GL_RED, GL_FLOAT, &initial);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, exposureFbos[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, exposureTargets[i], 0);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    if (!complete)
+    {
+        std::cerr << "ERROR::POST_PROCESS::INCOMPLETE" << std::endl;
+        destroy();
+        return false;
+    }
+    glGenVertexArrays(1, &fullscreenVAO);
+    currentExposure = 0;
+    exposureValid = false;
+    return true;
+}
+
+void PostProcess::destroy()
+{
+    if (exposureFbos[0])
+        glDeleteFramebuffers(2, exposureFbos);
+    if (exposureTargets[0])
+        glDeleteTextures(2, exposureTargets);
+    if (fullscreenVAO)
+        glDeleteVertexArrays(1, &fullscreenVAO);
+    exposureFbos[0] = exposureFbos[1] = exposureTargets[0] = exposureTargets[1] = 0;
+    fullscreenVAO = 0;
+    scene = nullptr;
+    levelCount = 0;
+}
+
+bool PostProcess::beginScene(RenderTargetPool &targetPool, int width, int height)
+{
+    pool = &targetPool;
+    scene = pool->acquire(width, height, GL_RGBA16F, true);
+    if (!scene)
+        return false;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    scene->bind();
+    levelCount = 0;
+    return true;
+}
+
+void PostProcess::drawFullscreen(GLuint program) const
+{
+    glUseProgram(program);
+    glBindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+}
+
+void PostProcess::measureExposure(GLuint histogram, GLuint exposure)
+{
+    if (!scene || !histogram || !exposure)
+        return;
+    const RenderTarget *bins = pool->acquire(HISTOGRAM_BINS, 1, GL_R32F);
+    if (!bins)
+        return;
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glDisable(GL_DEPTH_TEST);
+
+    // 直方图：每个测光点是一个落在对应格子上的点，加法混合计数
+    bins->bind();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glActiveTexture(GL_TEXTURE0 + POST_SOURCE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, scene->color);
+    glUseProgram(histogram);
+    glBindVertexArray(fullscreenVAO);
+    int columns = std::max(1, scene->width / METER_STRIDE), rows = std::max(1, scene->height / METER_STRIDE);
+    glDrawArrays(GL_POINTS, 0, columns * rows);
+    glDisable(GL_BLEND);
+
+    // 平均亮度：读上一帧的结果，写另一张
+    int next = 1 - currentExposure;
+    glBindFramebuffer(GL_FRAMEBUFFER, exposureFbos[next]);
+    glViewport(0, 0, 1, 1);
+    glBindTexture(GL_TEXTURE_2D, bins->color);
+    glActiveTexture(GL_TEXTURE0 + POST_EXPOSURE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, exposureTargets[currentExposure]);
+    drawFullscreen(exposure);
+    glBindTexture(GL_TEXTURE_2D, exposureTargets[next]);
+    glActiveTexture(GL_TEXTURE0);
+    currentExposure = next;
+    exposureValid = true;
+
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glEnable(GL_DEPTH_TEST);
+    pool->release(bins);
+}
+
+int PostProcess::bloomLevelCount(int width, int height, int requested)
+{
+    int count = 0;
+    while (count < std::min(requested, MAX_BLOOM_LEVELS))
+    {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        if (width < 2 || height < 2)
+            break;
+        count++;
+    }
+    return count;
+}
+
+void PostProcess::bloom(GLuint prefilter, GLuint downsample, GLuint upsample, int requested)
+{
+    if (!scene || !prefilter || !downsample || !upsample)
+        return;
+    int count = bloomLevelCount(scene->width, scene->height, requested);
+    int width = scene->width, height = scene->height;
+    levelCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        // 泛光只需要颜色，11/11/10 位浮点比 RGBA16F 省一半带宽
+        levels[i] = pool->acquire(width, height, GL_R11F_G11F_B10F);
+        if (!levels[i])
+            break;
+        levelCount++;
+    }
+    if (levelCount == 0)
+        return;
+
+    glDisable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0 + POST_EXPOSURE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, exposureTargets[currentExposure]);
+    glActiveTexture(GL_TEXTURE0 + POST_SOURCE_TEXTURE_UNIT);
+    for (int i = 0; i < levelCount; i++)
+    {
+        levels[i]->bind();
+        glBindTexture(GL_TEXTURE_2D, i == 0 ? scene->color : levels[i - 1]->color);
+        drawFullscreen(i == 0 ? prefilter : downsample);
+    }
+    // 上一级已有降采样的内容，上采样结果直接加上去
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    for (int i = levelCount - 2; i >= 0; i--)
+    {
+        levels[i]->bind();
+        glBindTexture(GL_TEXTURE_2D, levels[i + 1]->color);
+        drawFullscreen(upsample);
+    }
+    glDisable(GL_BLEND);
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void PostProcess::composite(GLuint tonemap)
+{
+    if (!scene)
+        return;
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (tonemap)
+    {
+        // 没有泛光时绑定 0：不完整的纹理采样结果为 0
+        glActiveTexture(GL_TEXTURE0 + POST_SOURCE_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, scene->color);
+        glActiveTexture(GL_TEXTURE0 + POST_BLOOM_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, levelCount > 0 ? levels[0]->color : 0);
+        glActiveTexture(GL_TEXTURE0 + POST_EXPOSURE_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, exposureTargets[currentExposure]);
+        glActiveTexture(GL_TEXTURE0);
+        glDisable(GL_DEPTH_TEST);
+        drawFullscreen(tonemap);
+        glEnable(GL_DEPTH_TEST);
+    }
+    else
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, scene->fbo);
+        glBlitFramebuffer(0, 0, scene->width, scene->height, previousViewport[0], previousViewport[1], previousViewport[0] + previousViewport[2],
+                          previousViewport[1] + previousViewport[3], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    }
+
+    for (int i = 0; i < levelCount; i++)
+        pool->release(levels[i]);
+    pool->release(scene);
+    scene = nullptr;
+}
@@ -0,0 +1,64 @@
+#ifndef POST_PROCESS_H
+#define POST_PROCESS_H
+
+#include <glad/glad.h>
+#include "render_target_pool.h"
+
+// HDR 后处理：场景画进 RGBA16F 目标，之后
+//   曝光：顶点着色器每 METER_STRIDE x METER_STRIDE 像素取一个点，按 log2 亮度落到直方图的一格，加法混合累加成
+//        HISTOGRAM_BINS x 1 的直方图（GL 3.3 没有计算着色器，用点图元散射代替）；1x1 的通道按百分位去掉最暗和最亮的部分，
+//        求平均 log2 亮度并向上一帧的结果靠拢（shaders/luminance_histogram_*.glsl、exposure_fragment.glsl）
+//   泛光：按曝光后的亮度阈值预滤波并降采样到半分辨率，再逐级降采样成金字塔（13 点滤波，第 0 级用 Karis 平均压住单像素高光），
+//        然后从最小一级开始 3x3 帐篷滤波上采样、加法混合到上一级，结果留在第 0 级（shaders/bloom_*.glsl）
+//   合成：场景加泛光，乘以曝光，ACES 色调映射后转成 sRGB，写回原来的帧缓冲（shaders/tonemap_fragment.glsl）
+// 场景、金字塔各级和直方图都从 RenderTargetPool 借、合成后归还；这里只持有跨帧的适应状态（两个 1x1 的平均亮度轮流读写）
+class PostProcess
+{
+public:
+    static const int HISTOGRAM_BINS = 64; // 与着色器中的常量一致
+    static const int METER_STRIDE = 4;
+    static const int MAX_BLOOM_LEVELS = 8;
+
+    PostProcess() {}
+    ~PostProcess();
+    PostProcess(const PostProcess &) = delete;
+    PostProcess &operator=(const PostProcess &) = delete;
+
+    bool create();
+    void destroy();
+
+    // 从池中借场景目标（带深度）并绑定；保存原来的帧缓冲和视口，合成时写回那里。由调用者清空
+    bool beginScene(RenderTargetPool &pool, int width, int height);
+    // 以下在场景画完后依次调用，程序为 0（变体还没就绪）时跳过该步
+    // 测光结果绑定到 POST_EXPOSURE_TEXTURE_UNIT，泛光的预滤波和合成都读它
+    void measureExposure(GLuint histogram, GLuint exposure);
+    // levels 为金字塔层数，实际层数见 bloomLevelCount
+    void bloom(GLuint prefilter, GLuint downsample, GLuint upsample, int levels);
+    // 合成后把本帧借的目标都还给池；tonemap 为 0 时直接复制到原来的帧缓冲
+    void composite(GLuint tonemap);
+
+    // 下一次测光直接采用，不做过渡（场景跳变、视口变化时）
+    void resetExposure() { exposureValid = false; }
+    bool hasExposure() const { return exposureValid; }
+    // width x height 的场景实际生成的泛光层数：第 0 级为半分辨率，最小一级不小于 2x2，最多 MAX_BLOOM_LEVELS
+    static int bloomLevelCount(int width, int height, int requested);
+    // 最近一帧实际生成的泛光层数
+    int bloomLevels() const { return levelCount; }
+    const RenderTarget *sceneTarget() const { return scene; }
+
+private:
+    RenderTargetPool *pool = nullptr;
+    const RenderTarget *scene = nullptr;
+    const RenderTarget *levels[MAX_BLOOM_LEVELS] = {};
+    int levelCount = 0;
+    GLuint exposureFbos[2] = {0, 0}, exposureTargets[2] = {0, 0};
+    int currentExposure = 0; // 最近一次结果所在的下标
+    bool exposureValid = false;
+    GLuint fullscreenVAO = 0;
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4] = {};
+
+    void drawFullscreen(GLuint program) const;
+};
+
+#endif
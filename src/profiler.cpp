@@ -0,0 +1,296 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "imgui.h"
+
+namespace
+{
+    uint64_t nowNs()
+    {
+        using namespace std::chrono;
+        return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 按名字取稳定的颜色，同名作用域在每帧的火焰图中颜色一致
+    ImU32 scopeColor(const char *name)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char *c = name; *c; c++)
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+        return IM_COL32(90 + hash % 120, 90 + (hash >> 8) % 120, 90 + (hash >> 16) % 120, 255);
+    }
+}
+
+Profiler::~Profiler()
+{
+    destroy();
+}
+
+void Profiler::create()
+{
+    // 3.3 核心包含 ARB_timer_query；时间戳精度为 0 表示驱动不支持
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    timerQueries = bits > 0;
+    if (!timerQueries)
+        std::cerr << "ERROR::PROFILER::NO_TIMER_QUERY" << std::endl;
+    calibrateIn = 0;
+}
+
+void Profiler::calibrate()
+{
+    // GPU 与 CPU 时钟的差值会缓慢漂移，定期重新取一次
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuOffset = static_cast<int64_t>(nowNs()) - gpuNow;
+    calibrateIn = HISTORY;
+}
+
+void Profiler::destroy()
+{
+    for (Frame &frame : frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        frame.queries.clear();
+        frame.usedQueries = 0;
+        frame.pending = false;
+    }
+    timerQueries = false;
+}
+
+void Profiler::beginFrame()
+{
+    frameIndex = (frameIndex + 1) % FRAMES;
+    Frame &frame = frames[frameIndex];
+    // 这组查询是两帧前发出的，复用之前先取结果
+    if (frame.pending)
+        resolve(frame);
+    if (timerQueries && calibrateIn-- == 0)
+        calibrate();
+    frame.scopes.clear();
+    frame.usedQueries = 0;
+    frame.pending = false;
+    inFrame = true;
+    current = -1;
+}
+
+void Profiler::endFrame()
+{
+    // 未结束的作用域按帧末结束
+    while (current >= 0)
+        endScope(current);
+    inFrame = false;
+    frames[frameIndex].pending = !frames[frameIndex].scopes.empty();
+}
+
+GLuint Profiler::acquireQuery(Frame &frame, int &index)
+{
+    if (frame.usedQueries == frame.queries.size())
+    {
+        size_t grow = std::max<size_t>(16, frame.queries.size());
+        frame.queries.resize(frame.queries.size() + grow);
+        glGenQueries(static_cast<GLsizei>(grow), frame.queries.data() + frame.usedQueries);
+    }
+    index = static_cast<int>(frame.usedQueries);
+    return frame.queries[frame.usedQueries++];
+}
+
+int Profiler::beginScope(const char *name, bool gpu)
+{
+    if (!inFrame)
+        return -1;
+    Frame &frame = frames[frameIndex];
+    Scope scope;
+    scope.name = name;
+    scope.parent = current;
+    scope.depth = current >= 0 ? frame.scopes[current].depth + 1 : 0;
+    if (gpu && timerQueries)
+        glQueryCounter(acquireQuery(frame, scope.queryBegin), GL_TIMESTAMP);
+    scope.cpuBegin = nowNs();
+    frame.scopes.push_back(scope);
+    current = static_cast<int>(frame.scopes.size() - 1);
+    return current;
+}
+
+void Profiler::endScope(int index)
+{
+    if (!inFrame || index < 0)
+        return;
+    Frame &frame = frames[frameIndex];
+    Scope &scope = frame.scopes[index];
+    scope.cpuEnd = nowNs();
+    if (Trace::isEnabled())
+        Trace::record(scope.name, scope.cpuBegin, scope.cpuEnd);
+    if (scope.queryBegin >= 0)
+        glQueryCounter(acquireQuery(frame, scope.queryEnd), GL_TIMESTAMP);
+    current = scope.parent;
+}
+
+void Profiler::resolve(Frame &frame)
+{
+    frame.pending = false;
+    bool gpu = frame.usedQueries > 0;
+    if (gpu)
+    {
+        // 最后一个查询就绪意味着之前的都已就绪
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            ++droppedGpuFrames;
+            gpu = false;
+        }
+    }
+    for (Scope &scope : frame.scopes)
+    {
+        if (gpu && scope.queryBegin >= 0 && scope.queryEnd >= 0)
+        {
+            GLuint64 value = 0;
+            glGetQueryObjectui64v(frame.queries[scope.queryBegin], GL_QUERY_RESULT, &value);
+            scope.gpuBegin = value;
+            glGetQueryObjectui64v(frame.queries[scope.queryEnd], GL_QUERY_RESULT, &value);
+            scope.gpuEnd = value;
+            if (Trace::isEnabled())
+                Trace::record(scope.name, scope.gpuBegin + gpuOffset, scope.gpuEnd + gpuOffset, Trace::GPU);
+        }
+        else
+        {
+            scope.queryBegin = scope.queryEnd = -1;
+        }
+    }
+
+    resolved = frame.scopes;
+    resolvedGpu = gpu;
+    paths.resize(resolved.size());
+    for (size_t i = 0; i < resolved.size(); i++)
+    {
+        const Scope &scope = resolved[i];
+        paths[i] = scope.parent >= 0 ? paths[scope.parent] + "/" + scope.name : scope.name;
+        History &history = histories[paths[i]];
+        history.cpu[history.head] = (scope.cpuEnd - scope.cpuBegin) / 1e6f;
+        bool hasGpu = scope.queryBegin >= 0;
+        history.gpu[history.head] = hasGpu ? (scope.gpuEnd - scope.gpuBegin) / 1e6f : 0.0f;
+        history.hasGpu = history.hasGpu || hasGpu;
+        history.head = (history.head + 1) % HISTORY;
+        history.count = std::min(history.count + 1, HISTORY);
+    }
+}
+
+Profiler::Stats Profiler::summarize(const float *values, unsigned int count)
+{
+    Stats stats;
+    if (count == 0)
+        return stats;
+    std::vector<float> sorted(values, values + count);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float value : sorted)
+        sum += value;
+    stats.min = sorted.front();
+    stats.avg = static_cast<float>(sum / count);
+    stats.p99 = sorted[std::min<size_t>(count - 1, static_cast<size_t>(count * 0.99f))];
+    return stats;
+}
+
+bool Profiler::stats(const std::string &path, Stats &cpu, Stats &gpu) const
+{
+    auto it = histories.find(path);
+    if (it == histories.end())
+        return false;
+    cpu = summarize(it->second.cpu, it->second.count);
+    gpu = it->second.hasGpu ? summarize(it->second.gpu, it->second.count) : Stats();
+    return true;
+}
+
+void Profiler::drawWindow()
+{
+    ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!timerQueries)
+        ImGui::Text("GPU timer queries unavailable, CPU scopes only");
+    else
+        ImGui::Text("GPU results dropped (not ready after %u frames): %llu", FRAMES, (unsigned long long)droppedGpuFrames);
+
+    // 跟踪：录制期间事件留在各线程缓冲，保存时取走
+    bool recording = Trace::isEnabled();
+    if (ImGui::Checkbox("Record trace", &recording))
+        Trace::setEnabled(recording);
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace.json"))
+        Trace::write("trace.json");
+    ImGui::SameLine();
+    ImGui::Text("dropped %llu", (unsigned long long)Trace::dropped());
+
+    // 统计表，按最近一帧的作用域顺序（即调用树的先序）排列
+    if (ImGui::BeginTable("scopes", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+    {
+        const char *headers[] = {"scope", "cpu min", "cpu avg", "cpu p99", "gpu min", "gpu avg", "gpu p99"};
+        for (const char *header : headers)
+            ImGui::TableSetupColumn(header);
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < resolved.size(); i++)
+        {
+            Stats cpu, gpu;
+            if (!stats(paths[i], cpu, gpu))
+                continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", resolved[i].depth * 2, "", resolved[i].name);
+            float values[] = {cpu.min, cpu.avg, cpu.p99, gpu.min, gpu.avg, gpu.p99};
+            bool hasGpu = histories.at(paths[i]).hasGpu;
+            for (int v = 0; v < 6; v++)
+            {
+                ImGui::TableNextColumn();
+                if (v < 3 || hasGpu)
+                    ImGui::Text("%6.3f", values[v]);
+                else
+                    ImGui::TextDisabled("   -");
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    // 火焰图：上半部分 CPU，下半部分 GPU，横轴为该帧各自时钟下的时间
+    int maxDepth = 0;
+    uint64_t cpuFirst = UINT64_MAX, cpuLast = 0, gpuFirst = UINT64_MAX, gpuLast = 0;
+    for (const Scope &scope : resolved)
+    {
+        maxDepth = std::max(maxDepth, scope.depth);
+        cpuFirst = std::min(cpuFirst, scope.cpuBegin);
+        cpuLast = std::max(cpuLast, scope.cpuEnd);
+        if (scope.queryBegin >= 0)
+        {
+            gpuFirst = std::min(gpuFirst, scope.gpuBegin);
+            gpuLast = std::max(gpuLast, scope.gpuEnd);
+        }
+    }
+    const float width = 480.0f, row = ImGui::GetTextLineHeight() + 4.0f;
+    int lanes = resolvedGpu ? 2 : 1;
+    ImDrawList *draw = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+    for (int lane = 0; lane < lanes && !resolved.empty(); lane++)
+    {
+        uint64_t first = lane == 0 ? cpuFirst : gpuFirst;
+        uint64_t span = std::max<uint64_t>(1, (lane == 0 ? cpuLast : gpuLast) - first);
+        float top = origin.y + lane * (maxDepth + 1) * row + lane * row * 0.5f;
+        for (const Scope &scope : resolved)
+        {
+            if (lane == 1 && scope.queryBegin < 0)
+                continue;
+            uint64_t begin = lane == 0 ? scope.cpuBegin : scope.gpuBegin;
+            uint64_t end = lane == 0 ? scope.cpuEnd : scope.gpuEnd;
+            ImVec2 a(origin.x + width * (begin - first) / span, top + scope.depth * row);
+            ImVec2 b(std::max(a.x + 1.0f, origin.x + width * (end - first) / span), a.y + row - 1.0f);
+            draw->AddRectFilled(a, b, scopeColor(scope.name));
+            if (b.x - a.x > ImGui::CalcTextSize(scope.name).x + 4.0f)
+                draw->AddText(ImVec2(a.x + 2.0f, a.y + 2.0f), IM_COL32(0, 0, 0, 255), scope.name);
+            if (mouse.x >= a.x && mouse.x < b.x && mouse.y >= a.y && mouse.y < b.y)
+                ImGui::SetTooltip("%s %s: %.3f ms", lane == 0 ? "CPU" : "GPU", scope.name, (end - begin) / 1e6);
+        }
+    }
+    ImGui::Dummy(ImVec2(width, lanes * (maxDepth + 1) * row + (lanes - 1) * row * 0.5f));
+    ImGui::End();
+}
@@ -0,0 +1,112 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "trace.h"
+
+// 帧分析器（只在渲染线程使用）
+// CPU 作用域用 steady_clock 计时，可以任意嵌套；GPU 作用域在开始和结束各插入一个 GL_TIMESTAMP 查询。
+// GL_TIME_ELAPSED 同一时间只能有一个查询处于活动状态，无法嵌套，所以用成对的时间戳代替。
+// 查询按帧双缓冲：第 N 帧开始时读取第 N-2 帧的结果，结果未就绪时丢弃该帧的 GPU 数据而不是等待。
+// 每个作用域按路径（父路径/名字）累计最近 HISTORY 帧，界面显示 min/avg/p99 和最近一帧的火焰图。
+// 开启 Trace 时 CPU 作用域同时写入跟踪，GPU 作用域在取回结果后换算到 CPU 时钟写入 GPU 时间线。
+class Profiler
+{
+public:
+    static const unsigned int FRAMES = 2;
+    static const unsigned int HISTORY = 240;
+
+    struct Stats
+    {
+        float min = 0.0f, avg = 0.0f, p99 = 0.0f;
+    };
+
+    Profiler() {}
+    ~Profiler();
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    // 需要当前 GL 上下文；没有 ARB_timer_query 时只记录 CPU 作用域
+    void create();
+    void destroy();
+
+    void beginFrame();
+    void endFrame();
+
+    // 返回作用域下标，不在帧内时返回 -1
+    int beginScope(const char *name, bool gpu = false);
+    void endScope(int scope);
+
+    // ImGui 面板：统计表 + 火焰图
+    void drawWindow();
+
+    // 某个作用域路径最近 HISTORY 帧的统计，路径不存在时返回 false
+    bool stats(const std::string &path, Stats &cpu, Stats &gpu) const;
+
+private:
+    struct Scope
+    {
+        const char *name = nullptr;
+        int parent = -1;
+        int depth = 0;
+        uint64_t cpuBegin = 0, cpuEnd = 0; // 纳秒
+        int queryBegin = -1, queryEnd = -1;
+        uint64_t gpuBegin = 0, gpuEnd = 0; // 纳秒，GPU 时钟
+    };
+
+    struct Frame
+    {
+        std::vector<Scope> scopes;
+        std::vector<GLuint> queries;
+        size_t usedQueries = 0;
+        bool pending = false; // 查询结果尚未读取
+    };
+
+    struct History
+    {
+        float cpu[HISTORY];
+        float gpu[HISTORY];
+        unsigned int count = 0, head = 0;
+        bool hasGpu = false;
+    };
+
+    bool timerQueries = false;
+    int64_t gpuOffset = 0;     // CPU 纳秒 - GPU 纳秒
+    unsigned int calibrateIn = 0; // 距下次校准 GPU 时钟的帧数
+    Frame frames[FRAMES];
+    unsigned int frameIndex = 0;
+    bool inFrame = false;
+    int current = -1;
+
+    std::vector<Scope> resolved;      // 最近一帧 GPU 结果就绪的完整数据
+    std::vector<std::string> paths;   // 与 resolved 对应的路径
+    bool resolvedGpu = false;
+    std::unordered_map<std::string, History> histories;
+    uint64_t droppedGpuFrames = 0;
+
+    GLuint acquireQuery(Frame &frame, int &index);
+    void calibrate();
+    void resolve(Frame &frame);
+    static Stats summarize(const float *values, unsigned int count);
+};
+
+// RAII 作用域标记
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler &profiler, const char *name, bool gpu = false)
+        : profiler(profiler), scope(profiler.beginScope(name, gpu)) {}
+    ~ProfileScope() { profiler.endScope(scope); }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Profiler &profiler;
+    int scope;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "program_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+static PFNGLGETPROGRAMBINARYPROC getProgramBinary = nullptr;
+static PFNGLPROGRAMBINARYPROC programBinary = nullptr;
+static PFNGLPROGRAMPARAMETERIPROC programParameteri = nullptr;
+
+static std::string cacheDirectory;
+static std::string driver; // 厂商/渲染器/版本，参与键的计算
+static ProgramCache::Stats counters;
+static std::mutex countersMutex;
+
+namespace
+{
+    const uint32_t MAGIC = 0x4E494250; // "PBIN"
+    const uint32_t FILE_VERSION = 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t sourceLength;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    // FNV-1a，各段之间插入 0 字节避免拼接歧义
+    uint64_t hashString(uint64_t hash, const std::string &text)
+    {
+        for (unsigned char c : text)
+            hash = (hash ^ c) * 1099511628211ull;
+        return (hash ^ 0) * 1099511628211ull;
+    }
+
+    uint64_t programKey(const std::string &vertexSource, const std::string &fragmentSource)
+    {
+        uint64_t key = 14695981039346656037ull;
+        key = hashString(key, vertexSource);
+        key = hashString(key, fragmentSource);
+        return hashString(key, driver);
+    }
+
+    std::string programPath(uint64_t key)
+    {
+        char name[24];
+        std::snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+        return cacheDirectory + name;
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    GLuint compileStage(GLenum type, const std::string &source, const char *stage)
+    {
+        const char *code = source.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        int success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+}
+
+void ProgramCache::loadExtensions(GLADloadproc load)
+{
+    getProgramBinary = nullptr;
+    programBinary = nullptr;
+    programParameteri = nullptr;
+    bool available = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1);
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count && !available; i++)
+    {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        available = name && std::strcmp(name, "GL_ARB_get_program_binary") == 0;
+    }
+    GLint formats = 0;
+    if (available)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    // 例如 Mesa 关闭磁盘着色器缓存时不提供任何格式
+    if (formats > 0)
+    {
+        getProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+        programBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(load("glProgramBinary"));
+        programParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+    }
+    driver.clear();
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const GLubyte *value = glGetString(name);
+        driver += value ? reinterpret_cast<const char *>(value) : "";
+        driver += '\n';
+    }
+}
+
+bool ProgramCache::isSupported()
+{
+    return getProgramBinary && programBinary && programParameteri;
+}
+
+void ProgramCache::setDirectory(const std::string &directory)
+{
+    cacheDirectory = directory;
+    if (directory.empty())
+        return;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cerr << "ERROR::PROGRAM_CACHE::CANNOT_CREATE_DIRECTORY " << directory << " " << error.message() << std::endl;
+        cacheDirectory.clear();
+    }
+}
+
+GLuint ProgramCache::compile(const std::string &vertexSource, const std::string &fragmentSource, bool retrievable)
+{
+    GLuint vertex = compileStage(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+    GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (retrievable)
+        setRetrievable(program);
+    glLinkProgram(program);
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        program = 0;
+    }
+
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
+
+bool ProgramCache::isEnabled()
+{
+    return isSupported() && !cacheDirectory.empty();
+}
+
+void ProgramCache::setRetrievable(GLuint program)
+{
+    if (programParameteri)
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+GLuint ProgramCache::load(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    if (!isEnabled())
+        return 0;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t key = programKey(vertexSource, fragmentSource);
+    uint64_t sourceLength = vertexSource.size() + fragmentSource.size();
+    std::string path = programPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    Header header;
+    std::vector<char> binary;
+    bool valid = file.read(reinterpret_cast<char *>(&header), sizeof(header)) && header.magic == MAGIC &&
+                 header.version == FILE_VERSION && header.key == key && header.sourceLength == sourceLength;
+    if (valid)
+    {
+        binary.resize(header.length);
+        valid = static_cast<bool>(file.read(binary.data(), header.length));
+    }
+    file.close();
+
+    GLuint program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        programBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        int success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    std::lock_guard<std::mutex> lock(countersMutex);
+    if (program)
+    {
+        ++counters.hits;
+        counters.loadMs += elapsedMs(start);
+        return program;
+    }
+    ++counters.rejected;
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
+
+void ProgramCache::store(GLuint program, const std::string &vertexSource, const std::string &fragmentSource)
+{
+    if (!program || !isEnabled())
+        return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    if (length > 0)
+        getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    // 先写临时文件再改名，多个进程同时启动时不会读到写了一半的文件
+    uint64_t key = programKey(vertexSource, fragmentSource);
+    Header header = {MAGIC, FILE_VERSION, key, vertexSource.size() + fragmentSource.size(), format, static_cast<uint32_t>(written)};
+    std::string path = programPath(key);
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(binary.data(), written);
+    file.close();
+    std::error_code error;
+    if (file)
+        std::filesystem::rename(temporary, path, error);
+    if (!file || error)
+    {
+        std::cerr << "ERROR::PROGRAM_CACHE::CANNOT_WRITE " << path << std::endl;
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+void ProgramCache::countCompile(double ms)
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    ++counters.misses;
+    counters.compileMs += ms;
+}
+
+GLuint ProgramCache::build(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    if (GLuint program = load(vertexSource, fragmentSource))
+        return program;
+    auto start = std::chrono::steady_clock::now();
+    GLuint program = compile(vertexSource, fragmentSource, isEnabled());
+    store(program, vertexSource, fragmentSource);
+    countCompile(elapsedMs(start));
+    return program;
+}
+
+ProgramCache::Stats ProgramCache::stats()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    return counters;
+}
+
+void ProgramCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    counters = Stats();
+}
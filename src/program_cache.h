@@ -0,0 +1,51 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// 着色器程序二进制缓存（ARB_get_program_binary，4.1 起为核心功能，glad 只有 3.3，手动加载）
+// 键是预处理后的顶点/片段源码（已含 #define）加上驱动厂商、渲染器、版本字符串的 64 位哈希，文件名即键；
+// 文件头再存一遍键和源码长度，碰撞或文件损坏按未命中处理。
+// 驱动更新后版本字符串变化，键随之改变，旧文件不会再被读取；
+// glProgramBinary 仍然失败时删除该文件，退回源码编译并重新写入。
+// 可以在共享上下文的后台线程中使用，统计由互斥量保护。
+class ProgramCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;     // 从二进制载入成功
+        uint64_t misses = 0;   // 源码编译（包括缓存关闭或不支持时）
+        uint64_t rejected = 0; // 文件存在但无效或驱动拒绝
+        double loadMs = 0.0;   // 二进制载入累计时间
+        double compileMs = 0.0;
+    };
+
+    // 在 gladLoadGLLoader 之后调用一次；驱动不提供任何二进制格式时缓存自动关闭
+    static void loadExtensions(GLADloadproc load);
+    static bool isSupported();
+
+    // 缓存目录，空字符串关闭缓存；目录不存在时创建
+    static void setDirectory(const std::string &directory);
+
+    // 从缓存载入，未命中时编译链接并写入缓存；失败返回 0
+    static GLuint build(const std::string &vertexSource, const std::string &fragmentSource);
+    // 编译链接，不读写缓存；retrievable 为 true 时链接前设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static GLuint compile(const std::string &vertexSource, const std::string &fragmentSource, bool retrievable = false);
+
+    // 以下供异步编译分步使用：先 load，未命中时自己发起编译，
+    // 链接前 setRetrievable，链接完成后 store
+    static bool isEnabled();
+    static GLuint load(const std::string &vertexSource, const std::string &fragmentSource);
+    static void setRetrievable(GLuint program);
+    static void store(GLuint program, const std::string &vertexSource, const std::string &fragmentSource);
+    // 异步路径在完成时记入统计
+    static void countCompile(double ms);
+
+    static Stats stats();
+    static void resetStats();
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "render_target_pool.h"
+
+#include <iostream>
+
+namespace
+{
+    // 显存估计用，只列出用到的格式
+    size_t bytesPerPixel(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_R8:
+            return 1;
+        case GL_RG16F:
+        case GL_R32F:
+        case GL_R11F_G11F_B10F:
+        case GL_RGBA8:
+            return 4;
+        case GL_RGBA16F:
+            return 8;
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+        }
+    }
+}
+
+void RenderTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    destroy();
+}
+
+const RenderTarget *RenderTargetPool::acquire(int width, int height, GLenum format, bool depth)
+{
+    for (std::unique_ptr<Entry> &entry : entries)
+    {
+        const RenderTarget &target = entry->target;
+        if (entry->inUse || target.width != width || target.height != height || target.format != format || (target.depth != 0) != depth)
+            continue;
+        entry->inUse = true;
+        entry->lastUsed = frame;
+        reused++;
+        return &entry->target;
+    }
+
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->target.width = width;
+    entry->target.height = height;
+    entry->target.format = format;
+    if (!createTarget(entry->target, depth))
+        return nullptr;
+    entry->inUse = true;
+    entry->lastUsed = frame;
+    created++;
+    entries.push_back(std::move(entry));
+    return &entries.back()->target;
+}
+
+void RenderTargetPool::release(const RenderTarget *target)
+{
+    for (std::unique_ptr<Entry> &entry : entries)
+    {
+        if (&entry->target == target)
+        {
+            entry->inUse = false;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::endFrame()
+{
+    for (size_t i = 0; i < entries.size();)
+    {
+        Entry &entry = *entries[i];
+        if (!entry.inUse && frame - entry.lastUsed >= MAX_IDLE_FRAMES)
+        {
+            destroyTarget(entry.target);
+            entries[i] = std::move(entries.back());
+            entries.pop_back();
+        }
+        else
+            i++;
+    }
+    frame++;
+}
+
+void RenderTargetPool::destroy()
+{
+    for (std::unique_ptr<Entry> &entry : entries)
+        destroyTarget(entry->target);
+    entries.clear();
+}
+
+RenderTargetPool::Stats RenderTargetPool::stats() const
+{
+    Stats result;
+    result.targets = entries.size();
+    for (const std::unique_ptr<Entry> &entry : entries)
+    {
+        const RenderTarget &target = entry->target;
+        result.inUse += entry->inUse;
+        result.bytes += size_t(target.width) * target.height * (bytesPerPixel(target.format) + (target.depth ? 4 : 0));
+    }
+    result.created = created;
+    result.reused = reused;
+    return result;
+}
+
+bool RenderTargetPool::createTarget(RenderTarget &target, bool depth)
+{
+    // 可能在帧中间创建，完成后恢复原来的绘制目标
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+
+    glGenTextures(1, &target.color);
+    glBindTexture(GL_TEXTURE_2D, target.color);
+    glTexImage2D(GL_TEXTURE_2D, 0, target.format, target.width, target.height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (depth)
+    {
+        glGenTextures(1, &target.depth);
+        glBindTexture(GL_TEXTURE_2D, target.depth);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, target.width, target.height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &target.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.color, 0);
+    if (depth)
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, target.depth, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "ERROR::RENDER_TARGET_POOL::INCOMPLETE " << target.width << "x" << target.height << " format 0x" << std::hex
+                  << target.format << " status 0x" << status << std::dec << std::endl;
+        destroyTarget(target);
+        return false;
+    }
+    return true;
+}
+
+void RenderTargetPool::destroyTarget(RenderTarget &target)
+{
+    if (target.fbo)
+        glDeleteFramebuffers(1, &target.fbo);
+    if (target.color)
+        glDeleteTextures(1, &target.color);
+    if (target.depth)
+        glDeleteTextures(1, &target.depth);
+    target.fbo = target.color = target.depth = 0;
+}
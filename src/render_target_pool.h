@@ -0,0 +1,67 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 帧内临时渲染目标（一个颜色纹理，可选深度纹理）
+struct RenderTarget
+{
+    GLuint fbo = 0, color = 0, depth = 0;
+    int width = 0, height = 0;
+    GLenum format = GL_RGBA8;
+
+    // 绑定为绘制目标并把视口设成整个附件
+    void bind() const;
+};
+
+// 临时渲染目标池
+// 各个通道需要中间结果时按（尺寸、格式、是否带深度）向池借，用完归还，而不是各自持有一套：
+// 同一帧里先后用到相同规格的通道共用同一个目标，下一帧同样的请求直接复用，不再重新分配；
+// 视口尺寸变化后旧规格的目标连续 MAX_IDLE_FRAMES 帧没人借就释放。
+// 借出的目标内容不保证（上一个使用者留下的），需要时由借用者清空；跨帧保留内容的目标（历史）不该放在这里。
+class RenderTargetPool
+{
+public:
+    static const int MAX_IDLE_FRAMES = 8;
+
+    RenderTargetPool() {}
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool &) = delete;
+    RenderTargetPool &operator=(const RenderTargetPool &) = delete;
+
+    // 颜色纹理为双线性过滤、边缘钳制；创建失败返回 nullptr。返回的指针在归还前有效
+    const RenderTarget *acquire(int width, int height, GLenum format, bool depth = false);
+    void release(const RenderTarget *target);
+    // 每帧末调用一次，释放闲置过久的目标
+    void endFrame();
+    void destroy();
+
+    struct Stats
+    {
+        size_t targets = 0; // 池中的目标数
+        size_t inUse = 0;
+        size_t bytes = 0;   // 显存估计
+        uint64_t created = 0, reused = 0;
+    };
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        RenderTarget target;
+        bool inUse = false;
+        uint64_t lastUsed = 0;
+    };
+    std::vector<std::unique_ptr<Entry>> entries; // 指针稳定，借出的 RenderTarget 不随增删移动
+    uint64_t frame = 0;
+    uint64_t created = 0, reused = 0;
+
+    static bool createTarget(RenderTarget &target, bool depth);
+    static void destroyTarget(RenderTarget &target);
+};
+
+#endif
@@ -0,0 +1,230 @@
+#include "scene.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+Entity Scene::create()
+{
+    ++alive;
+    if (!freeList.empty())
+    {
+        Entity entity = freeList.back();
+        freeList.pop_back();
+        return entity;
+    }
+    return next++;
+}
+
+void Scene::destroy(Entity entity)
+{
+    transforms.remove(entity);
+    meshes.remove(entity);
+    materials.remove(entity);
+    animations.remove(entity);
+    bounds.remove(entity);
+    lights.remove(entity);
+    freeList.push_back(entity);
+    --alive;
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4 &m)
+{
+    // Gribb/Hartmann：由裁剪矩阵的行组合得到平面
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0]; // 左
+    frustum.planes[1] = row[3] - row[0]; // 右
+    frustum.planes[2] = row[3] + row[1]; // 下
+    frustum.planes[3] = row[3] - row[1]; // 上
+    frustum.planes[4] = row[3] + row[2]; // 近
+    frustum.planes[5] = row[3] - row[2]; // 远
+    for (glm::vec4 &plane : frustum.planes)
+        plane = plane / glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool Frustum::intersects(const glm::vec3 &center, float radius) const
+{
+    for (const glm::vec4 &plane : planes)
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    return true;
+}
+
+void Scene::storePrevious(size_t begin, size_t end)
+{
+    std::vector<Transform> &list = transforms.components();
+    end = std::min(end, list.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        list[i].previousPosition = list[i].position;
+        list[i].previousRotation = list[i].rotation;
+        list[i].previousScale = list[i].scale;
+    }
+}
+
+void Scene::updateAnimations(float time, float deltaTime, size_t begin, size_t end)
+{
+    const std::vector<Entity> &entities = animations.entities();
+    std::vector<Animation> &anims = animations.components();
+    end = std::min(end, anims.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        Animation &animation = anims[i];
+        Transform *transform = transforms.find(entities[i]);
+        if (!transform)
+            continue;
+
+        if (animation.dancing)
+        {
+            // 平移
+            transform->position.x = 5.0f * sin(1.5f * time);          // X轴移动
+            transform->position.y = -10.0f + 2.0f * sin(2.0f * time); // Y轴上下移动
+            transform->position.z = 5.0f * cos(1.5f * time);          // Z轴移动
+
+            // 旋转：各轴摆动角只由时间决定，不再逐帧累乘，结果与帧率无关
+            transform->rotation.x = 0.5f * sin(2.0f * time); // 绕X轴旋转
+            transform->rotation.y = 0.5f * cos(2.0f * time); // 绕Y轴旋转
+            transform->rotation.z = 0.5f * sin(1.0f * time); // 绕Z轴旋转
+
+            // 缩放变化
+            transform->scale = 0.6f + 0.1f * sin(1.0f * time);
+        }
+
+        if (animation.interpolating)
+        {
+            animation.factor += deltaTime * 0.5f; // 控制插值速度
+            if (animation.factor > 1.0f)
+            {
+                animation.factor = 1.0f;
+                animation.interpolating = false; // 停止插值
+            }
+            transform->position = glm::mix(animation.startPosition, animation.targetPosition, animation.factor);
+            transform->rotation = glm::mix(animation.startRotation, animation.targetRotation, animation.factor);
+        }
+    }
+}
+
+void Scene::updateLights(float time, size_t begin, size_t end)
+{
+    const std::vector<Entity> &entities = lights.entities();
+    const std::vector<PointLight> &list = lights.components();
+    end = std::min(end, list.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        const PointLight &light = list[i];
+        Transform *transform = transforms.find(entities[i]);
+        if (!transform)
+            continue;
+        float angle = light.speed * time + light.phase;
+        transform->position = light.origin + light.orbit * glm::vec3(std::cos(angle), 0.2f * std::sin(2.0f * angle), std::sin(angle));
+    }
+}
+
+void Scene::updateTransforms(float alpha, size_t begin, size_t end)
+{
+    std::vector<Transform> &list = transforms.components();
+    end = std::min(end, list.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        Transform &transform = list[i];
+        glm::vec3 position = glm::mix(transform.previousPosition, transform.position, alpha);
+        glm::vec3 rotation = glm::mix(transform.previousRotation, transform.rotation, alpha);
+        float scale = glm::mix(transform.previousScale, transform.scale, alpha);
+        glm::mat4 matrix = glm::translate(glm::mat4(1.0f), position);         // 应用平移
+        matrix = glm::rotate(matrix, rotation.x, glm::vec3(1.0f, 0.0f, 0.0f)); // 应用旋转
+        matrix = glm::rotate(matrix, rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        matrix = glm::rotate(matrix, rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        transform.matrix = glm::scale(matrix, glm::vec3(scale)); // 应用缩放
+    }
+}
+
+void Scene::updateBounds(size_t begin, size_t end)
+{
+    const std::vector<Entity> &entities = bounds.entities();
+    std::vector<Bounds> &worldBounds = bounds.components();
+    end = std::min(end, worldBounds.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        const MeshRef *mesh = meshes.find(entities[i]);
+        const Transform *transform = transforms.find(entities[i]);
+        if (!mesh || !transform)
+            continue;
+        worldBounds[i].center = glm::vec3(transform->matrix * glm::vec4(mesh->localCenter, 1.0f));
+        // 矩阵是插值结果，半径取前后两步中较大的缩放，保证包住
+        worldBounds[i].radius = mesh->localRadius * std::max(std::fabs(transform->scale), std::fabs(transform->previousScale));
+    }
+}
+
+void Scene::cull(const Frustum &frustum, size_t begin, size_t end)
+{
+    std::vector<Bounds> &worldBounds = bounds.components();
+    end = std::min(end, worldBounds.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        worldBounds[i].visible = frustum.intersects(worldBounds[i].center, worldBounds[i].radius);
+        worldBounds[i].shadowMask = 0; // 开启阴影时由 cullShadowCasters 重新计算
+    }
+}
+
+void Scene::cullShadowCasters(const ShadowCascades &cascades, size_t begin, size_t end)
+{
+    std::vector<Bounds> &worldBounds = bounds.components();
+    end = std::min(end, worldBounds.size());
+    for (size_t i = begin; i < end; i++)
+        worldBounds[i].shadowMask = cascades.casterMask(worldBounds[i].center, worldBounds[i].radius);
+}
+
+void Scene::submit(std::vector<DrawPacket> &packets, size_t begin, size_t end) const
+{
+    const std::vector<Entity> &entities = meshes.entities();
+    const std::vector<MeshRef> &refs = meshes.components();
+    end = std::min(end, refs.size());
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!transforms.has(entities[i]))
+            continue;
+        DrawPacket packet;
+        if (bounds.has(entities[i]))
+        {
+            const Bounds &bound = bounds.get(entities[i]);
+            if (!bound.visible && !bound.shadowMask)
+                continue;
+            packet.visible = bound.visible;
+            packet.shadowMask = bound.shadowMask;
+        }
+        packet.model = refs[i].model;
+        packet.matrix = transforms.get(entities[i]).matrix;
+        if (materials.has(entities[i]))
+        {
+            const Material &material = materials.get(entities[i]);
+            packet.color = material.color;
+            packet.useObjectColor = material.useObjectColor;
+            packet.roughness = material.roughness;
+        }
+        else
+        {
+            packet.color = glm::vec3(1.0f);
+            packet.useObjectColor = true;
+        }
+        packets.push_back(packet);
+    }
+}
+
+void Scene::submitLights(std::vector<LightPacket> &packets) const
+{
+    const std::vector<Entity> &entities = lights.entities();
+    const std::vector<PointLight> &list = lights.components();
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        if (!transforms.has(entities[i]) || list[i].intensity <= 0.0f)
+            continue;
+        LightPacket packet;
+        packet.positionRadius = glm::vec4(glm::vec3(transforms.get(entities[i]).matrix[3]), list[i].radius);
+        packet.color = glm::vec4(list[i].color * list[i].intensity, 1.0f);
+        packets.push_back(packet);
+    }
+}
@@ -0,0 +1,202 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "shadow_cascades.h"
+
+class Model;
+
+// 实体只是一个编号，数据都存放在各组件池中
+typedef uint32_t Entity;
+const Entity NULL_ENTITY = 0xFFFFFFFFu;
+
+// 稀疏集合组件池
+// dense/data 两个数组连续存放，系统按数组顺序线性遍历；sparse 提供实体到下标的 O(1) 查找
+template <typename T>
+class ComponentPool
+{
+public:
+    T &add(Entity entity, const T &component = T())
+    {
+        if (entity >= sparse.size())
+            sparse.resize(entity + 1, NULL_ENTITY);
+        if (sparse[entity] != NULL_ENTITY)
+            return data[sparse[entity]] = component;
+        sparse[entity] = static_cast<uint32_t>(dense.size());
+        dense.push_back(entity);
+        data.push_back(component);
+        return data.back();
+    }
+
+    void remove(Entity entity)
+    {
+        if (!has(entity))
+            return;
+        // 用最后一个元素填补空位，保持数组紧凑
+        uint32_t index = sparse[entity];
+        Entity last = dense.back();
+        dense[index] = last;
+        data[index] = data.back();
+        sparse[last] = index;
+        dense.pop_back();
+        data.pop_back();
+        sparse[entity] = NULL_ENTITY;
+    }
+
+    bool has(Entity entity) const { return entity < sparse.size() && sparse[entity] != NULL_ENTITY; }
+    T &get(Entity entity) { return data[sparse[entity]]; }
+    const T &get(Entity entity) const { return data[sparse[entity]]; }
+    T *find(Entity entity) { return has(entity) ? &data[sparse[entity]] : nullptr; }
+
+    size_t size() const { return dense.size(); }
+    const std::vector<Entity> &entities() const { return dense; }
+    std::vector<T> &components() { return data; }
+    const std::vector<T> &components() const { return data; }
+
+private:
+    std::vector<uint32_t> sparse;
+    std::vector<Entity> dense;
+    std::vector<T> data;
+};
+
+// 组件
+
+struct Transform
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f); // 欧拉角
+    float scale = 1.0f;
+    // 上一个固定步开始时的状态，渲染时与当前状态插值
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::vec3 previousRotation = glm::vec3(0.0f);
+    float previousScale = 1.0f;
+    glm::mat4 matrix = glm::mat4(1.0f); // 由 updateTransforms 计算
+};
+
+struct MeshRef
+{
+    Model *model = nullptr;
+    glm::vec3 localCenter = glm::vec3(0.0f); // 模型空间包围球
+    float localRadius = 0.0f;
+};
+
+struct Material
+{
+    glm::vec3 color = glm::vec3(1.0f);
+    bool useObjectColor = true;
+    float roughness = 0.5f;
+};
+
+struct Animation
+{
+    // 舞蹈动作
+    bool dancing = false;
+    // "Apply" 触发的插值
+    bool interpolating = false;
+    float factor = 0.0f;
+    glm::vec3 startPosition = glm::vec3(0.0f);
+    glm::vec3 startRotation = glm::vec3(0.0f);
+    glm::vec3 targetPosition = glm::vec3(0.0f);
+    glm::vec3 targetRotation = glm::vec3(0.0f);
+};
+
+struct Bounds
+{
+    glm::vec3 center = glm::vec3(0.0f); // 世界空间包围球
+    float radius = 0.0f;
+    bool visible = true; // 由 cull 更新
+    uint32_t shadowMask = 0; // 由 cullShadowCasters 更新，第 i 位表示向第 i 个级联投射阴影
+};
+
+// 动态点光源，位置来自同一实体的 Transform
+struct PointLight
+{
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    float radius = 5.0f; // 影响范围，距离超过它时贡献为 0
+    // 绕 origin 在水平面内做圆周运动（带上下起伏），orbit 为 0 时静止在 origin
+    glm::vec3 origin = glm::vec3(0.0f);
+    float orbit = 0.0f;
+    float speed = 1.0f;
+    float phase = 0.0f;
+};
+
+// 视锥体的六个平面（法线朝内），用于包围球剔除
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4 &viewProjection);
+    bool intersects(const glm::vec3 &center, float radius) const;
+};
+
+struct Camera
+{
+    glm::vec3 position = glm::vec3(0.0f, 3.0f, 30.0f);
+    glm::vec3 front = glm::vec3(0.0f, -0.3f, -1.0f);
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+};
+
+// 一个光源的世界空间数据，布局与着色器里的光源缓冲纹理一致（每个光源两个 RGBA32F 纹素）
+struct LightPacket
+{
+    glm::vec4 positionRadius; // xyz 位置，w 影响半径
+    glm::vec4 color;          // rgb 已乘强度
+};
+
+// 一次绘制所需的全部数据
+struct DrawPacket
+{
+    Model *model;
+    glm::mat4 matrix;
+    glm::vec3 color;
+    bool useObjectColor;
+    float roughness = 0.5f;
+    bool visible = true;     // 相机可见；为 false 时只用于阴影
+    uint32_t shadowMask = 0; // 需要绘制到哪些阴影级联
+};
+
+class Scene
+{
+public:
+    Entity create();
+    void destroy(Entity entity);
+    size_t size() const { return alive; }
+
+    ComponentPool<Transform> transforms;
+    ComponentPool<MeshRef> meshes;
+    ComponentPool<Material> materials;
+    ComponentPool<Animation> animations;
+    ComponentPool<Bounds> bounds;
+    ComponentPool<PointLight> lights;
+
+    Camera camera;
+    glm::vec3 lightPos = glm::vec3(0.0f, 10.0f, 10.0f);
+
+    // 系统：每个固定步调用 storePrevious、updateAnimations，每帧渲染前调用其余几个
+    // [begin, end) 是对应组件数组中的范围，便于拆分成并行任务
+    static const size_t ALL = std::numeric_limits<size_t>::max();
+    void storePrevious(size_t begin = 0, size_t end = ALL);
+    void updateAnimations(float time, float deltaTime, size_t begin = 0, size_t end = ALL);
+    void updateLights(float time, size_t begin = 0, size_t end = ALL);
+    // alpha 为上一步到当前步之间的插值因子
+    void updateTransforms(float alpha = 1.0f, size_t begin = 0, size_t end = ALL);
+    void updateBounds(size_t begin = 0, size_t end = ALL);
+    void cull(const Frustum &frustum, size_t begin = 0, size_t end = ALL);
+    // 阴影投射体剔除，需要在 updateBounds 之后调用
+    void cullShadowCasters(const ShadowCascades &cascades, size_t begin = 0, size_t end = ALL);
+    // 追加相机可见或投射阴影的网格的绘制包
+    void submit(std::vector<DrawPacket> &packets, size_t begin = 0, size_t end = ALL) const;
+    // 追加所有点光源（插值后的位置），需要在 updateTransforms 之后调用
+    void submitLights(std::vector<LightPacket> &packets) const;
+
+private:
+    std::vector<Entity> freeList;
+    Entity next = 0;
+    size_t alive = 0;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "scene_graph.h"
+
+#include <algorithm>
+#include <cassert>
+
+int SceneGraph::addNode(int parent, const glm::mat4 &local)
+{
+    int index = static_cast<int>(parents.size());
+    assert(parent < index && (parent < 0 || subtreeEnd[parent] == index));
+
+    parents.push_back(parent);
+    subtreeEnd.push_back(index + 1);
+    locals.push_back(local);
+    worlds.push_back(parent < 0 ? local : worlds[parent] * local);
+    dirty.push_back(0);
+
+    // 新节点接在所有祖先子树的末尾
+    for (int ancestor = parent; ancestor >= 0; ancestor = parents[ancestor])
+        subtreeEnd[ancestor] = index + 1;
+    return index;
+}
+
+void SceneGraph::setLocal(int node, const glm::mat4 &local)
+{
+    locals[node] = local;
+    if (!dirty[node])
+    {
+        dirty[node] = 1;
+        dirtyNodes.push_back(node);
+    }
+}
+
+size_t SceneGraph::update()
+{
+    if (dirtyNodes.empty())
+        return 0;
+
+    // 先序下子树是连续区间，按下标排序后跳过已被祖先覆盖的节点
+    std::sort(dirtyNodes.begin(), dirtyNodes.end());
+    size_t updated = 0;
+    int coveredEnd = 0;
+    for (int root : dirtyNodes)
+    {
+        dirty[root] = 0;
+        if (root < coveredEnd)
+            continue;
+        int end = subtreeEnd[root];
+        int rootParent = parents[root];
+        worlds[root] = rootParent < 0 ? locals[root] : worlds[rootParent] * locals[root];
+        for (int i = root + 1; i < end; i++)
+            worlds[i] = worlds[parents[i]] * locals[i];
+        updated += end - root;
+        coveredEnd = end;
+    }
+    dirtyNodes.clear();
+    return updated;
+}
+
+void SceneGraph::updateAll()
+{
+    for (size_t i = 0; i < parents.size(); i++)
+        worlds[i] = parents[i] < 0 ? locals[i] : worlds[parents[i]] * locals[i];
+    for (int node : dirtyNodes)
+        dirty[node] = 0;
+    dirtyNodes.clear();
+}
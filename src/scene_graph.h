@@ -0,0 +1,37 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// 扁平化场景图
+// 节点按先序（父节点在前、子树连续）存放在并列数组中：父节点下标、局部矩阵、世界矩阵，
+// 修改局部矩阵只标记该节点，update() 只重算被标记节点所在的子树
+class SceneGraph
+{
+public:
+    // 添加节点，parent 为 -1 表示根节点；parent 的子树必须是当前最后一段（先序构建）
+    int addNode(int parent, const glm::mat4 &local);
+    void setLocal(int node, const glm::mat4 &local);
+
+    const glm::mat4 &local(int node) const { return locals[node]; }
+    const glm::mat4 &world(int node) const { return worlds[node]; }
+    int parent(int node) const { return parents[node]; }
+    size_t size() const { return parents.size(); }
+
+    // 重算脏子树的世界矩阵，返回重算的节点数
+    size_t update();
+    // 不看脏标记，重算全部节点（用于对比）
+    void updateAll();
+
+private:
+    std::vector<int> parents;
+    std::vector<int> subtreeEnd; // 子树结束位置（不含）
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint8_t> dirty;
+    std::vector<int> dirtyNodes;
+};
+
+#endif
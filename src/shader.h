@@ -4,80 +4,50 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <vector>
+#include "program_cache.h"
+#include "shader_preprocessor.h"
+#include "trace.h"
 
 class Shader
 {
 public:
     unsigned int ID;
 
-    Shader(const char* vertexPath, const char* fragmentPath)
+    // defines 是若干行 "#define X ..."，插在两个阶段的 #version 之后，参与程序缓存的键
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string &defines = "")
     {
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
+        TraceScope trace("Shader compile");
+        std::string vertexCode = loadSource(vertexPath);
+        std::string fragmentCode = loadSource(fragmentPath);
 
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            vShaderFile.close();
-            fShaderFile.close();
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-
-        unsigned int vertex, fragment;
-        int success;
-        char infoLog[512];
-
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
+        // 有缓存目录时先尝试程序二进制，未命中再编译
+        ID = ProgramCache::build(injectDefines(vertexCode, defines), injectDefines(fragmentCode, defines));
+    }
 
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
+    // 包装已有的程序（例如 ShaderManager 异步编译的结果），不负责删除
+    explicit Shader(unsigned int program) : ID(program) {}
 
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(ID, 512, NULL, infoLog);
-            std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        }
+    // 读取源码并展开 #include（见 shader_preprocessor.h），失败时返回空串
+    static std::string loadSource(const char* path, std::vector<std::string> *dependencies = nullptr)
+    {
+        std::string source;
+        preprocessShader(path, source, dependencies);
+        return source;
+    }
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    // #version 必须是第一条语句，定义插在它的下一行
+    static std::string injectDefines(const std::string &source, const std::string &defines)
+    {
+        if (defines.empty())
+            return source;
+        size_t version = source.find("#version");
+        size_t line = version == std::string::npos ? 0 : source.find('\n', version);
+        if (line == std::string::npos)
+            return source + "\n" + defines;
+        size_t at = version == std::string::npos ? 0 : line + 1;
+        return source.substr(0, at) + defines + (defines.back() == '\n' ? "" : "\n") + source.substr(at);
     }
 
     void use() const
@@ -108,6 +78,14 @@ public:
     void setVec3(const std::string &name, float x, float y, float z) {
         glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
     }
+
+    // 把 uniform block 连到绑定点，着色器中没有该 block 时忽略
+    void bindUniformBlock(const std::string &name, unsigned int binding) const
+    {
+        unsigned int index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
+    }
 };
 
 #endif 
\ No newline at end of file
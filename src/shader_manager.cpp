@@ -0,0 +1,436 @@
+#include "shader_manager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+#include "file_watcher.h"
+#include "program_cache.h"
+#include "shader.h"
+#include "trace.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+static PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    GLuint startStage(GLenum type, const std::string &source)
+    {
+        const char *code = source.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    void printStageLog(GLuint shader, const char *stage)
+    {
+        int success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success)
+            return;
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+}
+
+void ShaderManager::loadExtensions(GLADloadproc load)
+{
+    maxShaderCompilerThreads = nullptr;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+            maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsKHR"));
+        else if (name && std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0 && !maxShaderCompilerThreads)
+            maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsARB"));
+    }
+}
+
+bool ShaderManager::hasParallelCompile()
+{
+    return maxShaderCompilerThreads != nullptr;
+}
+
+ShaderManager::~ShaderManager()
+{
+    destroy();
+}
+
+void ShaderManager::create(WorkerContext worker, Mode preferred)
+{
+    destroy();
+    counters = Stats();
+    if (preferred == Mode::Parallel && hasParallelCompile())
+    {
+        // 0xFFFFFFFF 表示由驱动决定线程数
+        maxShaderCompilerThreads(0xFFFFFFFFu);
+        activeMode = Mode::Parallel;
+    }
+    else if (preferred != Mode::Synchronous && worker.bind)
+    {
+        this->worker = worker;
+        stopping = false;
+        activeMode = Mode::Worker;
+        thread = std::thread(&ShaderManager::workerLoop, this);
+    }
+    else
+        activeMode = Mode::Synchronous;
+}
+
+void ShaderManager::destroy()
+{
+    if (thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        thread.join();
+    }
+    jobs.clear();
+    for (const Result &result : results)
+        arrived.push_back(result);
+    results.clear();
+    for (const Result &result : arrived)
+    {
+        if (result.fence)
+            glDeleteSync(result.fence);
+        if (result.program)
+            glDeleteProgram(result.program);
+    }
+    arrived.clear();
+    for (Entry &entry : entries)
+    {
+        if (entry.program)
+            glDeleteProgram(entry.program);
+        if (entry.linking)
+            glDeleteProgram(entry.linking);
+        if (entry.vertex)
+            glDeleteShader(entry.vertex);
+        if (entry.fragment)
+            glDeleteShader(entry.fragment);
+    }
+    entries.clear();
+    waiting.clear();
+    pendingCount = 0;
+}
+
+ShaderManager::Handle ShaderManager::request(const std::string &vertexPath, const std::string &fragmentPath, const std::string &defines,
+                                             std::function<void(GLuint)> onReady)
+{
+    TraceScope trace("Shader request");
+    auto start = std::chrono::steady_clock::now();
+    Handle handle = static_cast<Handle>(entries.size());
+    entries.emplace_back();
+    Entry &entry = entries.back();
+    entry.vertexPath = vertexPath;
+    entry.fragmentPath = fragmentPath;
+    entry.defines = defines;
+    entry.onReady = onReady;
+    loadSources(entry, entry.vertexSource, entry.fragmentSource);
+    ++counters.requested;
+    this->start(handle);
+    counters.requestMs += elapsedMs(start);
+    return handle;
+}
+
+bool ShaderManager::loadSources(Entry &entry, std::string &vertexSource, std::string &fragmentSource)
+{
+    std::vector<std::string> vertexFiles, fragmentFiles;
+    bool success = preprocessShader(entry.vertexPath, vertexSource, &vertexFiles);
+    success = preprocessShader(entry.fragmentPath, fragmentSource, &fragmentFiles) && success;
+    vertexSource = Shader::injectDefines(vertexSource, entry.defines);
+    fragmentSource = Shader::injectDefines(fragmentSource, entry.defines);
+
+    // 读取失败时也记录已经读到的文件，修好之后还能触发重载
+    entry.dependencies = vertexFiles;
+    for (const std::string &file : fragmentFiles)
+    {
+        if (std::find(entry.dependencies.begin(), entry.dependencies.end(), file) == entry.dependencies.end())
+            entry.dependencies.push_back(file);
+    }
+    if (watcher)
+    {
+        for (const std::string &file : entry.dependencies)
+            watcher->watch(file);
+    }
+    return success;
+}
+
+void ShaderManager::start(Handle handle)
+{
+    Entry &entry = entries[handle];
+    if (!entry.building)
+        ++pendingCount;
+    entry.building = true;
+    entry.requested = std::chrono::steady_clock::now();
+    ++entry.generation;
+
+    if (activeMode == Mode::Worker)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({handle, entry.generation, entry.vertexSource, entry.fragmentSource});
+        }
+        changed.notify_all();
+        return;
+    }
+    // 并行模式下重新编译时放弃还没链接完的旧请求
+    if (entry.linking)
+    {
+        glDeleteProgram(entry.linking);
+        glDeleteShader(entry.vertex);
+        glDeleteShader(entry.fragment);
+        entry.linking = entry.vertex = entry.fragment = 0;
+        waiting.erase(std::find(waiting.begin(), waiting.end(), handle));
+    }
+    GLuint program = ProgramCache::load(entry.vertexSource, entry.fragmentSource);
+    if (program)
+        finish(handle, program, true);
+    else if (activeMode == Mode::Parallel)
+    {
+        startParallel(entry);
+        waiting.push_back(handle);
+    }
+    else
+        finish(handle, ProgramCache::build(entry.vertexSource, entry.fragmentSource), false);
+}
+
+void ShaderManager::startParallel(Entry &entry)
+{
+    // 只发起编译和链接，不查询任何状态，否则驱动会在这里等编译完成
+    entry.vertex = startStage(GL_VERTEX_SHADER, entry.vertexSource);
+    entry.fragment = startStage(GL_FRAGMENT_SHADER, entry.fragmentSource);
+    entry.linking = glCreateProgram();
+    glAttachShader(entry.linking, entry.vertex);
+    glAttachShader(entry.linking, entry.fragment);
+    if (ProgramCache::isEnabled())
+        ProgramCache::setRetrievable(entry.linking);
+    glLinkProgram(entry.linking);
+}
+
+void ShaderManager::setWatcher(FileWatcher *watcher)
+{
+    this->watcher = watcher;
+    if (!watcher)
+        return;
+    for (const Entry &entry : entries)
+    {
+        for (const std::string &file : entry.dependencies)
+            watcher->watch(file);
+    }
+}
+
+void ShaderManager::reload(const std::vector<std::string> &changedFiles)
+{
+    std::unordered_set<std::string> changedSet(changedFiles.begin(), changedFiles.end());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        Entry &entry = entries[i];
+        bool affected = false;
+        for (const std::string &file : entry.dependencies)
+            affected = affected || changedSet.count(file) > 0;
+        if (!affected)
+            continue;
+        std::string vertexSource, fragmentSource;
+        if (!loadSources(entry, vertexSource, fragmentSource))
+        {
+            ++counters.reloadFailed;
+            std::cerr << "ERROR::SHADER::RELOAD_FAILED " << entry.vertexPath << " + " << entry.fragmentPath
+                      << ", keeping previous program" << std::endl;
+            continue;
+        }
+        // 保存时内容没变，不重新编译
+        if (vertexSource == entry.vertexSource && fragmentSource == entry.fragmentSource)
+            continue;
+        entry.vertexSource = std::move(vertexSource);
+        entry.fragmentSource = std::move(fragmentSource);
+        start(static_cast<Handle>(i));
+    }
+}
+
+void ShaderManager::poll()
+{
+    if (watcher)
+    {
+        std::vector<std::string> changedFiles = watcher->poll();
+        if (!changedFiles.empty())
+            reload(changedFiles);
+    }
+    if (pendingCount == 0)
+        return;
+    auto start = std::chrono::steady_clock::now();
+    if (activeMode == Mode::Parallel)
+    {
+        for (size_t i = 0; i < waiting.size();)
+        {
+            Entry &entry = entries[waiting[i]];
+            GLint done = GL_FALSE;
+            glGetProgramiv(entry.linking, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done)
+            {
+                i++;
+                continue;
+            }
+            GLint success;
+            glGetProgramiv(entry.linking, GL_LINK_STATUS, &success);
+            if (!success)
+            {
+                printStageLog(entry.vertex, "VERTEX");
+                printStageLog(entry.fragment, "FRAGMENT");
+                char infoLog[512];
+                glGetProgramInfoLog(entry.linking, 512, NULL, infoLog);
+                std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+                glDeleteProgram(entry.linking);
+                entry.linking = 0;
+            }
+            glDeleteShader(entry.vertex);
+            glDeleteShader(entry.fragment);
+            entry.vertex = entry.fragment = 0;
+            ProgramCache::countCompile(elapsedMs(entry.requested));
+            ProgramCache::store(entry.linking, entry.vertexSource, entry.fragmentSource);
+            GLuint program = entry.linking;
+            entry.linking = 0;
+            Handle handle = waiting[i];
+            waiting[i] = waiting.back();
+            waiting.pop_back();
+            finish(handle, program, false);
+        }
+    }
+    else if (activeMode == Mode::Worker)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            arrived.insert(arrived.end(), results.begin(), results.end());
+            results.clear();
+        }
+        for (size_t i = 0; i < arrived.size();)
+        {
+            Result &result = arrived[i];
+            if (result.fence)
+            {
+                // 围栏由后台上下文插入，同一共享组内的上下文都可以查询
+                if (glClientWaitSync(result.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                {
+                    i++;
+                    continue;
+                }
+                glDeleteSync(result.fence);
+            }
+            // 编译期间文件又改过，已经有更新的任务在排队
+            if (result.generation != entries[result.handle].generation)
+            {
+                if (result.program)
+                    glDeleteProgram(result.program);
+            }
+            else
+                finish(result.handle, result.program, result.cached);
+            arrived[i] = arrived.back();
+            arrived.pop_back();
+        }
+    }
+    counters.pollMs += elapsedMs(start);
+}
+
+void ShaderManager::finish(Handle handle, GLuint program, bool cached)
+{
+    Entry &entry = entries[handle];
+    bool reloading = entry.state != State::Pending;
+    entry.building = false;
+    --pendingCount;
+    counters.latestReadyMs = elapsedMs(entry.requested);
+    if (!program)
+    {
+        if (reloading)
+        {
+            ++counters.reloadFailed;
+            std::cerr << "ERROR::SHADER::RELOAD_FAILED " << entry.vertexPath << " + " << entry.fragmentPath
+                      << ", keeping previous program" << std::endl;
+        }
+        else
+        {
+            entry.state = State::Failed;
+            ++counters.failed;
+        }
+        return;
+    }
+    if (cached)
+        ++counters.cached;
+    // 旧程序可能还被本帧已提交的绘制引用，驱动会在不再使用后才真正删除
+    if (entry.program)
+        glDeleteProgram(entry.program);
+    entry.program = program;
+    entry.state = State::Ready;
+    if (reloading)
+        ++counters.reloaded;
+    else
+        ++counters.ready;
+    if (entry.onReady)
+        entry.onReady(entry.program);
+}
+
+bool ShaderManager::isReady(Handle handle) const
+{
+    return handle >= 0 && handle < static_cast<Handle>(entries.size()) && entries[handle].state == State::Ready;
+}
+
+GLuint ShaderManager::program(Handle handle, GLuint fallback) const
+{
+    return isReady(handle) ? entries[handle].program : fallback;
+}
+
+void ShaderManager::workerLoop()
+{
+    Trace::setThreadName("shader compiler");
+    worker.bind();
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]()
+                         { return stopping || !jobs.empty(); });
+            if (stopping)
+                break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        TraceScope trace("Shader compile");
+        Result result = {job.handle, job.generation, 0, false, nullptr};
+        result.program = ProgramCache::load(job.vertexSource, job.fragmentSource);
+        result.cached = result.program != 0;
+        if (!result.cached)
+        {
+            auto start = std::chrono::steady_clock::now();
+            result.program = ProgramCache::compile(job.vertexSource, job.fragmentSource, ProgramCache::isEnabled());
+            ProgramCache::store(result.program, job.vertexSource, job.fragmentSource);
+            ProgramCache::countCompile(elapsedMs(start));
+        }
+        if (result.program)
+        {
+            // 主线程等这个围栏而不是直接使用，保证链接结果对其他上下文可见
+            result.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+        }
+    }
+    if (worker.unbind)
+        worker.unbind();
+}
@@ -0,0 +1,152 @@
+#ifndef SHADER_MANAGER_H
+#define SHADER_MANAGER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 异步着色器编译
+// request 只发起编译就返回，poll 每帧检查完成情况，完成前 program() 返回调用方给的备用程序。
+// 三种方式按可用性选择：
+// 1. KHR/ARB_parallel_shader_compile：主线程发起 glCompileShader/glLinkProgram 后不查询状态，
+//    驱动在自己的线程里编译，poll 用 GL_COMPLETION_STATUS_KHR 非阻塞查询；
+// 2. 否则，如果提供了共享上下文，后台线程在该上下文里编译链接，完成后插入围栏，poll 检查围栏；
+// 3. 两者都没有时在 request 里同步编译。
+// 都先查 ProgramCache，命中时直接就绪。
+//
+// 热重载：源码按 #include 展开后记录依赖文件，关联 FileWatcher 后 poll 检查改动，
+// 用同样的方式在后台重新编译受影响的程序；新程序在 poll 里（两帧之间）替换旧程序，
+// 编译失败时继续使用旧程序。Handle 不变，调用方每帧通过 program() 取到的总是最新可用的程序。
+class FileWatcher;
+
+class ShaderManager
+{
+public:
+    typedef int Handle;
+
+    // 后台线程的共享上下文：bind 在线程启动时调用（设为当前），unbind 在线程退出前调用
+    struct WorkerContext
+    {
+        std::function<void()> bind, unbind;
+    };
+
+    enum class Mode
+    {
+        Parallel,
+        Worker,
+        Synchronous
+    };
+
+    struct Stats
+    {
+        uint64_t requested = 0;
+        uint64_t ready = 0;
+        uint64_t failed = 0;
+        uint64_t cached = 0;       // 从程序二进制载入
+        double requestMs = 0.0;    // 主线程在 request 中的累计时间
+        double pollMs = 0.0;       // 主线程在 poll 中的累计时间
+        double latestReadyMs = 0.0; // 最后一个程序从请求到就绪的时间
+        uint64_t reloaded = 0;      // 热重载替换成功的次数
+        uint64_t reloadFailed = 0;  // 热重载失败、保留旧程序的次数
+    };
+
+    // 在 gladLoadGLLoader 之后调用一次
+    static void loadExtensions(GLADloadproc load);
+    static bool hasParallelCompile();
+
+    ShaderManager() {}
+    ~ShaderManager();
+    ShaderManager(const ShaderManager &) = delete;
+    ShaderManager &operator=(const ShaderManager &) = delete;
+
+    // preferred 不可用时依次退回：Parallel -> Worker（需要 worker.bind）-> Synchronous
+    void create(WorkerContext worker = WorkerContext(), Mode preferred = Mode::Parallel);
+    // 等待后台编译结束并删除所有程序
+    void destroy();
+
+    // onReady 在主线程（poll 中）调用，用于绑定 uniform block 等一次性设置
+    Handle request(const std::string &vertexPath, const std::string &fragmentPath, const std::string &defines = "",
+                   std::function<void(GLuint)> onReady = nullptr);
+    void poll();
+
+    // 关联文件监视器（可以为空），已有程序的依赖文件也会加入监视
+    void setWatcher(FileWatcher *watcher);
+    // 重新编译依赖 changedFiles（规范化路径）中任一文件的程序，源码没有变化的跳过
+    void reload(const std::vector<std::string> &changedFiles);
+
+    bool isReady(Handle handle) const;
+    GLuint program(Handle handle, GLuint fallback) const;
+    size_t pending() const { return pendingCount; }
+    Mode mode() const { return activeMode; }
+    const Stats &stats() const { return counters; }
+
+private:
+    enum class State
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    struct Entry
+    {
+        std::string vertexPath, fragmentPath, defines;
+        std::string vertexSource, fragmentSource; // 已展开 #include 并插入定义
+        std::vector<std::string> dependencies;    // 两个阶段展开时读到的全部文件
+        State state = State::Pending;             // 当前可用程序的状态，重新编译期间不变
+        GLuint program = 0;                       // 当前可用的程序
+        bool building = false;                    // 是否有编译在进行
+        unsigned int generation = 0;              // 每次发起编译加一，后台线程的过期结果据此丢弃
+        GLuint linking = 0;                       // 并行模式下正在链接的程序
+        GLuint vertex = 0, fragment = 0;          // 并行模式下链接完成前保留
+        std::function<void(GLuint)> onReady;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    struct Job
+    {
+        Handle handle;
+        unsigned int generation;
+        std::string vertexSource, fragmentSource;
+    };
+
+    struct Result
+    {
+        Handle handle;
+        unsigned int generation;
+        GLuint program;
+        bool cached;
+        GLsync fence; // 后台线程插入的完成围栏
+    };
+
+    Mode activeMode = Mode::Synchronous;
+    std::vector<Entry> entries;
+    std::vector<Handle> waiting; // 并行模式下尚未完成的条目
+    std::vector<Result> arrived; // 后台线程模式下围栏尚未完成的结果
+    size_t pendingCount = 0;
+    Stats counters;
+    FileWatcher *watcher = nullptr;
+
+    WorkerContext worker;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    bool stopping = false;
+
+    bool loadSources(Entry &entry, std::string &vertexSource, std::string &fragmentSource);
+    void start(Handle handle);
+    void startParallel(Entry &entry);
+    void finish(Handle handle, GLuint program, bool cached);
+    void workerLoop();
+};
+
+#endif
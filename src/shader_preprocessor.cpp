@@ -0,0 +1,96 @@
+#include "shader_preprocessor.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+
+namespace
+{
+    struct Expansion
+    {
+        std::string source;
+        std::vector<std::string> files;     // 下标即 #line 的源串号
+        std::unordered_set<std::string> included;
+    };
+
+    // 行首（允许空白）的 #include "name"，成功时取出 name
+    bool parseInclude(const std::string &line, std::string &name)
+    {
+        size_t p = line.find_first_not_of(" \t");
+        if (p == std::string::npos || line[p] != '#')
+            return false;
+        p = line.find_first_not_of(" \t", p + 1);
+        if (p == std::string::npos || line.compare(p, 7, "include") != 0)
+            return false;
+        size_t open = line.find('"', p + 7);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            return false;
+        name = line.substr(open + 1, close - open - 1);
+        return true;
+    }
+
+    bool expand(const std::string &path, Expansion &expansion, const std::string &includedFrom)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path;
+            if (!includedFrom.empty())
+                std::cerr << " (included from " << includedFrom << ")";
+            std::cerr << std::endl;
+            return false;
+        }
+        int index = static_cast<int>(expansion.files.size());
+        expansion.files.push_back(path);
+        expansion.included.insert(path);
+        std::string directory = std::filesystem::path(path).parent_path().string();
+
+        std::string line;
+        int number = 0;
+        while (std::getline(file, line))
+        {
+            ++number;
+            std::string name;
+            if (!parseInclude(line, name))
+            {
+                expansion.source += line;
+                expansion.source += '\n';
+                continue;
+            }
+            std::string child = normalizeShaderPath((std::filesystem::path(directory) / name).string());
+            if (expansion.included.count(child))
+            {
+                // 已经展开过（或正在展开，即循环包含），保留空行使行号不变
+                expansion.source += '\n';
+                continue;
+            }
+            expansion.source += "#line 1 " + std::to_string(expansion.files.size()) + "\n";
+            if (!expand(child, expansion, path + ":" + std::to_string(number)))
+                return false;
+            expansion.source += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + "\n";
+        }
+        return true;
+    }
+}
+
+std::string normalizeShaderPath(const std::string &path)
+{
+    std::error_code error;
+    std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+    if (error)
+        normalized = std::filesystem::absolute(path, error).lexically_normal();
+    return normalized.string();
+}
+
+bool preprocessShader(const std::string &path, std::string &source, std::vector<std::string> *dependencies)
+{
+    Expansion expansion;
+    bool success = expand(normalizeShaderPath(path), expansion, "");
+    if (dependencies)
+        *dependencies = expansion.files;
+    source = success ? expansion.source : std::string();
+    return success;
+}
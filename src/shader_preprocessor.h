@@ -0,0 +1,20 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+
+// GLSL 的 #include 展开
+// 把 #include "file" 所在行替换成被包含文件的内容，路径相对于包含它的文件；
+// 每个文件只展开一次（相当于 #pragma once），循环包含直接展开为空。
+// 展开前后插入 #line，编译错误里的 "源串号:行号" 中源串号就是 dependencies 里的下标。
+// 只识别单独成行的指令，不处理注释或 #if 里的 #include。
+//
+// dependencies 返回参与展开的全部文件（规范化的绝对路径，第一个是 path 本身），
+// 热重载据此决定某个文件改动后需要重新编译哪些程序。
+bool preprocessShader(const std::string &path, std::string &source, std::vector<std::string> *dependencies = nullptr);
+
+// 规范化路径，文件监视器和依赖列表用同一种写法比较
+std::string normalizeShaderPath(const std::string &path);
+
+#endif
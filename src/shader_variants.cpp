@@ -0,0 +1,60 @@
+#include "shader_variants.h"
+
+namespace
+{
+    // 与 ShaderFeature 的位一一对应
+    const char *const FEATURE_DEFINES[ShaderFeature::Count] = {"HAS_TEXTURE", "HAS_NORMAL_MAP", "HAS_SKINNING",
+                                                               "HAS_INSTANCING", "HAS_SHADOWS", "HAS_CLUSTERED_LIGHTS",
+                                                               "HAS_SSAO"};
+    const char *const FEATURE_NAMES[ShaderFeature::Count] = {"texture", "normal map", "skinning", "instancing", "shadows", "lights", "ssao"};
+}
+
+std::string featureDefines(uint32_t features)
+{
+    std::string defines;
+    for (uint32_t i = 0; i < ShaderFeature::Count; i++)
+    {
+        if (features & (1u << i))
+            defines += std::string("#define ") + FEATURE_DEFINES[i] + "\n";
+    }
+    return defines;
+}
+
+std::string featureName(uint32_t features)
+{
+    std::string name;
+    for (uint32_t i = 0; i < ShaderFeature::Count; i++)
+    {
+        if (!(features & (1u << i)))
+            continue;
+        if (!name.empty())
+            name += "+";
+        name += FEATURE_NAMES[i];
+    }
+    return name.empty() ? "base" : name;
+}
+
+ShaderVariants::ShaderVariants(ShaderManager &manager, const std::string &vertexPath, const std::string &fragmentPath,
+                               std::function<void(GLuint)> setup, GLuint fallback)
+    : manager(manager), vertexPath(vertexPath), fragmentPath(fragmentPath), setup(setup), fallback(fallback)
+{
+}
+
+GLuint ShaderVariants::program(uint32_t features)
+{
+    auto it = handles.find(features);
+    if (it == handles.end())
+        it = handles.emplace(features, manager.request(vertexPath, fragmentPath, featureDefines(features), setup)).first;
+    return manager.program(it->second, fallback);
+}
+
+size_t ShaderVariants::readyCount() const
+{
+    size_t count = 0;
+    for (const auto &entry : handles)
+    {
+        if (manager.isReady(entry.second))
+            ++count;
+    }
+    return count;
+}
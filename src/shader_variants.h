@@ -0,0 +1,72 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include "shader_manager.h"
+
+// 着色器排列（permutation）
+// 材质与网格的特性用位掩码描述，每种组合编译成一个独立程序，特性以 #define 注入源码，
+// 着色器里用 #ifdef 裁掉不需要的路径，不再有每像素的 uniform 分支。
+// 变体在第一次用到时才通过 ShaderManager 异步编译，编译完成前返回备用程序。
+namespace ShaderFeature
+{
+    constexpr uint32_t Texture = 1u << 0;          // 漫反射贴图（0 号纹理单元）
+    constexpr uint32_t NormalMap = 1u << 1;        // 法线贴图（1 号纹理单元）
+    constexpr uint32_t Skinning = 1u << 2;         // GPU 蒙皮，读取 Bones block
+    constexpr uint32_t Instancing = 1u << 3;       // 模型矩阵来自实例属性（location 5-8）
+    constexpr uint32_t Shadows = 1u << 4;          // 阴影贴图采样
+    constexpr uint32_t Lights = 1u << 5;           // 分簇点光源（3-5 号纹理单元）
+    constexpr uint32_t AmbientOcclusion = 1u << 6; // 环境光乘以 SSAO 结果（10 号纹理单元）
+    constexpr uint32_t Count = 7;
+}
+
+// 特性组合对应的定义行，例如 "#define HAS_TEXTURE\n#define HAS_SKINNING\n"
+std::string featureDefines(uint32_t features);
+// 便于界面和日志显示，例如 "texture+skinning"，空掩码为 "base"
+std::string featureName(uint32_t features);
+
+// 纹理单元与着色器中的 sampler 一一对应，setup 回调里设置一次即可
+const int DIFFUSE_TEXTURE_UNIT = 0;
+const int NORMAL_TEXTURE_UNIT = 1;
+const int SHADOW_TEXTURE_UNIT = 2; // 级联阴影的深度纹理数组
+const int LIGHT_TEXTURE_UNIT = 3;       // 分簇光照的三个缓冲纹理，见 LightBuffers
+const int CLUSTER_TEXTURE_UNIT = 4;
+const int LIGHT_INDEX_TEXTURE_UNIT = 5;
+const int GBUFFER_TEXTURE_UNIT = 6;     // 延迟光照读取 G-buffer：6 反照率/粗糙度，7 法线，8 深度
+const int OVERDRAW_TEXTURE_UNIT = 9;    // 重叠绘制热图的计数纹理
+const int OCCLUSION_TEXTURE_UNIT = 10;  // SSAO：10 累积结果（着色时上采样），11 低分辨率深度，12 上一帧历史
+const int OCCLUSION_DEPTH_TEXTURE_UNIT = 11;
+const int OCCLUSION_HISTORY_TEXTURE_UNIT = 12;
+const int POST_SOURCE_TEXTURE_UNIT = 13;   // 后处理：13 本通道的输入，14 泛光结果，15 适应后的平均亮度
+const int POST_BLOOM_TEXTURE_UNIT = 14;
+const int POST_EXPOSURE_TEXTURE_UNIT = 15;
+
+class ShaderVariants
+{
+public:
+    // setup 在变体就绪时于主线程调用一次（绑定 uniform block、sampler 单元等）；
+    // fallback 在变体编译完成前或编译失败时使用
+    ShaderVariants(ShaderManager &manager, const std::string &vertexPath, const std::string &fragmentPath,
+                   std::function<void(GLuint)> setup, GLuint fallback);
+
+    // 返回 features 对应的程序，第一次调用时发起编译
+    GLuint program(uint32_t features);
+    // 预先请求一组变体，避免第一次绘制时才开始编译
+    void prepare(uint32_t features) { program(features); }
+
+    size_t size() const { return handles.size(); }
+    size_t readyCount() const;
+
+private:
+    ShaderManager &manager;
+    std::string vertexPath, fragmentPath;
+    std::function<void(GLuint)> setup;
+    GLuint fallback;
+    std::unordered_map<uint32_t, ShaderManager::Handle> handles;
+};
+
+#endif
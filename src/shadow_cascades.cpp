@@ -0,0 +1,82 @@
+#include "shadow_cascades.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+ShadowCascades ShadowCascades::compute(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &direction, int count,
+                                       float shadowDistance, int resolution, float lambda)
+{
+    ShadowCascades result;
+    result.count = std::max(1, std::min(count, MAX_CASCADES));
+    result.direction = glm::normalize(direction);
+
+    // glm::perspective 的矩阵：[2][2] = -(f+n)/(f-n)，[3][2] = -2fn/(f-n)
+    float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    float farPlane = std::min(projection[3][2] / (projection[2][2] + 1.0f), shadowDistance);
+    float tanX = 1.0f / projection[0][0];
+    float tanY = 1.0f / projection[1][1];
+    glm::mat4 inverseView = glm::inverse(view);
+    glm::vec3 up = std::fabs(result.direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    float sliceNear = nearPlane;
+    for (int i = 0; i < result.count; i++)
+    {
+        float t = float(i + 1) / result.count;
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+        float linearSplit = nearPlane + (farPlane - nearPlane) * t;
+        float sliceFar = lambda * logSplit + (1.0f - lambda) * linearSplit;
+        result.splits[i] = sliceFar;
+
+        // 包围球在视空间里计算，只取决于切片形状，相机旋转时半径不变
+        glm::vec3 corners[8];
+        glm::vec3 centerView(0.0f);
+        for (int k = 0; k < 8; k++)
+        {
+            float depth = (k & 4) ? sliceFar : sliceNear;
+            corners[k] = glm::vec3((k & 1 ? 1.0f : -1.0f) * depth * tanX, (k & 2 ? 1.0f : -1.0f) * depth * tanY, -depth);
+            centerView += corners[k] / 8.0f;
+        }
+        float radius = 0.0f;
+        for (const glm::vec3 &corner : corners)
+            radius = std::max(radius, glm::length(corner - centerView));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        glm::vec3 center = glm::vec3(inverseView * glm::vec4(centerView, 1.0f));
+
+        glm::mat4 lightView = glm::lookAt(center - result.direction * radius, center, up);
+        glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+        // 世界原点投影后对齐到纹素，平移相机时采样网格不动
+        glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        float texelX = origin.x * resolution * 0.5f;
+        float texelY = origin.y * resolution * 0.5f;
+        lightProjection[3][0] += (std::round(texelX) - texelX) * 2.0f / resolution;
+        lightProjection[3][1] += (std::round(texelY) - texelY) * 2.0f / resolution;
+
+        result.view[i] = lightView;
+        result.projection[i] = lightProjection;
+        result.extent[i] = radius;
+        sliceNear = sliceFar;
+    }
+    return result;
+}
+
+bool ShadowCascades::intersects(int cascade, const glm::vec3 &center, float radius) const
+{
+    glm::vec3 p = glm::vec3(view[cascade] * glm::vec4(center, 1.0f));
+    float r = extent[cascade];
+    if (std::fabs(p.x) > r + radius || std::fabs(p.y) > r + radius)
+        return false;
+    // 观察方向为 -z，远平面在 z = -2r
+    return p.z + radius >= -2.0f * r;
+}
+
+uint32_t ShadowCascades::casterMask(const glm::vec3 &center, float radius) const
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (intersects(i, center, radius))
+            mask |= 1u << i;
+    }
+    return mask;
+}
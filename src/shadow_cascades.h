@@ -0,0 +1,34 @@
+#ifndef SHADOW_CASCADES_H
+#define SHADOW_CASCADES_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// 级联阴影的 CPU 部分（不涉及 GL），在模拟线程里随快照一起计算
+// 相机视锥在 shadowDistance 以内按对数/线性混合切成若干段，每段用包围球决定正交投影的范围：
+// 范围不随相机旋转变化，再把投影原点对齐到纹素，相机移动时阴影边缘不闪烁。
+// 光源按方向光处理；渲染阴影时开启深度钳制，光源与近平面之间的投射体也会写入（深度为 0）。
+struct ShadowCascades
+{
+    static constexpr int MAX_CASCADES = 4;
+
+    int count = 0;
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f); // 光线传播方向
+    glm::mat4 view[MAX_CASCADES];
+    glm::mat4 projection[MAX_CASCADES];
+    float splits[MAX_CASCADES] = {}; // 每段远端到相机的视空间距离
+    float extent[MAX_CASCADES] = {}; // 正交投影的半宽（世界单位）
+
+    // projection 为透视投影，近远平面和视场角从矩阵中取出；lambda 为 0 时均匀切分，1 时按对数切分
+    static ShadowCascades compute(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &direction, int count,
+                                  float shadowDistance, int resolution, float lambda = 0.75f);
+
+    glm::mat4 viewProjection(int cascade) const { return projection[cascade] * view[cascade]; }
+    // 世界空间包围球是否可能向第 cascade 段投射阴影：xy 与投影范围相交，且不完全在远平面之后
+    // 近平面一侧不剔除，比它更靠近光源的物体仍可能挡住这一段
+    bool intersects(int cascade, const glm::vec3 &center, float radius) const;
+    // 所有段的掩码，第 i 位表示与第 i 段相交
+    uint32_t casterMask(const glm::vec3 &center, float radius) const;
+};
+
+#endif
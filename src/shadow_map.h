@@ -0,0 +1,43 @@
+#ifndef SHADOW_MAP_H
+#define SHADOW_MAP_H
+
+#include <glad/glad.h>
+
+// 级联阴影贴图：一张深度纹理数组，每层一个级联，共用一个帧缓冲
+// 纹理开启深度比较，着色器里用 sampler2DArrayShadow 采样，线性过滤时硬件对 2x2 比较结果做双线性混合；
+// 超出纹理范围按受光处理（边界深度为 1）。
+class ShadowMap
+{
+public:
+    ShadowMap() {}
+    ~ShadowMap();
+    ShadowMap(const ShadowMap &) = delete;
+    ShadowMap &operator=(const ShadowMap &) = delete;
+
+    bool create(int resolution, int cascades);
+    void destroy();
+
+    // 阴影通道的状态：深度钳制（光源近平面之前的投射体压到 0）、剔除正面、斜率偏移，
+    // 只写深度；调用前的帧缓冲、视口和这些开关在 endPass 时恢复
+    void beginPass(float slopeBias = 1.5f, float constantBias = 2.0f);
+    // 把第 cascade 层绑为深度附件并清空
+    void bindCascade(int cascade);
+    void endPass();
+
+    GLuint texture() const { return depth; }
+    int resolution() const { return size; }
+    int cascades() const { return layers; }
+
+private:
+    GLuint fbo = 0, depth = 0;
+    int size = 0, layers = 0;
+
+    // beginPass 时保存
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4] = {};
+    GLint previousCullFace = GL_BACK;
+    GLboolean previousCulling = GL_FALSE;
+    GLboolean previousColorMask[4] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "skinning.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SKINNING_AVX2 1
+#endif
+
+void VertexWeights::add(int id, float weight)
+{
+    int slot = 0;
+    for (int i = 1; i < 4; i++)
+        if (weights[i] < weights[slot])
+            slot = i;
+    if (weight > weights[slot])
+    {
+        ids[slot] = id;
+        weights[slot] = weight;
+    }
+}
+
+void VertexWeights::normalize()
+{
+    float sum = weights.x + weights.y + weights.z + weights.w;
+    if (sum > 0.0f)
+        weights /= sum;
+}
+
+PaletteMatrix toPaletteMatrix(const glm::mat4 &matrix)
+{
+    // glm 按列存放，这里转成行
+    PaletteMatrix palette;
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 4; column++)
+            palette.rows[row][column] = matrix[column][row];
+    return palette;
+}
+
+const char *skinningPathName(SkinningPath path)
+{
+    switch (path)
+    {
+    case SkinningPath::Gpu:
+        return "GPU";
+    case SkinningPath::CpuScalar:
+        return "CPU scalar";
+    case SkinningPath::CpuAvx2:
+        return "CPU AVX2";
+    }
+    return "";
+}
+
+bool cpuSupportsAvx2()
+{
+#ifdef SKINNING_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+namespace
+{
+    void skinScalar(const Vertex *vertices, const VertexWeights *weights, size_t count, const PaletteMatrix *palette, SkinnedVertex *out)
+    {
+        for (size_t v = 0; v < count; v++)
+        {
+            // 先按权重混合矩阵，再变换一次
+            float m[3][4] = {};
+            for (int k = 0; k < 4; k++)
+            {
+                float weight = weights[v].weights[k];
+                if (weight == 0.0f)
+                    continue;
+                const PaletteMatrix &bone = palette[weights[v].ids[k]];
+                for (int row = 0; row < 3; row++)
+                    for (int column = 0; column < 4; column++)
+                        m[row][column] += weight * bone.rows[row][column];
+            }
+            const glm::vec3 &p = vertices[v].Position;
+            const glm::vec3 &n = vertices[v].Normal;
+            for (int row = 0; row < 3; row++)
+            {
+                out[v].Position[row] = m[row][0] * p.x + m[row][1] * p.y + m[row][2] * p.z + m[row][3];
+                out[v].Normal[row] = m[row][0] * n.x + m[row][1] * n.y + m[row][2] * n.z;
+            }
+        }
+    }
+
+#ifdef SKINNING_AVX2
+    // 3x4 矩阵正好是 8 + 4 个浮点：前两行用一个 256 位寄存器，第三行用 128 位寄存器
+    __attribute__((target("avx2,fma"))) void skinAvx2(const Vertex *vertices, const VertexWeights *weights, size_t count,
+                                                      const PaletteMatrix *palette, SkinnedVertex *out)
+    {
+        for (size_t v = 0; v < count; v++)
+        {
+            __m256 rows01 = _mm256_setzero_ps();
+            __m128 row2 = _mm_setzero_ps();
+            for (int k = 0; k < 4; k++)
+            {
+                float weight = weights[v].weights[k];
+                if (weight == 0.0f)
+                    continue;
+                const float *bone = &palette[weights[v].ids[k]].rows[0][0];
+                __m256 w = _mm256_set1_ps(weight);
+                rows01 = _mm256_fmadd_ps(w, _mm256_loadu_ps(bone), rows01);
+                row2 = _mm_fmadd_ps(_mm256_castps256_ps128(w), _mm_loadu_ps(bone + 8), row2);
+            }
+            __m128 row0 = _mm256_castps256_ps128(rows01);
+            __m128 row1 = _mm256_extractf128_ps(rows01, 1);
+
+            const glm::vec3 &p = vertices[v].Position;
+            const glm::vec3 &n = vertices[v].Normal;
+            __m128 position = _mm_set_ps(1.0f, p.z, p.y, p.x);
+            __m128 normal = _mm_set_ps(0.0f, n.z, n.y, n.x);
+
+            // 三行分别点乘，水平相加得到 (x, y, z, z)
+            __m128 p01 = _mm_hadd_ps(_mm_mul_ps(row0, position), _mm_mul_ps(row1, position));
+            __m128 p2 = _mm_mul_ps(row2, position);
+            __m128 resultP = _mm_hadd_ps(p01, _mm_hadd_ps(p2, p2));
+            __m128 n01 = _mm_hadd_ps(_mm_mul_ps(row0, normal), _mm_mul_ps(row1, normal));
+            __m128 n2 = _mm_mul_ps(row2, normal);
+            __m128 resultN = _mm_hadd_ps(n01, _mm_hadd_ps(n2, n2));
+
+            // 位置和法线各是 3 个浮点，前两个用 64 位写、第三个单独写；4 宽写会越过最后一个顶点的末尾
+            _mm_storel_pi(reinterpret_cast<__m64 *>(&out[v].Position.x), resultP);
+            out[v].Position.z = _mm_cvtss_f32(_mm_movehl_ps(resultP, resultP));
+            _mm_storel_pi(reinterpret_cast<__m64 *>(&out[v].Normal.x), resultN);
+            out[v].Normal.z = _mm_cvtss_f32(_mm_movehl_ps(resultN, resultN));
+        }
+    }
+#endif
+}
+
+void skinVertices(SkinningPath path, const Vertex *vertices, const VertexWeights *weights, size_t count,
+                  const PaletteMatrix *palette, SkinnedVertex *out)
+{
+#ifdef SKINNING_AVX2
+    if (path == SkinningPath::CpuAvx2 && cpuSupportsAvx2())
+    {
+        skinAvx2(vertices, weights, count, palette, out);
+        return;
+    }
+#endif
+    skinScalar(vertices, weights, count, palette, out);
+}
@@ -0,0 +1,52 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "vertex.h"
+
+// 骨骼蒙皮
+// 每个顶点最多受 4 根骨骼影响，骨骼下标与权重作为第二个顶点流；
+// GPU 路径在顶点着色器中混合 Bones uniform block 里的矩阵，
+// CPU 路径（llvmpipe/无窗口时）把蒙皮后的位置和法线写入流式顶点缓冲
+
+struct VertexWeights
+{
+    glm::ivec4 ids = glm::ivec4(0);
+    glm::vec4 weights = glm::vec4(0.0f);
+
+    // 槽位已满时替换权重最小的一个
+    void add(int id, float weight);
+    // 权重和归一化为 1
+    void normalize();
+};
+
+// 仿射骨骼矩阵的前三行，按行存放
+struct PaletteMatrix
+{
+    float rows[3][4];
+};
+PaletteMatrix toPaletteMatrix(const glm::mat4 &matrix);
+
+// CPU 蒙皮的输出，纹理坐标仍从静态顶点缓冲读取
+struct SkinnedVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+};
+
+enum class SkinningPath
+{
+    Gpu,
+    CpuScalar,
+    CpuAvx2,
+};
+const char *skinningPathName(SkinningPath path);
+// 运行时检测 AVX2 + FMA
+bool cpuSupportsAvx2();
+
+// path 为 CpuAvx2 但 CPU 不支持时退回标量实现
+void skinVertices(SkinningPath path, const Vertex *vertices, const VertexWeights *weights, size_t count,
+                  const PaletteMatrix *palette, SkinnedVertex *out);
+
+#endif
@@ -0,0 +1,121 @@
+#include "ssao.h"
+#include "shader_variants.h"
+
+#include <iostream>
+
+SSAO::~SSAO()
+{
+    destroy();
+}
+
+bool SSAO::create(int width, int height, int divisor)
+{
+    destroy();
+    fullW = width;
+    fullH = height;
+    scale = divisor;
+    w = (width + divisor - 1) / divisor;
+    h = (height + divisor - 1) / divisor;
+
+    // 可能在帧中间（视口或分辨率设置变化时）重建，完成后恢复原来的绘制目标
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    auto texture = [this](GLuint &id, GLenum internalFormat, GLenum format, GLenum type)
+    {
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    };
+    bool complete = true;
+    texture(depth, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT);
+    glGenFramebuffers(1, &depthFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    for (int i = 0; i < 2; i++)
+    {
+        texture(targets[i], GL_RG16F, GL_RG, GL_FLOAT);
+        glGenFramebuffers(1, &fbos[i]);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targets[i], 0);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    if (!complete)
+    {
+        std::cerr << "ERROR::SSAO::INCOMPLETE " << w << "x" << h << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void SSAO::destroy()
+{
+    if (depthFbo)
+        glDeleteFramebuffers(1, &depthFbo);
+    if (depth)
+        glDeleteTextures(1, &depth);
+    if (fbos[0])
+        glDeleteFramebuffers(2, fbos);
+    if (targets[0])
+        glDeleteTextures(2, targets);
+    depthFbo = depth = 0;
+    fbos[0] = fbos[1] = targets[0] = targets[1] = 0;
+    w = h = fullW = fullH = 0;
+    historyValid = false;
+}
+
+void SSAO::saveTarget()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+}
+
+void SSAO::restoreTarget()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void SSAO::beginDepth()
+{
+    saveTarget();
+    glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+    glViewport(0, 0, w, h);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void SSAO::endDepth()
+{
+    restoreTarget();
+}
+
+void SSAO::beginOcclusion()
+{
+    saveTarget();
+    glBindFramebuffer(GL_FRAMEBUFFER, fbos[current]);
+    glViewport(0, 0, w, h);
+    glActiveTexture(GL_TEXTURE0 + OCCLUSION_DEPTH_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depth);
+    glActiveTexture(GL_TEXTURE0 + OCCLUSION_HISTORY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, targets[1 - current]);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void SSAO::endOcclusion()
+{
+    restoreTarget();
+    glActiveTexture(GL_TEXTURE0 + OCCLUSION_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, targets[current]);
+    glActiveTexture(GL_TEXTURE0);
+    current = 1 - current;
+    historyValid = true;
+}
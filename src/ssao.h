@@ -0,0 +1,58 @@
+#ifndef SSAO_H
+#define SSAO_H
+
+#include <glad/glad.h>
+
+// 屏幕空间环境光遮蔽，在 1/divisor 分辨率下计算（divisor 为 2 或 4）
+//   深度通道：场景用只有位置的顶点流再画一遍，写入低分辨率深度纹理（前向和延迟路径共用，不依赖主深度缓冲）
+//   遮蔽通道：全屏三角形，由深度重建视空间位置和法线，法线半球内少量采样（shaders/ssao_fragment.glsl）；
+//            每帧旋转采样方向，结果按上一帧的相机矩阵重投影到历史上做指数累积，少量采样也能收敛，
+//            历史深度与当前相差过大（去遮挡）时丢弃历史
+//   着色时按像素在低分辨率结果上做 2x2 双边上采样，权重考虑深度差，物体边缘不会渗色（shaders/ssao.glsl）
+// 结果和历史是两张 RG16F 纹理（x 遮蔽，y 线性深度）轮流读写
+class SSAO
+{
+public:
+    static const int MAX_SAMPLES = 32;
+
+    SSAO() {}
+    ~SSAO();
+    SSAO(const SSAO &) = delete;
+    SSAO &operator=(const SSAO &) = delete;
+
+    // width/height 为全分辨率视口尺寸
+    bool create(int width, int height, int divisor);
+    void destroy();
+
+    // 深度通道：保存当前帧缓冲和视口，绑定低分辨率深度目标并清空
+    void beginDepth();
+    void endDepth();
+    // 遮蔽通道：绑定本帧的结果目标和输入纹理（深度、上一帧历史），由调用者画全屏三角形
+    void beginOcclusion();
+    // 恢复帧缓冲和视口，交换结果与历史，并把结果绑定到 OCCLUSION_TEXTURE_UNIT 供着色使用
+    void endOcclusion();
+
+    // 尺寸变化或相机跳变后调用，下一帧不使用历史
+    void resetHistory() { historyValid = false; }
+    bool hasHistory() const { return historyValid; }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int fullWidth() const { return fullW; }
+    int fullHeight() const { return fullH; }
+    int divisor() const { return scale; }
+
+private:
+    GLuint depthFbo = 0, depth = 0;
+    GLuint fbos[2] = {0, 0}, targets[2] = {0, 0};
+    int current = 0;
+    bool historyValid = false;
+    int w = 0, h = 0, fullW = 0, fullH = 0, scale = 1;
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4] = {};
+
+    void saveTarget();
+    void restoreTarget();
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "stream_buffer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// glad 只生成了 3.3 核心函数，ARB_buffer_storage 手动加载
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void(APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+static PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+
+void StreamBuffer::loadExtensions(GLADloadproc load)
+{
+    bufferStorage = nullptr;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+        {
+            bufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(load("glBufferStorage"));
+            break;
+        }
+    }
+}
+
+bool StreamBuffer::hasBufferStorage()
+{
+    return bufferStorage != nullptr;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    destroy();
+}
+
+bool StreamBuffer::create(GLenum target, size_t regionSize)
+{
+    destroy();
+    this->target = target;
+    defaultAlignment = 1;
+    if (target == GL_UNIFORM_BUFFER)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        defaultAlignment = static_cast<size_t>(alignment);
+    }
+    // 每段长度对齐，保证各段起点同样满足对齐
+    size = (regionSize + defaultAlignment - 1) / defaultAlignment * defaultAlignment;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    GLsizeiptr total = static_cast<GLsizeiptr>(size * REGIONS);
+    if (bufferStorage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(target, total, nullptr, flags);
+        persistent = static_cast<unsigned char *>(glMapBufferRange(target, 0, total, flags));
+        if (!persistent)
+            std::cerr << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+    }
+    if (!persistent)
+    {
+        // 持久映射不可用或失败时退回普通缓冲（glBufferStorage 创建的缓冲不可变，需要重建）
+        if (bufferStorage)
+        {
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+        }
+        glBufferData(target, total, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(target, 0);
+
+    region = REGIONS - 1; // 第一次 beginFrame 切到 0 号段
+    head = 0;
+    counters = Stats();
+    return buffer != 0;
+}
+
+void StreamBuffer::destroy()
+{
+    if (!buffer)
+        return;
+    for (GLsync &fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (persistent || mapped)
+    {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    persistent = nullptr;
+    mapped = false;
+}
+
+void StreamBuffer::beginFrame()
+{
+    region = (region + 1) % REGIONS;
+    head = 0;
+    GLsync &fence = fences[region];
+    if (!fence)
+        return;
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        // GPU 还在读这一段，CPU 只能等待
+        ++counters.stalls;
+        auto start = std::chrono::steady_clock::now();
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while ((status = glClientWaitSync(fence, flags, 1000000)) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        counters.stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (status == GL_WAIT_FAILED)
+        std::cerr << "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::endFrame()
+{
+    commit();
+    if (fences[region])
+        glDeleteSync(fences[region]);
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (head > counters.peakBytes)
+        counters.peakBytes = head;
+    ++counters.frames;
+}
+
+void *StreamBuffer::allocate(size_t bytes, GLintptr &offset, size_t alignment)
+{
+    if (!buffer)
+        return nullptr;
+    commit();
+    if (alignment == 0)
+        alignment = defaultAlignment;
+    size_t base = region * size;
+    size_t start = (base + head + alignment - 1) / alignment * alignment;
+    if (start + bytes > base + size)
+    {
+        if (counters.overflows++ == 0)
+            std::cerr << "ERROR::STREAM_BUFFER::REGION_FULL " << size << " bytes" << std::endl;
+        return nullptr;
+    }
+    head = start + bytes - base;
+    offset = static_cast<GLintptr>(start);
+
+    if (persistent)
+        return persistent + start;
+
+    // 围栏已经保证这段不在使用中，不需要驱动再做同步
+    glBindBuffer(target, buffer);
+    void *pointer = glMapBufferRange(target, offset, static_cast<GLsizeiptr>(bytes),
+                                     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    mapped = pointer != nullptr;
+    if (!mapped)
+        std::cerr << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+    return pointer;
+}
+
+void StreamBuffer::commit()
+{
+    if (!mapped)
+        return;
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+    mapped = false;
+}
+
+bool StreamBuffer::write(const void *data, size_t bytes, GLintptr &offset, size_t alignment)
+{
+    void *pointer = allocate(bytes, offset, alignment);
+    if (!pointer)
+        return false;
+    std::memcpy(pointer, data, bytes);
+    commit();
+    return true;
+}
+
+bool StreamBuffer::writeUniform(GLuint binding, const void *data, size_t bytes)
+{
+    GLintptr offset;
+    if (!write(data, bytes, offset))
+        return false;
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, static_cast<GLsizeiptr>(bytes));
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+// 每帧流式数据（UBO 内容、变换、动态几何）的环形缓冲
+// 缓冲分成 REGIONS 段，每帧写一段，帧末插入围栏；轮回到某段时先等它的围栏，
+// 保证 GPU 读完之前 CPU 不会覆盖。
+// 有 ARB_buffer_storage 时用 glBufferStorage 持久/一致映射，只映射一次；
+// 否则（例如 macOS 的 4.1 核心模式）每次分配用 UNSYNCHRONIZED 映射对应区间，同步仍由围栏保证。
+class StreamBuffer
+{
+public:
+    static const unsigned int REGIONS = 3;
+
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t stalls = 0;    // 轮回时围栏未完成、CPU 需要等待 GPU 的次数
+        double stallMs = 0.0;   // 累计等待时间
+        uint64_t overflows = 0; // 一帧写满一段后被拒绝的分配
+        size_t peakBytes = 0;   // 单帧最大用量
+    };
+
+    // 在 gladLoadGLLoader 之后调用一次，检测并加载 glBufferStorage
+    static void loadExtensions(GLADloadproc load);
+    static bool hasBufferStorage();
+
+    StreamBuffer() {}
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    // target 只用于映射时绑定，不要用 GL_ELEMENT_ARRAY_BUFFER（会改动当前 VAO）
+    bool create(GLenum target, size_t regionSize);
+    void destroy();
+
+    // 切换到下一段，必要时等待它的围栏
+    void beginFrame();
+    // 本帧所有使用该缓冲的绘制提交之后调用
+    void endFrame();
+
+    // 在当前段分配 size 字节，返回写指针和缓冲内偏移；写完并在绘制之前调用 commit()
+    // alignment 为 0 时使用缓冲默认对齐（UBO 为 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT），可以不是 2 的幂
+    void *allocate(size_t size, GLintptr &offset, size_t alignment = 0);
+    void commit();
+    bool write(const void *data, size_t size, GLintptr &offset, size_t alignment = 0);
+    // 写入一个 uniform block 并绑定到 binding
+    bool writeUniform(GLuint binding, const void *data, size_t size);
+
+    GLuint id() const { return buffer; }
+    size_t regionSize() const { return size; }
+    bool isPersistent() const { return persistent != nullptr; }
+    const Stats &stats() const { return counters; }
+
+private:
+    GLenum target = GL_ARRAY_BUFFER;
+    GLuint buffer = 0;
+    size_t size = 0;
+    size_t defaultAlignment = 1;
+    unsigned char *persistent = nullptr; // 持久映射的整个缓冲
+    bool mapped = false;                 // 非持久模式下是否有未提交的映射
+    GLsync fences[REGIONS] = {};
+    unsigned int region = 0;
+    size_t head = 0; // 当前段内已用字节
+    Stats counters;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::enabledFlag{false};
+
+namespace
+{
+    struct Event
+    {
+        const char *name;
+        uint64_t begin;
+        uint64_t duration;
+        Trace::Track track;
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events{new Event[Trace::CAPACITY]};
+        std::atomic<uint64_t> head{0};        // 只由所属线程写
+        std::atomic<uint64_t> tail{0};        // 只由导出线程写
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<bool> retired{false};     // 所属线程已退出，取空后可以释放
+        uint32_t tid = 0;
+    };
+
+    // 注册表只在线程第一次记录和导出时加锁
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    uint32_t nextTid = 2; // 0 留给 GPU 时间线
+    uint64_t retiredDropped = 0;
+    std::atomic<uint64_t> epoch{0};
+
+    // 线程退出时标记缓冲，由导出线程在取空后释放
+    // 带析构的 thread_local 每次访问都要检查初始化，热路径只用下面的裸指针
+    struct BufferRetirer
+    {
+        ThreadBuffer *buffer = nullptr;
+        ~BufferRetirer()
+        {
+            if (buffer)
+                buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local BufferRetirer retirer;
+    thread_local ThreadBuffer *localBuffer = nullptr;
+    thread_local const char *pendingName = nullptr;
+
+    ThreadBuffer *registerThread()
+    {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->name.store(pendingName, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = nextTid++;
+        localBuffer = buffer.get();
+        retirer.buffer = localBuffer;
+        registry.push_back(std::move(buffer));
+        return localBuffer;
+    }
+
+    void writeEscaped(FILE *file, const char *text)
+    {
+        for (const char *c = text; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                std::fputc('\\', file);
+            if (static_cast<unsigned char>(*c) >= 0x20)
+                std::fputc(*c, file);
+        }
+    }
+}
+
+void Trace::setEnabled(bool enabled)
+{
+    uint64_t expected = 0;
+    if (enabled)
+        epoch.compare_exchange_strong(expected, now());
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Trace::now()
+{
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::setThreadName(const char *name)
+{
+    // 还没有缓冲时先记下，第一次记录时再用
+    pendingName = name;
+    if (localBuffer)
+        localBuffer->name.store(name, std::memory_order_relaxed);
+}
+
+void Trace::record(const char *name, uint64_t begin, uint64_t end, Track track)
+{
+    ThreadBuffer *buffer = localBuffer ? localBuffer : registerThread();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= CAPACITY)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event &event = buffer->events[head & (CAPACITY - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.duration = end > begin ? end - begin : 0;
+    event.track = track;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t Trace::dropped()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t total = retiredDropped;
+    for (const std::unique_ptr<ThreadBuffer> &buffer : registry)
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool Trace::write(const std::string &path)
+{
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cerr << "ERROR::TRACE::FILE_NOT_WRITABLE " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t origin = epoch.load();
+    size_t written = 0;
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"HelloGL\"}},\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+    for (const std::unique_ptr<ThreadBuffer> &buffer : registry)
+    {
+        const char *name = buffer->name.load(std::memory_order_relaxed);
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", buffer->tid);
+        if (name)
+            writeEscaped(file, name);
+        else
+            std::fprintf(file, "thread %u", buffer->tid);
+        std::fprintf(file, "\"}}");
+
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        for (uint64_t i = tail; i < head; i++)
+        {
+            const Event &event = buffer->events[i & (CAPACITY - 1)];
+            // 时间单位为微秒，保留到纳秒
+            double ts = event.begin >= origin ? (event.begin - origin) / 1000.0 : -((origin - event.begin) / 1000.0);
+            std::fprintf(file, ",\n{\"name\":\"");
+            writeEscaped(file, event.name);
+            std::fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         event.track == GPU ? 0u : buffer->tid, ts, event.duration / 1000.0);
+            ++written;
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+    std::fprintf(file, "\n]}\n");
+    bool ok = std::fclose(file) == 0;
+
+    // 已退出且取空的线程缓冲可以释放
+    for (auto it = registry.begin(); it != registry.end();)
+    {
+        ThreadBuffer &buffer = **it;
+        if (buffer.retired.load(std::memory_order_acquire) &&
+            buffer.head.load(std::memory_order_acquire) == buffer.tail.load(std::memory_order_relaxed))
+        {
+            retiredDropped += buffer.dropped.load(std::memory_order_relaxed);
+            it = registry.erase(it);
+        }
+        else
+            ++it;
+    }
+    if (!ok)
+        std::cerr << "ERROR::TRACE::WRITE_FAILED " << path << std::endl;
+    else
+        std::cout << "Trace: " << written << " events written to " << path << std::endl;
+    return ok;
+}
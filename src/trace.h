@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 事件跟踪，导出为 Chrome Trace Event JSON（chrome://tracing、Perfetto UI 都能打开）
+// 每个线程第一次记录时分配自己的环形缓冲，记录只写本线程缓冲并发布 head（单生产者/单消费者，无锁）；
+// write() 在调用线程取走所有缓冲中的事件。缓冲写满时丢弃新事件并计数，不会阻塞被测线程。
+// 关闭时一次作用域只有一次原子读；开启时两次 steady_clock 读取加一次写入。
+// 事件名必须是静态存储期的字符串（通常是字面量），记录时只保存指针。
+class Trace
+{
+public:
+    static const size_t CAPACITY = 1 << 14; // 每个线程缓冲的事件数，2 的幂
+
+    enum Track
+    {
+        THREAD = 0, // 记录事件的线程
+        GPU = 1,    // GPU 时间线（时间戳已换算到 CPU 时钟）
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    // steady_clock 纳秒，与 Profiler 的 CPU 时间同源
+    static uint64_t now();
+    // 导出时显示的线程名
+    static void setThreadName(const char *name);
+    static void record(const char *name, uint64_t begin, uint64_t end, Track track = THREAD);
+
+    // 取走已记录的事件写入文件，成功返回 true
+    static bool write(const std::string &path);
+    // 因缓冲写满而丢弃的事件数
+    static uint64_t dropped();
+
+private:
+    static std::atomic<bool> enabledFlag;
+};
+
+// RAII 作用域；构造时未开启跟踪则析构时也不记录
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : name(name), begin(Trace::isEnabled() ? Trace::now() : 0) {}
+    ~TraceScope()
+    {
+        if (begin)
+            Trace::record(name, begin, Trace::now());
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    uint64_t begin;
+};
+
+#endif
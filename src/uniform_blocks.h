@@ -0,0 +1,78 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <glm/glm.hpp>
+
+// 与着色器中 std140 uniform block 对应的结构，vec3 一律用 vec4 存放以满足对齐
+// 绑定点在 C++ 与 Shader::bindUniformBlock 之间共用
+
+const unsigned int FRAME_BLOCK_BINDING = 0;
+const unsigned int OBJECT_BLOCK_BINDING = 1;
+const unsigned int BONE_BLOCK_BINDING = 2;
+const unsigned int SHADOW_BLOCK_BINDING = 3;
+const unsigned int CLUSTER_BLOCK_BINDING = 4;
+const unsigned int OCCLUSION_BLOCK_BINDING = 5;
+const unsigned int POST_PROCESS_BLOCK_BINDING = 6;
+
+// 与 vertex.glsl 中 Bones block 的数组长度一致，8 KB 在 GL_MAX_UNIFORM_BLOCK_SIZE 的最低保证（16 KB）之内
+const unsigned int MAX_BONES = 128;
+
+// 每帧一次
+struct FrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 viewPos;
+    glm::vec4 lightColor;
+    glm::mat4 inverseViewProjection; // 延迟光照由深度重建世界坐标
+};
+
+// 每次绘制一次
+struct ObjectUniforms
+{
+    glm::mat4 model;
+    glm::vec4 color; // 没有漫反射贴图时的表面颜色
+    glm::vec4 material = glm::vec4(0.5f, 0.0f, 0.0f, 0.0f); // x 粗糙度（0.5 对应高光指数 32）
+};
+
+// 开启阴影的变体使用，每帧一次；级联数与 ShadowCascades::MAX_CASCADES 一致
+struct ShadowUniforms
+{
+    glm::mat4 lightViewProjection[4];
+    glm::vec4 splits;    // 各级联远端的视空间距离，超出最后一段不投影
+    glm::vec4 texelSize; // 各级联一个阴影纹素对应的世界尺寸，用于法线偏移
+    glm::vec4 params;    // x 级联数，y 法线偏移（纹素倍数），z 1/分辨率，w PCF 半径（纹素）
+};
+
+// 开启分簇光照的变体使用，每帧一次；簇的划分见 LightClusters
+struct ClusterUniforms
+{
+    glm::vec4 grid;   // x 横向块数，y 纵向块数，z 深度层数，w 光源数
+    glm::vec4 slices; // x/y：层号 = log(视空间深度) * x + y
+    glm::vec4 screen; // x/y：像素坐标乘以它得到块坐标（块数 / 视口尺寸）
+};
+
+// 屏幕空间环境光遮蔽的变体和 SSAO 通道使用，每帧一次；见 SSAO
+struct OcclusionUniforms
+{
+    glm::mat4 previousViewProjection; // 上一帧的相机矩阵，时间累积时重投影历史
+    glm::vec4 params;                 // x 半径（世界单位），y 采样数，z 帧序号（旋转采样方向），w 新结果的权重（1 表示没有历史）
+    glm::vec4 target;                 // xy 低分辨率尺寸，zw 全分辨率像素坐标到低分辨率的缩放
+};
+
+// HDR 后处理（泛光、曝光、色调映射）的各个通道共用，每帧一次；见 PostProcess
+struct PostProcessUniforms
+{
+    glm::vec4 bloom;     // x 亮度阈值，y 阈值软过渡宽度，z 泛光强度，w 上采样滤波半径（源纹素）
+    glm::vec4 exposure;  // x 曝光补偿（EV），y 本帧向目标曝光靠拢的比例（1 为立即），z 手动曝光（0 为自动），w 泛光层数
+    glm::vec4 histogram; // x 直方图最小 log2 亮度，y log2 亮度范围，z/w 参与平均的低/高百分位
+};
+
+// 蒙皮模型每次绘制一次，骨骼矩阵在模型根空间
+struct BoneUniforms
+{
+    glm::mat4 bones[MAX_BONES];
+};
+
+#endif